@@ -16,4 +16,8 @@ if (NOT TARGET Vulkan::Vulkan)
 	find_package(Vulkan REQUIRED)
 else()
 	message(STATUS "[LogiSceneGraph] Target Vulkan::Vulkan is already defined. Using existing target.")
-endif()
\ No newline at end of file
+endif()
+# Threads
+if (NOT TARGET Threads::Threads)
+	find_package(Threads REQUIRED)
+endif()
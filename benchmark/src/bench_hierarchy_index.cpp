@@ -0,0 +1,105 @@
+/**
+ * Resolves hierarchy paths in a synthetic hierarchy of ~1.1M objects (fan-out 10, depth 6) with the linear traversal
+ * and with the scene hierarchy index.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+#include "lsg/core/Object.h"
+#include "lsg/core/Scene.h"
+
+using namespace lsg;
+
+namespace {
+
+constexpr size_t k_fan_out = 10u;
+constexpr size_t k_depth = 6u;
+
+using Clock = std::chrono::steady_clock;
+
+double elapsedMs(Clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+void buildHierarchy(Object& parent, size_t depth, size_t& count) {
+  if (depth == k_depth) {
+    return;
+  }
+
+  for (size_t i = 0u; i < k_fan_out; i++) {
+    Ref<Object> child = makeRef<Object>("N" + std::to_string(i));
+    parent.addChild(child);
+    count++;
+    buildHierarchy(*child, depth + 1u, count);
+  }
+}
+
+std::vector<std::string> randomPaths(const std::string& root, size_t count) {
+  std::mt19937 rng(7u);
+  std::uniform_int_distribution<size_t> element(0u, k_fan_out - 1u);
+  std::uniform_int_distribution<size_t> depth(1u, k_depth);
+
+  std::vector<std::string> paths;
+  for (size_t i = 0u; i < count; i++) {
+    std::string path = "/" + root;
+    for (size_t d = depth(rng); d > 0u; d--) {
+      path += "/N" + std::to_string(element(rng));
+    }
+    paths.emplace_back(std::move(path));
+  }
+
+  return paths;
+}
+
+size_t resolve(const Object& root, const std::vector<std::string>& paths) {
+  size_t found = 0u;
+  for (const std::string& path : paths) {
+    found += root.find(path) ? 1u : 0u;
+  }
+  return found;
+}
+
+} // namespace
+
+int main() {
+  Ref<Object> root = makeRef<Object>("Root");
+  size_t count = 0u;
+  Clock::time_point start = Clock::now();
+  buildHierarchy(*root, 0u, count);
+  std::printf("Built %zu objects in %.1f ms\n", count, elapsedMs(start));
+
+  const std::vector<std::string> linear_paths = randomPaths("Root", 20u);
+  start = Clock::now();
+  size_t found = resolve(*root, linear_paths);
+  double time = elapsedMs(start);
+  std::printf("Linear find:  %zu paths (%zu found) in %.1f ms, %.3f ms/path\n", linear_paths.size(), found, time,
+              time / linear_paths.size());
+
+  Ref<Scene> scene = makeRef<Scene>("Scene");
+  start = Clock::now();
+  scene->addChild(root);
+  std::printf("Indexed %zu objects in %.1f ms\n", count, elapsedMs(start));
+
+  const std::vector<std::string> indexed_paths = randomPaths("Scene/Root", 100000u);
+  start = Clock::now();
+  found = resolve(*scene, indexed_paths);
+  time = elapsedMs(start);
+  std::printf("Indexed find: %zu paths (%zu found) in %.1f ms, %.3f us/path\n", indexed_paths.size(), found, time,
+              time * 1000.0 / indexed_paths.size());
+
+  start = Clock::now();
+  found = 0u;
+  for (const auto& child : root->children()) {
+    found += child->getChild("N5") ? 1u : 0u;
+  }
+  std::printf("Indexed getChild: %zu lookups in %.3f ms\n", found, elapsedMs(start));
+
+  start = Clock::now();
+  root->children()[0]->setName("Renamed");
+  std::printf("Rename of a %zu object subtree in %.1f ms\n", count / k_fan_out, elapsedMs(start));
+
+  return 0;
+}
@@ -0,0 +1,100 @@
+/**
+ * Compares reference counting policies. Ref copy throughput is measured for both policies in a single build, loader and
+ * traversal throughput of the library types use the policy selected with LSG_ATOMIC_REF_COUNT, so compare builds with
+ * the option ON and OFF.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "lsg/components/Transform.h"
+#include "lsg/core/Object.h"
+#include "lsg/core/Ref.h"
+#include "lsg/core/Scene.h"
+
+using namespace lsg;
+
+namespace {
+
+constexpr size_t k_num_objects = 200000u;
+constexpr size_t k_fan_out = 8u;
+constexpr size_t k_copies = 50000000u;
+
+using Clock = std::chrono::steady_clock;
+
+double elapsedMs(Clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+template <typename CountPolicy>
+class Counted : public RefCounter<Counted<CountPolicy>, CountPolicy> {};
+
+template <typename CountPolicy>
+double measureCopies() {
+  Ref<Counted<CountPolicy>> source = makeRef<Counted<CountPolicy>>();
+  std::vector<Ref<Counted<CountPolicy>>> copies(16u);
+
+  const Clock::time_point start = Clock::now();
+  for (size_t i = 0u; i < k_copies; i++) {
+    copies[i % copies.size()] = source;
+  }
+  const double time = elapsedMs(start);
+
+  // Keep the result observable.
+  std::printf("  (use count %zu)\n", source->useCount());
+  return time;
+}
+
+Ref<Scene> load() {
+  Ref<Scene> scene = makeRef<Scene>("Scene");
+  std::vector<Ref<Object>> objects = {scene};
+
+  for (size_t i = 1u; i < k_num_objects; i++) {
+    Ref<Object> object = makeRef<Object>("Object" + std::to_string(i));
+    object->addComponent<Transform>();
+    objects[(i - 1u) / k_fan_out]->addChild(object);
+    objects.emplace_back(object);
+  }
+
+  return scene;
+}
+
+} // namespace
+
+int main() {
+  std::printf("Library policy: %s\n", LSG_ATOMIC_REF_COUNT ? "atomic" : "plain");
+
+  std::printf("Ref copies, atomic: %.1f ms\n", measureCopies<AtomicRefCount>());
+  std::printf("Ref copies, plain:  %.1f ms\n", measureCopies<PlainRefCount>());
+
+  Clock::time_point start = Clock::now();
+  Ref<Scene> scene = load();
+  std::printf("Load %zu objects: %.1f ms\n", k_num_objects, elapsedMs(start));
+
+  // Callbacks taking Refs and Ref returning lookups copy a Ref per visited object.
+  size_t transforms = 0u;
+  start = Clock::now();
+  for (size_t i = 0u; i < 10u; i++) {
+    scene->traverseDown([&](const Ref<Object>& object) {
+      Ref<Transform> transform = object->getComponent<Transform>();
+      Ref<Object> parent = object->parent();
+      transforms += (transform && parent) ? 1u : 0u;
+      return true;
+    });
+  }
+  std::printf("Ref traversal x10: %.1f ms (%zu transforms)\n", elapsedMs(start), transforms);
+
+  transforms = 0u;
+  start = Clock::now();
+  for (size_t i = 0u; i < 10u; i++) {
+    scene->traverseDown([&](Object& object) { transforms += (object.findComponent<Transform>() != nullptr) ? 1u : 0u; });
+  }
+  std::printf("Borrowed traversal x10: %.1f ms (%zu transforms)\n", elapsedMs(start), transforms);
+
+  start = Clock::now();
+  scene.reset();
+  std::printf("Unload: %.1f ms\n", elapsedMs(start));
+
+  return 0;
+}
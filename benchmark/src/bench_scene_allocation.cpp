@@ -0,0 +1,105 @@
+/**
+ * Loads and unloads a synthetic scene with the object and resource counts of a mid sized glTF scene and reports the
+ * number of global heap allocations and the load/unload times. Compare builds with LSG_POOL_ALLOCATION ON and OFF.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include "lsg/components/Mesh.h"
+#include "lsg/components/Transform.h"
+#include "lsg/core/PoolAllocator.h"
+#include "lsg/core/Scene.h"
+#include "lsg/resources/Geometry.h"
+#include "lsg/resources/SubMesh.h"
+
+using namespace lsg;
+
+namespace {
+
+std::atomic<size_t> g_heap_allocations = 0u;
+
+constexpr size_t k_num_nodes = 20000u;
+constexpr size_t k_children_per_node = 8u;
+constexpr size_t k_iterations = 5u;
+
+using Clock = std::chrono::steady_clock;
+
+double elapsedMs(Clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+Ref<Scene> loadScene() {
+  Ref<Scene> scene = makeRef<Scene>("Scene");
+  Ref<Object> parent = scene;
+
+  for (size_t i = 0u; i < k_num_nodes; i++) {
+    Ref<Object> node = makeRef<Object>("Node" + std::to_string(i));
+    node->addComponent<Transform>()->setPosition(glm::vec3(float(i), 0.0f, 0.0f));
+
+    Ref<Geometry> geometry = makeRef<Geometry>();
+    Ref<SubMesh> sub_mesh = makeRef<SubMesh>("SubMesh", geometry, Ref<Material>());
+    node->addComponent<Mesh>(std::vector<Ref<SubMesh>> {sub_mesh});
+
+    parent->addChild(node);
+    if (i % k_children_per_node == 0u) {
+      parent = node;
+    }
+  }
+
+  return scene;
+}
+
+} // namespace
+
+void* operator new(size_t size) {
+  g_heap_allocations.fetch_add(1u, std::memory_order_relaxed);
+  if (void* ptr = std::malloc(size == 0u ? 1u : size)) {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+  std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+  std::free(ptr);
+}
+
+int main() {
+  std::printf("Pool allocation: %s\n", LSG_POOL_ALLOCATION ? "ON" : "OFF");
+
+  double load_time = 0.0;
+  double unload_time = 0.0;
+  size_t heap_allocations = 0u;
+
+  for (size_t i = 0u; i < k_iterations; i++) {
+    const size_t allocations_before = g_heap_allocations.load();
+    Clock::time_point start = Clock::now();
+    Ref<Scene> scene = loadScene();
+    load_time += elapsedMs(start);
+    heap_allocations += g_heap_allocations.load() - allocations_before;
+
+    start = Clock::now();
+    scene.reset();
+    unload_time += elapsedMs(start);
+  }
+
+  const PoolAllocator::Stats stats = PoolAllocator::stats();
+  std::printf("Objects per load:        %zu\n", k_num_nodes + 1u);
+  std::printf("Heap allocations / load: %zu\n", heap_allocations / k_iterations);
+  std::printf("Pooled allocations:      %zu in %zu slabs\n", stats.total_allocations / k_iterations, stats.slabs);
+  std::printf("Load:                    %.2f ms\n", load_time / k_iterations);
+  std::printf("Unload:                  %.2f ms\n", unload_time / k_iterations);
+
+  const Clock::time_point start = Clock::now();
+  const size_t released = PoolAllocator::trim();
+  std::printf("Trim:                    %zu slabs in %.2f ms\n", released, elapsedMs(start));
+
+  return 0;
+}
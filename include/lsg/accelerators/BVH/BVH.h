@@ -19,9 +19,12 @@
 #ifndef LSG_ACCELERATORS_SBVH_NODE_H
 #define LSG_ACCELERATORS_SBVH_NODE_H
 #include <glm/vec2.hpp>
+#include <limits>
+#include <optional>
 #include <stack>
 #include <vector>
 #include "lsg/core/Ref.h"
+#include "lsg/core/ThreadPool.h"
 #include "lsg/math/AABB.h"
 #include "lsg/math/Ray.h"
 
@@ -59,6 +62,26 @@ class BVH : public RefCounter<BVH<T>> {
     };
   };
 
+  /**
+   * Closest primitive hit by a ray.
+   */
+  struct Hit {
+    /**
+     * Primitive index used when the ray does not hit any primitive.
+     */
+    static constexpr uint32_t k_invalid_index = std::numeric_limits<uint32_t>::max();
+
+    /**
+     * Index of the hit primitive or k_invalid_index.
+     */
+    uint32_t prim_index = k_invalid_index;
+
+    /**
+     * Distance along the ray to the hit.
+     */
+    T distance = std::numeric_limits<T>::max();
+  };
+
   BVH() = default;
 
   /**
@@ -87,7 +110,35 @@ class BVH : public RefCounter<BVH<T>> {
 
   std::vector<uint32_t> rayIntersect(const Ray<T>& ray);
 
+  /**
+   * @brief Finds the closest primitive hit for every ray in the batch. Rays are split into chunks that are processed
+   *        on the given thread pool, each worker reusing its own traversal stack. Hits are stored in input order.
+   *
+   * @tparam  IntersectFn   Callable with signature std::optional<T>(const Ray<T>& ray, uint32_t prim_index) that
+   *                        returns distance to the primitive or std::nullopt if the primitive is missed.
+   * @param	  rays          Rays.
+   * @param	  hits          Output hits (resized to the number of rays).
+   * @param	  intersect_fn  Primitive intersection function. Must be safe to call concurrently and must not run
+   *                        parallelFor on the pool, since the per-worker traversal stack is in use during the call.
+   * @param	  pool          Thread pool on which the queries are executed.
+   * @param	  chunk_size    Number of rays processed by a single task.
+   */
+  template <typename IntersectFn>
+  void intersectBatch(const std::vector<Ray<T>>& rays, std::vector<Hit>& hits, const IntersectFn& intersect_fn,
+                      ThreadPool& pool = ThreadPool::global(), size_t chunk_size = 64u) const;
+
  private:
+  /**
+   * @brief   Finds the closest primitive hit for a single ray.
+   *
+   * @param	  ray           Ray.
+   * @param	  intersect_fn  Primitive intersection function.
+   * @param	  stack         Scratch traversal stack.
+   * @return	Closest hit.
+   */
+  template <typename IntersectFn>
+  Hit intersectClosest(const Ray<T>& ray, const IntersectFn& intersect_fn, std::vector<uint32_t>& stack) const;
+
   /**
    * BVH tree nodes.
    */
@@ -159,6 +210,64 @@ std::vector<uint32_t> BVH<T>::rayIntersect(const Ray<T>& ray) {
   return potential_isects;
 }
 
+template <typename T>
+template <typename IntersectFn>
+void BVH<T>::intersectBatch(const std::vector<Ray<T>>& rays, std::vector<Hit>& hits, const IntersectFn& intersect_fn,
+                            ThreadPool& pool, const size_t chunk_size) const {
+  hits.assign(rays.size(), Hit());
+
+  if (nodes_.empty()) {
+    return;
+  }
+
+  // Traversal stack per worker, so that the stacks are allocated once per batch rather than once per ray.
+  std::vector<std::vector<uint32_t>> stacks(pool.numThreads());
+
+  pool.parallelFor(rays.size(), chunk_size, [&](const size_t begin, const size_t end, const size_t slot) {
+    std::vector<uint32_t>& stack = stacks[slot];
+
+    for (size_t i = begin; i < end; i++) {
+      hits[i] = intersectClosest(rays[i], intersect_fn, stack);
+    }
+  });
+}
+
+template <typename T>
+template <typename IntersectFn>
+typename BVH<T>::Hit BVH<T>::intersectClosest(const Ray<T>& ray, const IntersectFn& intersect_fn,
+                                              std::vector<uint32_t>& stack) const {
+  Hit hit;
+  stack.clear();
+  stack.push_back(0u);
+
+  while (!stack.empty()) {
+    const Node& node = nodes_[stack.back()];
+    stack.pop_back();
+
+    // Skip the node if it is missed or lies behind the closest hit found so far.
+    const std::optional<T> entry = ray.intersectAABBDistance(node.bounds);
+    if (!entry.has_value() || entry.value() > hit.distance) {
+      continue;
+    }
+
+    if (!node.is_leaf) {
+      stack.push_back(node.child_indices[0]);
+      stack.push_back(node.child_indices[1]);
+      continue;
+    }
+
+    for (uint32_t i = node.indices_range[0]; i < node.indices_range[1]; i++) {
+      const std::optional<T> distance = intersect_fn(ray, prim_indices_[i]);
+      if (distance.has_value() && distance.value() < hit.distance) {
+        hit.prim_index = prim_indices_[i];
+        hit.distance = distance.value();
+      }
+    }
+  }
+
+  return hit;
+}
+
 } // namespace lsg
 
 #endif // LSG_ACCELERATORS_SBVH_NODE_H
\ No newline at end of file
@@ -20,37 +20,20 @@
 #define LSG_ACCELERATORS_BVH_BUILDER_H
 
 #include <cmath>
-#include <deque>
 #include <functional>
 #include <memory>
 #include <vector>
 #include "lsg/accelerators/BVH/BVH.h"
+#include "lsg/accelerators/BVH/BVHConfig.h"
+#include "lsg/accelerators/BVH/BVHLayout.h"
 #include "lsg/accelerators/BVH/SAHFunction.h"
 #include "lsg/core/Ref.h"
+#include "lsg/core/ThreadPool.h"
 #include "lsg/math/AABB.h"
+#include "lsg/resources/Geometry.h"
 
 namespace lsg::bvh {
 
-/**
- * @brief SAH BVHBuilder configuration.
- */
-struct BVHConfig {
-  /**
-   * @brief Maximum depth of the BVH tree.
-   */
-  size_t max_depth = 64;
-
-  /**
-   * Minimum number of primitives in leaf.
-   */
-  size_t min_leaf_size = 1u;
-
-  /**
-   * Maximum number of primitives in leaf.
-   */
-  size_t max_leaf_size = std::numeric_limits<size_t>::max();
-};
-
 #pragma region StateStructures
 /**
  * @brief Holds information about an object split of the BVH node.
@@ -94,7 +77,7 @@ struct Reference final {
    * @param	bounds  Bounding box of the primitive.
    * @param	index   Index of the primitive.
    */
-  Reference(const AABB<T>& bounds, uint32_t index);
+  explicit Reference(const AABB<T>& bounds = {}, uint32_t index = 0u);
 
   /**
    * Bounding box of the primitive.
@@ -139,6 +122,62 @@ NodeSpec<T>::NodeSpec(const size_t num_refs, const AABB<T>& bounds) : num_refs(n
 
 #pragma endregion
 
+/**
+ * @brief Scratch memory used during the build. Containers are cleared but never shrunk, so a scratch that is kept
+ *        alive across builds (e.g. per-frame rebuilds) stops allocating once it reaches its high-water mark.
+ *        Scratch may be shared by multiple builders as long as they do not build concurrently.
+ */
+template <typename T>
+struct BVHBuildScratch : public RefCounter<BVHBuildScratch<T>> {
+  /**
+   * @brief Clear all containers while keeping their capacity.
+   */
+  void clear();
+
+  /**
+   * Reference stack.
+   */
+  std::vector<Reference<T>> reference_stack;
+
+  /**
+   * Used to store bounding boxes of all the possible right children.
+   */
+  std::vector<AABB<T>> right_bounds;
+
+  /**
+   * Vector of nodes.
+   */
+  std::vector<typename BVH<T>::Node> nodes;
+
+  /**
+   * Vector of primitive references.
+   */
+  std::vector<uint32_t> prim_indices;
+
+  /**
+   * Scratch used to reorder the nodes.
+   */
+  BVHLayoutScratch layout;
+
+  /**
+   * Nodes in the final layout.
+   */
+  std::vector<typename BVH<T>::Node> layout_nodes;
+
+  /**
+   * Primitive indices in the final leaf order.
+   */
+  std::vector<uint32_t> layout_prim_indices;
+};
+
+template <typename T>
+void BVHBuildScratch<T>::clear() {
+  reference_stack.clear();
+  right_bounds.clear();
+  nodes.clear();
+  prim_indices.clear();
+}
+
 /**
  * @brief Class that builds a BVH using SAH.
  */
@@ -150,8 +189,10 @@ class BVHBuilder {
    *
    * @param	sah_function  Function used to compute SHA cost.
    * @param	config        BVH Builder configuration.
+   * @param	scratch       Scratch memory reused across builds. New scratch is created if null.
    */
-  explicit BVHBuilder(SAHFunction sah_function = SAHFunction(), const BVHConfig& config = BVHConfig());
+  explicit BVHBuilder(SAHFunction sah_function = SAHFunction(), const BVHConfig& config = BVHConfig(),
+                      Ref<BVHBuildScratch<T>> scratch = {});
 
   /**
    * @brief   Performs the build.
@@ -160,7 +201,39 @@ class BVHBuilder {
    */
   Ref<BVH<T>> process(const std::vector<AABB<T>>& bounding_boxes);
 
+  /**
+   * @brief   Performs the build over triangles of the given geometry. Triangle bounds are computed in parallel
+   *          directly from the vertex and index buffers. Primitive indices are triangle indices.
+   *
+   * @param	  geometry  Geometry with vertex positions.
+   * @param   pool      Thread pool used to compute triangle bounds or null to compute them on the calling thread.
+   * @return  Shared Bounding Volume Hierarchy object.
+   */
+  Ref<BVH<T>> process(const Geometry& geometry, ThreadPool* pool = &ThreadPool::global());
+
+  /**
+   * @brief   Retrieve scratch memory used by the builder.
+   *
+   * @return  Scratch memory.
+   */
+  const Ref<BVHBuildScratch<T>>& scratch() const;
+
  protected:
+  /**
+   * @brief   Builds the hierarchy over references on the reference stack.
+   *
+   * @param	  root_spec Specification of the root node.
+   * @return	Shared Bounding Volume Hierarchy object.
+   */
+  Ref<BVH<T>> buildFromReferences(const NodeSpec<T>& root_spec);
+
+  /**
+   * @brief   Reorders built nodes into the configured layout and creates the BVH.
+   *
+   * @return	Shared Bounding Volume Hierarchy object.
+   */
+  Ref<BVH<T>> createBVH();
+
   /**
    * @brief   Reference comparison function. Compares midpoints of reference bounding boxes.
    *
@@ -218,34 +291,42 @@ class BVHBuilder {
    */
   BVHConfig config_;
 
+  /**
+   * Scratch memory that owns the containers below.
+   */
+  Ref<BVHBuildScratch<T>> scratch_;
+
   /**
    * Reference stack.
    */
-  std::deque<Reference<T>> t_reference_stack_;
+  std::vector<Reference<T>>& t_reference_stack_;
 
   /**
    * Used to store bounding boxes of all the possible right children.
    */
-  std::vector<AABB<T>> t_right_bounds_;
+  std::vector<AABB<T>>& t_right_bounds_;
 
   /**
    * Vector of nodes.
    */
-  std::vector<typename BVH<T>::Node> t_nodes_;
+  std::vector<typename BVH<T>::Node>& t_nodes_;
 
   /**
    * Vector of primitive references.
    */
-  std::vector<uint32_t> t_prim_indices_;
+  std::vector<uint32_t>& t_prim_indices_;
 };
 
 template <typename T>
-BVHBuilder<T>::BVHBuilder(SAHFunction sah_function, const BVHConfig& config)
-  : sah_function_(std::move(sah_function)), config_(config) {}
+BVHBuilder<T>::BVHBuilder(SAHFunction sah_function, const BVHConfig& config, Ref<BVHBuildScratch<T>> scratch)
+  : sah_function_(std::move(sah_function)), config_(config),
+    scratch_(scratch ? std::move(scratch) : makeRef<BVHBuildScratch<T>>()),
+    t_reference_stack_(scratch_->reference_stack), t_right_bounds_(scratch_->right_bounds), t_nodes_(scratch_->nodes),
+    t_prim_indices_(scratch_->prim_indices) {}
 
 template <typename T>
 Ref<BVH<T>> BVHBuilder<T>::process(const std::vector<AABB<T>>& bounding_boxes) {
-  t_reference_stack_.clear();
+  scratch_->clear();
 
   // Generate references and compute root node bounding box.
   NodeSpec<T> root_spec(bounding_boxes.size());
@@ -255,17 +336,101 @@ Ref<BVH<T>> BVHBuilder<T>::process(const std::vector<AABB<T>>& bounding_boxes) {
     root_spec.bounds.expand(bounding_boxes[i]);
   }
 
+  return buildFromReferences(root_spec);
+}
+
+template <typename T>
+Ref<BVH<T>> BVHBuilder<T>::process(const Geometry& geometry, ThreadPool* pool) {
+  throwIf<IllegalInvocation>(!geometry.hasVertices(), "Tried to build BVH for geometry without vertex positions.");
+
+  scratch_->clear();
+
+  const TBufferAccessor<glm::vec3>& vertices = geometry.getVertices();
+  const size_t num_triangles = (geometry.hasIndices() ? geometry.getIndices().count() : vertices.count()) / 3u;
+  t_reference_stack_.resize(num_triangles);
+
+  // Partial root bounds of each worker.
+  std::vector<AABB<T>> slot_bounds(pool ? pool->numThreads() : 1u);
+
+  auto compute_bounds = [&](const auto& vertex_index) {
+    auto chunk = [&](const size_t begin, const size_t end, const size_t slot) {
+      for (size_t i = begin; i < end; i++) {
+        Reference<T>& ref = t_reference_stack_[i];
+        ref.index = static_cast<uint32_t>(i);
+        ref.bounds.reset();
+
+        for (size_t v = 0u; v < 3u; v++) {
+          ref.bounds.expand(glm::tvec3<T>(vertices[vertex_index(i * 3u + v)]));
+        }
+
+        slot_bounds[slot].expand(ref.bounds);
+      }
+    };
+
+    if (pool) {
+      pool->parallelFor(num_triangles, 4096u, chunk);
+    } else {
+      chunk(0u, num_triangles, 0u);
+    }
+  };
+
+  if (!geometry.hasIndices()) {
+    compute_bounds([](const size_t index) { return index; });
+  } else if (geometry.getIndices().elementSize() == sizeof(uint16_t)) {
+    const TBufferAccessor<uint16_t> indices(geometry.getIndices());
+    compute_bounds([&indices](const size_t index) { return indices[index]; });
+  } else if (geometry.getIndices().elementSize() == sizeof(uint32_t)) {
+    const TBufferAccessor<uint32_t> indices(geometry.getIndices());
+    compute_bounds([&indices](const size_t index) { return indices[index]; });
+  } else {
+    throw IllegalInvocation("Unknown index type.");
+  }
+
+  // Merge partial bounds. Workers that received no chunk leave their bounds empty.
+  NodeSpec<T> root_spec(num_triangles);
+  for (const AABB<T>& bounds : slot_bounds) {
+    if (bounds.valid()) {
+      root_spec.bounds.expand(bounds);
+    }
+  }
+
+  return buildFromReferences(root_spec);
+}
+
+template <typename T>
+const Ref<BVHBuildScratch<T>>& BVHBuilder<T>::scratch() const {
+  return scratch_;
+}
+
+template <typename T>
+Ref<BVH<T>> BVHBuilder<T>::buildFromReferences(const NodeSpec<T>& root_spec) {
+  if (root_spec.num_refs == 0u) {
+    return makeRef<BVH<T>>();
+  }
+
   // We need cache for at most N - 1 right bounds.
   t_right_bounds_.resize(root_spec.num_refs - 1);
 
   // Clear nodes and primitive indices vectors and reserve.
   t_nodes_.clear();
   t_prim_indices_.clear();
-  t_nodes_.reserve(bounding_boxes.size());
-  t_prim_indices_.reserve(bounding_boxes.size());
+  t_nodes_.reserve(root_spec.num_refs * 2u);
+  t_prim_indices_.reserve(root_spec.num_refs);
 
   buildNode(root_spec, 0);
-  return makeRef<BVH<T>>(std::move(t_nodes_), std::move(t_prim_indices_));
+  return createBVH();
+}
+
+template <typename T>
+Ref<BVH<T>> BVHBuilder<T>::createBVH() {
+  // Copy the results so that the scratch keeps its capacity for the next build.
+  if (config_.node_layout == NodeLayout::kBuildOrder) {
+    return makeRef<BVH<T>>(t_nodes_, t_prim_indices_);
+  }
+
+  reorderNodes<T>(t_nodes_, t_prim_indices_, config_.node_layout, scratch_->layout, scratch_->layout_nodes,
+                  scratch_->layout_prim_indices);
+  return makeRef<BVH<T>>(scratch_->layout_nodes, scratch_->layout_prim_indices);
 }
 
 template <typename T>
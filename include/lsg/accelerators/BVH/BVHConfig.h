@@ -0,0 +1,88 @@
+/**
+ * Project LogiSceneGraph source code
+ * Copyright (C) 2019 Primoz Lavric
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LSG_ACCELERATORS_BVH_CONFIG_H
+#define LSG_ACCELERATORS_BVH_CONFIG_H
+
+#include <cstddef>
+#include <limits>
+
+namespace lsg::bvh {
+
+/**
+ * @brief Order in which the built nodes are stored.
+ */
+enum class NodeLayout {
+  /**
+   * Order in which the nodes were created (right subtree before left subtree).
+   */
+  kBuildOrder,
+
+  /**
+   * Depth first order with the child that is more likely to be visited (larger surface area) next to its parent.
+   */
+  kDepthFirst,
+
+  /**
+   * Cache oblivious van Emde Boas order. Tree is recursively split at half height and the top tree is stored before
+   * the bottom trees. Children are ordered by the visit probability as in kDepthFirst.
+   */
+  kVanEmdeBoas
+};
+
+/**
+ * @brief SAH BVHBuilder configuration.
+ */
+struct BVHConfig {
+  /**
+   * @brief Maximum depth of the BVH tree.
+   */
+  size_t max_depth = 64;
+
+  /**
+   * Minimum number of primitives in leaf.
+   */
+  size_t min_leaf_size = 1u;
+
+  /**
+   * Maximum number of primitives in leaf.
+   */
+  size_t max_leaf_size = std::numeric_limits<size_t>::max();
+
+  /**
+   * Order in which the nodes are stored. Primitive indices are stored in leaf order.
+   */
+  NodeLayout node_layout = NodeLayout::kDepthFirst;
+
+  bool operator==(const BVHConfig& rhs) const;
+
+  bool operator!=(const BVHConfig& rhs) const;
+};
+
+inline bool BVHConfig::operator==(const BVHConfig& rhs) const {
+  return max_depth == rhs.max_depth && min_leaf_size == rhs.min_leaf_size && max_leaf_size == rhs.max_leaf_size &&
+         node_layout == rhs.node_layout;
+}
+
+inline bool BVHConfig::operator!=(const BVHConfig& rhs) const {
+  return !(*this == rhs);
+}
+
+} // namespace lsg::bvh
+
+#endif // LSG_ACCELERATORS_BVH_CONFIG_H
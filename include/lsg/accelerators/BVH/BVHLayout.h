@@ -0,0 +1,223 @@
+/**
+ * Project LogiSceneGraph source code
+ * Copyright (C) 2019 Primoz Lavric
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LSG_ACCELERATORS_BVH_LAYOUT_H
+#define LSG_ACCELERATORS_BVH_LAYOUT_H
+
+#include <algorithm>
+#include <vector>
+#include "lsg/accelerators/BVH/BVH.h"
+#include "lsg/accelerators/BVH/BVHConfig.h"
+
+namespace lsg::bvh {
+
+/**
+ * @brief Scratch memory used when reordering the nodes.
+ */
+struct BVHLayoutScratch {
+  /**
+   * Old node indices in the new order.
+   */
+  std::vector<uint32_t> order;
+
+  /**
+   * New index of every old node.
+   */
+  std::vector<uint32_t> new_indices;
+
+  /**
+   * Node stack.
+   */
+  std::vector<uint32_t> stack;
+
+  /**
+   * Number of levels of every subtree.
+   */
+  std::vector<uint32_t> heights;
+  /**
+   * Subtree roots collected by the van Emde Boas recursion. Every call appends the roots of the subtrees below its
+   * levels and consumes the roots of its own bottom trees.
+   */
+  std::vector<uint32_t> roots;
+};
+
+namespace detail {
+
+/**
+ * @brief   Retrieve children of the inner node with the child that is more likely to be visited first. Visit
+ *          probability of a child is proportional to its surface area.
+ */
+template <typename T>
+glm::uvec2 orderedChildren(const std::vector<typename BVH<T>::Node>& nodes, const typename BVH<T>::Node& node) {
+  const uint32_t left = node.child_indices[0];
+  const uint32_t right = node.child_indices[1];
+
+  if (nodes[right].bounds.area() > nodes[left].bounds.area()) {
+    return glm::uvec2(right, left);
+  }
+
+  return glm::uvec2(left, right);
+}
+
+template <typename T>
+void depthFirstOrder(const std::vector<typename BVH<T>::Node>& nodes, BVHLayoutScratch& scratch) {
+  scratch.stack.assign(1u, 0u);
+
+  while (!scratch.stack.empty()) {
+    const uint32_t index = scratch.stack.back();
+    scratch.stack.pop_back();
+    scratch.order.emplace_back(index);
+
+    if (!nodes[index].is_leaf) {
+      // Push the colder child first so that the hotter child is emitted right after the parent.
+      const glm::uvec2 children = orderedChildren<T>(nodes, nodes[index]);
+      scratch.stack.emplace_back(children[1]);
+      scratch.stack.emplace_back(children[0]);
+    }
+  }
+}
+
+template <typename T>
+uint32_t computeHeights(const std::vector<typename BVH<T>::Node>& nodes, BVHLayoutScratch& scratch) {
+  // Children are always created after the parent in the build order, but not necessarily in other orders, so resolve
+  // the heights with an explicit post-order traversal.
+  scratch.heights.assign(nodes.size(), 0u);
+  scratch.stack.assign(1u, 0u);
+
+  while (!scratch.stack.empty()) {
+    const uint32_t index = scratch.stack.back();
+    const typename BVH<T>::Node& node = nodes[index];
+
+    if (node.is_leaf) {
+      scratch.heights[index] = 1u;
+      scratch.stack.pop_back();
+    } else if (scratch.heights[node.child_indices[0]] == 0u || scratch.heights[node.child_indices[1]] == 0u) {
+      scratch.stack.emplace_back(node.child_indices[0]);
+      scratch.stack.emplace_back(node.child_indices[1]);
+    } else {
+      scratch.heights[index] =
+        1u + std::max(scratch.heights[node.child_indices[0]], scratch.heights[node.child_indices[1]]);
+      scratch.stack.pop_back();
+    }
+  }
+
+  return scratch.heights[0];
+}
+
+/**
+ * @brief Emits the top levels of the subtree in van Emde Boas order and appends roots of the subtrees below them to
+ *        scratch.roots.
+ */
+template <typename T>
+void vanEmdeBoasOrder(const std::vector<typename BVH<T>::Node>& nodes, BVHLayoutScratch& scratch,
+                      const uint32_t root, const uint32_t levels) {
+  const typename BVH<T>::Node& node = nodes[root];
+
+  if (levels == 1u || node.is_leaf) {
+    scratch.order.emplace_back(root);
+
+    if (!node.is_leaf) {
+      const glm::uvec2 children = orderedChildren<T>(nodes, node);
+      scratch.roots.emplace_back(children[0]);
+      scratch.roots.emplace_back(children[1]);
+    }
+    return;
+  }
+
+  // Store the top half first, followed by the bottom trees hanging from it.
+  const uint32_t top_levels = levels / 2u;
+  const size_t bottom_begin = scratch.roots.size();
+  vanEmdeBoasOrder<T>(nodes, scratch, root, top_levels);
+  const size_t bottom_end = scratch.roots.size();
+
+  for (size_t i = bottom_begin; i < bottom_end; i++) {
+    vanEmdeBoasOrder<T>(nodes, scratch, scratch.roots[i], levels - top_levels);
+  }
+
+  // Only the roots below the bottom trees remain.
+  scratch.roots.erase(scratch.roots.begin() + bottom_begin, scratch.roots.begin() + bottom_end);
+}
+
+} // namespace detail
+
+/**
+ * @brief Reorders the nodes into the given layout. Root stays at index 0, child indices are remapped and primitive
+ *        indices are stored in the order in which the leaves appear.
+ *
+ * @param	nodes                 Nodes.
+ * @param	prim_indices          Primitive indices.
+ * @param	layout                Requested node layout.
+ * @param	scratch               Scratch memory.
+ * @param	out_nodes             Reordered nodes.
+ * @param	out_prim_indices      Reordered primitive indices.
+ */
+template <typename T>
+void reorderNodes(const std::vector<typename BVH<T>::Node>& nodes, const std::vector<uint32_t>& prim_indices,
+                  const NodeLayout layout, BVHLayoutScratch& scratch, std::vector<typename BVH<T>::Node>& out_nodes,
+                  std::vector<uint32_t>& out_prim_indices) {
+  out_nodes.clear();
+  out_prim_indices.clear();
+  scratch.order.clear();
+
+  if (nodes.empty()) {
+    return;
+  }
+
+  if (layout == NodeLayout::kBuildOrder) {
+    out_nodes = nodes;
+    out_prim_indices = prim_indices;
+    return;
+  }
+
+  scratch.order.reserve(nodes.size());
+
+  if (layout == NodeLayout::kDepthFirst) {
+    detail::depthFirstOrder<T>(nodes, scratch);
+  } else {
+    scratch.roots.clear();
+    detail::vanEmdeBoasOrder<T>(nodes, scratch, 0u, detail::computeHeights<T>(nodes, scratch));
+  }
+
+  scratch.new_indices.resize(nodes.size());
+  for (uint32_t i = 0; i < scratch.order.size(); i++) {
+    scratch.new_indices[scratch.order[i]] = i;
+  }
+
+  // Copy nodes in the new order and remap the references.
+  out_nodes.reserve(nodes.size());
+  out_prim_indices.reserve(prim_indices.size());
+
+  for (const uint32_t old_index : scratch.order) {
+    typename BVH<T>::Node& node = out_nodes.emplace_back(nodes[old_index]);
+
+    if (node.is_leaf) {
+      const glm::uvec2 range = node.indices_range;
+      node.indices_range[0] = out_prim_indices.size();
+      out_prim_indices.insert(out_prim_indices.end(), prim_indices.begin() + range[0],
+                              prim_indices.begin() + range[1]);
+      node.indices_range[1] = out_prim_indices.size();
+    } else {
+      node.child_indices[0] = scratch.new_indices[node.child_indices[0]];
+      node.child_indices[1] = scratch.new_indices[node.child_indices[1]];
+    }
+  }
+}
+
+} // namespace lsg::bvh
+
+#endif // LSG_ACCELERATORS_BVH_LAYOUT_H
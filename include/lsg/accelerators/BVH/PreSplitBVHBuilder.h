@@ -0,0 +1,215 @@
+/**
+ * Project LogiSceneGraph source code
+ * Copyright (C) 2019 Primoz Lavric
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LSG_ACCELERATORS_BVH_PRE_SPLIT_BVH_BUILDER_H
+#define LSG_ACCELERATORS_BVH_PRE_SPLIT_BVH_BUILDER_H
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+#include "lsg/accelerators/BVH/BVHBuilder.h"
+#include "lsg/accelerators/BVH/SplitBVHBuilder.h"
+#include "lsg/core/Ref.h"
+#include "lsg/resources/Triangle.h"
+
+namespace lsg::bvh {
+
+/**
+ * @brief Configuration of the triangle pre-splitting pass.
+ */
+struct PreSplitBVHConfig {
+  /**
+   * References whose bounds surface area is larger than this fraction of the root bounds surface area are split.
+   */
+  double size_threshold = 1.0e-3;
+
+  /**
+   * Maximum number of additional references relative to the number of triangles (0.5 allows 50% more references).
+   */
+  double reference_budget = 0.5;
+};
+
+/**
+ * @brief Builds BVH over triangles that are subdivided before the build (early split clipping). Largest references
+ *        are repeatedly split at the middle of their longest axis and clipped to the triangle until they are below the
+ *        size threshold or the reference budget is exhausted. Standard object split build is then performed over the
+ *        references. This recovers most of the SplitBVHBuilder quality on long diagonal triangles at a fraction of its
+ *        build time. Leaves may reference the same triangle multiple times.
+ */
+template <typename T>
+class PreSplitBVHBuilder : public BVHBuilder<T> {
+ public:
+  explicit PreSplitBVHBuilder(const SAHFunction& sha_function = SAHFunction(),
+                              const BVHConfig& bvh_config = BVHConfig(),
+                              const PreSplitBVHConfig& pre_split_config = PreSplitBVHConfig(),
+                              Ref<BVHBuildScratch<T>> scratch = {});
+
+  /**
+   * @brief   Performs the pre-split and the build.
+   *
+   * @param	  triangle_accessor Triangle accessor.
+   * @return  Shared Bounding Volume Hierarchy object.
+   */
+  Ref<BVH<T>> process(const Ref<TriangleAccessor<glm::tvec3<T>>>& triangle_accessor);
+
+  /**
+   * @brief   Performs the pre-split and the build over triangles of the given geometry.
+   *
+   * @param	  geometry  Geometry with vertex positions.
+   * @return  Shared Bounding Volume Hierarchy object.
+   */
+  Ref<BVH<T>> process(const Geometry& geometry);
+
+  virtual ~PreSplitBVHBuilder() = default;
+
+ protected:
+  /**
+   * Declare base class members (this is required because base class is a template).
+   */
+  using BVHBuilder<T>::buildFromReferences;
+
+  using BVHBuilder<T>::scratch_;
+  using BVHBuilder<T>::t_reference_stack_;
+
+  /**
+   * @brief Splits references on the reference stack until they are small enough or the budget is exhausted.
+   *
+   * @param	root_spec Specification of the root node. Number of references is updated.
+   */
+  void preSplit(NodeSpec<T>& root_spec);
+
+  /**
+   * Pre-split configuration.
+   */
+  PreSplitBVHConfig pre_split_config_;
+
+  /**
+   * Max heap of reference surface areas and indices.
+   */
+  std::vector<std::pair<T, uint32_t>> t_split_heap_;
+
+  /**
+   * Triangle accessor.
+   */
+  Ref<TriangleAccessor<glm::tvec3<T>>> t_triangle_accessor_;
+};
+
+template <typename T>
+PreSplitBVHBuilder<T>::PreSplitBVHBuilder(const SAHFunction& sha_function, const BVHConfig& bvh_config,
+                                          const PreSplitBVHConfig& pre_split_config, Ref<BVHBuildScratch<T>> scratch)
+  : BVHBuilder<T>(sha_function, bvh_config, std::move(scratch)), pre_split_config_(pre_split_config) {}
+
+template <typename T>
+Ref<BVH<T>> PreSplitBVHBuilder<T>::process(const Ref<TriangleAccessor<glm::tvec3<T>>>& triangle_accessor) {
+  t_triangle_accessor_ = triangle_accessor;
+  scratch_->clear();
+
+  // Generate references and compute root node bounding box.
+  NodeSpec<T> root_spec(t_triangle_accessor_->count());
+
+  for (uint32_t i = 0; i < t_triangle_accessor_->count(); i++) {
+    Triangle<glm::tvec3<T>> tri = (*t_triangle_accessor_)[i];
+    AABB<T> bounds;
+
+    // Compute triangle bounding box.
+    bounds.expand(tri[0]);
+    bounds.expand(tri[1]);
+    bounds.expand(tri[2]);
+
+    t_reference_stack_.emplace_back(bounds, i);
+    root_spec.bounds.expand(bounds);
+  }
+
+  preSplit(root_spec);
+
+  Ref<BVH<T>> bvh = buildFromReferences(root_spec);
+  t_triangle_accessor_.reset();
+  return bvh;
+}
+
+template <typename T>
+Ref<BVH<T>> PreSplitBVHBuilder<T>::process(const Geometry& geometry) {
+  return process(geometry.getTrianglePositionAccessor());
+}
+
+template <typename T>
+void PreSplitBVHBuilder<T>::preSplit(NodeSpec<T>& root_spec) {
+  const T min_area = T(root_spec.bounds.area() * pre_split_config_.size_threshold);
+  const size_t max_refs =
+    root_spec.num_refs + static_cast<size_t>(double(root_spec.num_refs) * pre_split_config_.reference_budget);
+
+  // Add all references that exceed the threshold to the heap.
+  t_split_heap_.clear();
+
+  for (uint32_t i = 0; i < t_reference_stack_.size(); i++) {
+    const T area = t_reference_stack_[i].bounds.area();
+    if (area > min_area) {
+      t_split_heap_.emplace_back(area, i);
+    }
+  }
+
+  std::make_heap(t_split_heap_.begin(), t_split_heap_.end());
+
+  // Always split the largest reference first so that the budget is spent where it matters the most.
+  while (!t_split_heap_.empty() && t_reference_stack_.size() < max_refs) {
+    std::pop_heap(t_split_heap_.begin(), t_split_heap_.end());
+    const uint32_t ref_index = t_split_heap_.back().second;
+    t_split_heap_.pop_back();
+
+    const Reference<T> ref = t_reference_stack_[ref_index];
+    const glm::tvec3<T> dimensions = ref.bounds.dimensions();
+
+    // Split in the middle of the longest axis.
+    size_t axis = 0u;
+    if (dimensions[1] > dimensions[axis]) {
+      axis = 1u;
+    }
+    if (dimensions[2] > dimensions[axis]) {
+      axis = 2u;
+    }
+
+    const T split_pos = ref.bounds.center()[axis];
+    const std::pair<AABB<T>, AABB<T>> split =
+      splitTriangleBounds((*t_triangle_accessor_)[ref.index], ref.bounds, axis, split_pos);
+
+    // Keep the reference if the triangle does not reach both sides (e.g. degenerate triangle).
+    if (!split.first.valid() || !split.second.valid()) {
+      continue;
+    }
+
+    t_reference_stack_[ref_index].bounds = split.first;
+    t_reference_stack_.emplace_back(split.second, ref.index);
+
+    // Pieces that are still too large are candidates for further splitting.
+    const uint32_t new_index = static_cast<uint32_t>(t_reference_stack_.size() - 1u);
+
+    for (const std::pair<T, uint32_t>& piece : {std::make_pair(split.first.area(), ref_index),
+                                                std::make_pair(split.second.area(), new_index)}) {
+      if (piece.first > min_area) {
+        t_split_heap_.emplace_back(piece);
+        std::push_heap(t_split_heap_.begin(), t_split_heap_.end());
+      }
+    }
+  }
+
+  root_spec.num_refs = t_reference_stack_.size();
+}
+
+} // namespace lsg::bvh
+
+#endif // LSG_ACCELERATORS_BVH_PRE_SPLIT_BVH_BUILDER_H
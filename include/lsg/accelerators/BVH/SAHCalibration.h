@@ -0,0 +1,105 @@
+/**
+ * Project LogiSceneGraph source code
+ * Copyright (C) 2019 Primoz Lavric
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LSG_ACCELERATORS_BVH_SAH_CALIBRATION_H
+#define LSG_ACCELERATORS_BVH_SAH_CALIBRATION_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "lsg/accelerators/BVH/SAHFunction.h"
+
+namespace lsg {
+namespace bvh {
+
+/**
+ * @brief Configuration of the host SAH cost calibration.
+ */
+struct SAHCalibrationConfig {
+  /**
+   * Number of random boxes and triangles in the benchmark working set.
+   */
+  size_t num_primitives = 1024u;
+
+  /**
+   * Number of random rays tested against the working set.
+   */
+  size_t num_rays = 256u;
+
+  /**
+   * Number of timed repetitions. The fastest repetition is used to suppress scheduling noise.
+   */
+  size_t num_repetitions = 5u;
+
+  /**
+   * Candidate node batch sizes.
+   */
+  std::vector<size_t> batch_sizes = {1u, 2u, 4u, 8u, 16u};
+
+  /**
+   * Node batch size is accepted if testing the whole batch costs at most (1 + batch_tolerance) times a single test.
+   */
+  float batch_tolerance = 0.25f;
+
+  /**
+   * Primitive batch size of the produced SAH function. Ray-triangle tests have no batched kernel, so this value is
+   * not calibrated.
+   */
+  size_t primitive_batch_size = 1u;
+
+  /**
+   * Seed of the random working set.
+   */
+  uint32_t seed = 0u;
+};
+
+/**
+ * @brief Result of the host SAH cost calibration.
+ */
+struct SAHCalibrationResult {
+  /**
+   * Measured time of a single ray-box test in nanoseconds.
+   */
+  double node_test_ns = 0.0;
+
+  /**
+   * Measured time of a single ray-triangle test in nanoseconds.
+   */
+  double primitive_test_ns = 0.0;
+
+  /**
+   * SAH function fitted to the measurements. Node cost is normalized to 1.
+   */
+  SAHFunction sah_function;
+};
+
+/**
+ * @brief   Micro-benchmarks ray-box tests (node traversal) against ray-triangle tests (primitive intersection) on the
+ *          host and fits SAH costs and the node batch size to the measurements.
+ *
+ * @param	  config  Calibration configuration.
+ * @param   name    Name of the produced SAH function.
+ * @return	Calibration result containing the fitted SAH function.
+ */
+SAHCalibrationResult calibrateSAH(const SAHCalibrationConfig& config = SAHCalibrationConfig(),
+                                  const std::string& name = "Calibrated");
+
+} // namespace bvh
+} // namespace lsg
+
+#endif // LSG_ACCELERATORS_BVH_SAH_CALIBRATION_H
@@ -47,6 +47,10 @@ public:
 	size_t roundToPrimitiveBatchSize(size_t n) const;
 	size_t roundToNodeBatchSize(size_t n) const;
 
+	// comparison of costs and batch sizes (name is ignored)
+	bool operator==(const SAHFunction& rhs) const;
+	bool operator!=(const SAHFunction& rhs) const;
+
 private:
 	/**
 	 * Cost of node traversal.
@@ -19,6 +19,7 @@
 #ifndef LSG_ACCELERATORS_BVH_SPLIT_BVH_BUILDER_H
 #define LSG_ACCELERATORS_BVH_SPLIT_BVH_BUILDER_H
 #include <array>
+#include <tuple>
 #include "lsg/accelerators/BVH/BVHBuilder.h"
 #include "lsg/core/Ref.h"
 #include "lsg/resources/Triangle.h"
@@ -87,14 +88,67 @@ struct SpatialBin final {
 };
 #pragma endregion
 
+/**
+ * @brief   Splits part of the triangle that lies within the given bounds with an axis aligned plane and computes tight
+ *          bounds of both parts. Bounds of the side that the triangle does not reach are invalid.
+ *
+ * @param	  tri       Triangle.
+ * @param	  bounds    Bounds of the triangle part that is split (triangle bounds or bounds of a previous split).
+ * @param	  axis      Split plane axis.
+ * @param	  split_pos Split plane position.
+ * @return	Bounds of the part below and above the split plane.
+ */
+template <typename T>
+std::pair<AABB<T>, AABB<T>> splitTriangleBounds(const Triangle<glm::tvec3<T>>& tri, const AABB<T>& bounds, size_t axis,
+                                                T split_pos) {
+  AABB<T> left;
+  AABB<T> right;
+
+  // Loop over edges.
+  for (size_t i = 0u; i < 3u; i++) {
+    const glm::tvec3<T>& v0 = tri[i];
+    const glm::tvec3<T>& v1 = tri[(i + 1u) % 3u];
+
+    // Insert vertex to the boxes it belongs to.
+    if (v0[axis] <= split_pos) {
+      left.expand(v0);
+    }
+    if (v0[axis] >= split_pos) {
+      right.expand(v0);
+    }
+
+    // If edge intersects split plane insert interpolated vertex in both bounding boxes.
+    if ((v0[axis] < split_pos && v1[axis] > split_pos) || (v0[axis] > split_pos && v1[axis] < split_pos)) {
+      glm::tvec3<T> pt = glm::mix(
+        v0, v1, glm::clamp((split_pos - v0[axis]) / (v1[axis] - v0[axis]), static_cast<T>(0.0), static_cast<T>(1.0)));
+      left.expand(pt);
+      right.expand(pt);
+    }
+  }
+
+  // Intersect with original bounds.
+  left.setMaxAtAxis(split_pos, axis);
+  right.setMinAtAxis(split_pos, axis);
+
+  return {left.intersect(bounds), right.intersect(bounds)};
+}
+
 template <typename T>
 class SplitBVHBuilder : public BVHBuilder<T> {
  public:
   explicit SplitBVHBuilder(const SAHFunction& sha_function = SAHFunction(), const BVHConfig& bvh_config = BVHConfig(),
-                           const SplitBVHConfig& split_config = SplitBVHConfig());
+                           const SplitBVHConfig& split_config = SplitBVHConfig(), Ref<BVHBuildScratch<T>> scratch = {});
 
   Ref<BVH<T>> process(const Ref<TriangleAccessor<glm::tvec3<T>>>& triangle_accessor);
 
+  /**
+   * @brief   Performs the build over triangles of the given geometry.
+   *
+   * @param	  geometry  Geometry with vertex positions.
+   * @return  Shared Bounding Volume Hierarchy object.
+   */
+  Ref<BVH<T>> process(const Geometry& geometry);
+
   virtual ~SplitBVHBuilder() = default;
 
  protected:
@@ -105,11 +159,13 @@ class SplitBVHBuilder : public BVHBuilder<T> {
 
   using BVHBuilder<T>::process;
   using BVHBuilder<T>::createLeaf;
+  using BVHBuilder<T>::createBVH;
   using BVHBuilder<T>::findObjectSplit;
   using BVHBuilder<T>::performObjectSplit;
 
   using BVHBuilder<T>::sah_function_;
   using BVHBuilder<T>::config_;
+  using BVHBuilder<T>::scratch_;
   using BVHBuilder<T>::t_reference_stack_;
   using BVHBuilder<T>::t_right_bounds_;
   using BVHBuilder<T>::t_nodes_;
@@ -146,8 +202,9 @@ class SplitBVHBuilder : public BVHBuilder<T> {
 
 template <typename T>
 SplitBVHBuilder<T>::SplitBVHBuilder(const SAHFunction& sha_function, const BVHConfig& bvh_config,
-                                    const SplitBVHConfig& split_config)
-  : BVHBuilder<T>(sha_function, bvh_config), split_config_(split_config), t_min_overlap_(), t_triangle_accessor_() {
+                                    const SplitBVHConfig& split_config, Ref<BVHBuildScratch<T>> scratch)
+  : BVHBuilder<T>(sha_function, bvh_config, std::move(scratch)), split_config_(split_config), t_min_overlap_(),
+    t_triangle_accessor_() {
   for (size_t i = 0; i < 3u; i++) {
     t_spatial_bins_[i].resize(split_config_.num_spatial_bins);
   }
@@ -156,6 +213,7 @@ SplitBVHBuilder<T>::SplitBVHBuilder(const SAHFunction& sha_function, const BVHCo
 template <typename T>
 Ref<BVH<T>> SplitBVHBuilder<T>::process(const Ref<TriangleAccessor<glm::tvec3<T>>>& triangle_accessor) {
   t_triangle_accessor_ = triangle_accessor;
+  scratch_->clear();
 
   // Generate references and compute root node bounding box.
   NodeSpec<T> root_spec(t_triangle_accessor_->count());
@@ -173,6 +231,10 @@ Ref<BVH<T>> SplitBVHBuilder<T>::process(const Ref<TriangleAccessor<glm::tvec3<T>
     root_spec.bounds.expand(bounds);
   }
 
+  if (root_spec.num_refs == 0u) {
+    return makeRef<BVH<T>>();
+  }
+
   t_min_overlap_ = T(root_spec.bounds.area() * split_config_.split_alpha);
 
   // We need cache for at most max(N - 1, num_spatial_bins) right bounds.
@@ -185,7 +247,12 @@ Ref<BVH<T>> SplitBVHBuilder<T>::process(const Ref<TriangleAccessor<glm::tvec3<T>
   t_prim_indices_.reserve(t_right_bounds_.size());
 
   buildNode(root_spec, 0);
-  return makeRef<BVH<T>>(std::move(t_nodes_), std::move(t_prim_indices_));
+  return createBVH();
+}
+
+template <typename T>
+Ref<BVH<T>> SplitBVHBuilder<T>::process(const Geometry& geometry) {
+  return process(geometry.getTrianglePositionAccessor());
 }
 
 template <typename T>
@@ -320,38 +387,9 @@ template <typename T>
 std::pair<Reference<T>, Reference<T>> SplitBVHBuilder<T>::splitReference(const Reference<T>& ref, size_t axis,
                                                                          T split_pos) const {
   Reference<T> left = ref;
-  left.bounds.reset();
-  Reference<T> right = left;
-
-  Triangle<glm::tvec3<T>> tri = (*t_triangle_accessor_)[ref.index];
-
-  // Loop over edges.
-  for (size_t i = 0u; i < 3u; i++) {
-    const glm::tvec3<T>& v0 = tri[i];
-    const glm::tvec3<T>& v1 = tri[(i + 1u) % 3u];
-
-    // Insert vertex to the boxes it belongs to.
-    if (v0[axis] <= split_pos) {
-      left.bounds.expand(v0);
-    }
-    if (v0[axis] >= split_pos) {
-      right.bounds.expand(v0);
-    }
-
-    // If edge intersects split plane insert interpolated vertex in both bounding boxes.
-    if ((v0[axis] < split_pos && v1[axis] > split_pos) || (v0[axis] > split_pos && v1[axis] < split_pos)) {
-      glm::tvec3<T> pt = glm::mix(
-        v0, v1, glm::clamp((split_pos - v0[axis]) / (v1[axis] - v0[axis]), static_cast<T>(0.0), static_cast<T>(1.0)));
-      left.bounds.expand(pt);
-      right.bounds.expand(pt);
-    }
-  }
-
-  // Intersect with original bounds.
-  left.bounds.setMaxAtAxis(split_pos, axis);
-  right.bounds.setMinAtAxis(split_pos, axis);
-  left.bounds.intersect(ref.bounds);
-  right.bounds.intersect(ref.bounds);
+  Reference<T> right = ref;
+  std::tie(left.bounds, right.bounds) =
+    splitTriangleBounds((*t_triangle_accessor_)[ref.index], ref.bounds, axis, split_pos);
 
   return {left, right};
 }
@@ -359,7 +397,7 @@ std::pair<Reference<T>, Reference<T>> SplitBVHBuilder<T>::splitReference(const R
 template <typename T>
 std::pair<NodeSpec<T>, NodeSpec<T>> SplitBVHBuilder<T>::performSpatialSplit(const NodeSpec<T>& spec,
                                                                             const SpatialSplit<T>& split) {
-  std::deque<Reference<T>>& refs = t_reference_stack_;
+  std::vector<Reference<T>>& refs = t_reference_stack_;
   const size_t left_begin = refs.size() - spec.num_refs;
   size_t left_end = left_begin;
   size_t right_begin = refs.size();
@@ -0,0 +1,649 @@
+/**
+ * Project LogiSceneGraph source code
+ * Copyright (C) 2019 Primoz Lavric
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LSG_ACCELERATORS_DYNAMIC_AABB_TREE_H
+#define LSG_ACCELERATORS_DYNAMIC_AABB_TREE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "lsg/core/Exceptions.h"
+#include "lsg/math/AABB.h"
+#include "lsg/math/Frustum.h"
+#include "lsg/math/Ray.h"
+
+namespace lsg {
+
+/**
+ * @brief Incrementally updated bounding volume hierarchy over dynamic entries. Leaves store fattened bounds, so entries
+ *        that move by less than the margin do not change the tree. Insertion picks the sibling by the surface area
+ *        cost and the tree is kept balanced with rotations, which keeps insert, remove and move O(log n).
+ *
+ * @tparam  T     Bounding box component type.
+ * @tparam  Data  Type of the data attached to the entries.
+ */
+template <typename T, typename Data>
+class DynamicAABBTree {
+ public:
+  using NodeId = uint32_t;
+
+  static constexpr NodeId k_null_node = std::numeric_limits<NodeId>::max();
+
+  /**
+   * @brief Initialize empty tree.
+   *
+   * @param	margin  Distance by which the leaf bounds are fattened in every direction.
+   */
+  explicit DynamicAABBTree(T margin = T(0.1));
+
+  /**
+   * @brief   Insert an entry.
+   *
+   * @param	  bounds  Bounds of the entry.
+   * @param	  data    Data attached to the entry.
+   * @return	Id of the entry.
+   */
+  NodeId insert(const AABB<T>& bounds, const Data& data);
+
+  /**
+   * @brief Remove the entry.
+   *
+   * @param	id  Id of the entry.
+   */
+  void remove(NodeId id);
+
+  /**
+   * @brief   Update bounds of the entry. Entry is reinserted only if the new bounds escape the fattened bounds.
+   *
+   * @param	  id      Id of the entry.
+   * @param	  bounds  New bounds.
+   * @return	True if the entry was reinserted.
+   */
+  bool move(NodeId id, const AABB<T>& bounds);
+
+  /**
+   * @brief   Retrieve exact bounds of the entry.
+   *
+   * @param	  id  Id of the entry.
+   * @return	Bounds.
+   */
+  const AABB<T>& bounds(NodeId id) const;
+
+  /**
+   * @brief   Retrieve fattened bounds of the entry.
+   *
+   * @param	  id  Id of the entry.
+   * @return	Fattened bounds.
+   */
+  const AABB<T>& fatBounds(NodeId id) const;
+
+  const Data& data(NodeId id) const;
+
+  /**
+   * @brief   Retrieve number of entries.
+   *
+   * @return	Number of entries.
+   */
+  size_t size() const;
+
+  bool empty() const;
+
+  /**
+   * @brief   Retrieve height of the tree. Empty tree and tree with a single entry have height 0.
+   *
+   * @return	Tree height.
+   */
+  size_t height() const;
+
+  /**
+   * @brief Remove all entries.
+   */
+  void clear();
+
+  /**
+   * @brief Report entries whose bounds overlap the box. Callback is invoked as fn(NodeId, const Data&). If it returns
+   *        bool, returning false stops the query.
+   *
+   * @param	box Query box.
+   * @param	fn  Callback.
+   */
+  template <typename Fn>
+  void queryBox(const AABB<T>& box, const Fn& fn) const;
+
+  /**
+   * @brief Report entries whose bounds are hit by the ray within the given distance. Callback is invoked as
+   *        fn(NodeId, const Data&, T distance) where the distance is the ray entry distance into the bounds. If it
+   *        returns bool, returning false stops the query. Entries are not reported in distance order.
+   *
+   * @param	ray           Query ray.
+   * @param	max_distance  Maximal distance along the ray.
+   * @param	fn            Callback.
+   */
+  template <typename Fn>
+  void queryRay(const Ray<T>& ray, T max_distance, const Fn& fn) const;
+
+  /**
+   * @brief Report entries whose bounds intersect the frustum. Subtrees that are fully inside the frustum are reported
+   *        without further plane tests. Callback is invoked as fn(NodeId, const Data&). If it returns bool, returning
+   *        false stops the query.
+   *
+   * @param	frustum Query frustum.
+   * @param	fn      Callback.
+   */
+  template <typename Fn>
+  void queryFrustum(const Frustum<T>& frustum, const Fn& fn) const;
+
+ private:
+  struct Node {
+    bool isLeaf() const {
+      return children[0] == k_null_node;
+    }
+
+    /**
+     * Fattened bounds for leaves and union of the children bounds for internal nodes.
+     */
+    AABB<T> fat_bounds;
+
+    /**
+     * Exact bounds of the entry.
+     */
+    AABB<T> bounds;
+
+    Data data;
+
+    /**
+     * Parent node or the next free node if the node is not in use.
+     */
+    NodeId parent;
+
+    NodeId children[2];
+
+    /**
+     * Height of the node, 0 for leaves and -1 for free nodes.
+     */
+    int32_t height;
+  };
+
+  /**
+   * @brief Restores the traversal stack to the size it had before the query, also if the callback throws.
+   */
+  struct StackGuard {
+    ~StackGuard() {
+      stack.resize(base);
+    }
+
+    std::vector<NodeId>& stack;
+
+    size_t base;
+  };
+
+  template <typename Fn, typename... Args>
+  static bool report(const Fn& fn, Args&&... args);
+
+  /**
+   * @brief   Retrieve thread local traversal stack of the queries. Queries only use the entries above the size the
+   *          stack had when they started, so concurrent queries and queries nested in callbacks do not interfere.
+   *
+   * @return	Traversal stack.
+   */
+  static std::vector<NodeId>& traversalStack();
+
+  static bool overlaps(const AABB<T>& lhs, const AABB<T>& rhs);
+
+  static AABB<T> merge(const AABB<T>& lhs, const AABB<T>& rhs);
+
+  NodeId allocateNode();
+
+  void freeNode(NodeId id);
+
+  void insertLeaf(NodeId leaf);
+
+  void removeLeaf(NodeId leaf);
+
+  /**
+   * @brief   Rotate the subtree if it is imbalanced.
+   *
+   * @param	  id  Root of the subtree.
+   * @return	New root of the subtree.
+   */
+  NodeId balance(NodeId id);
+
+  /**
+   * @brief Walk from the node to the root and refit bounds and heights.
+   */
+  void refit(NodeId id);
+
+  void checkEntry(NodeId id) const;
+
+  std::vector<Node> nodes_;
+
+  NodeId root_;
+
+  NodeId free_list_;
+
+  size_t size_;
+
+  T margin_;
+};
+
+template <typename T, typename Data>
+DynamicAABBTree<T, Data>::DynamicAABBTree(const T margin)
+  : root_(k_null_node), free_list_(k_null_node), size_(0u), margin_(margin) {}
+
+template <typename T, typename Data>
+typename DynamicAABBTree<T, Data>::NodeId DynamicAABBTree<T, Data>::insert(const AABB<T>& bounds, const Data& data) {
+  const NodeId id = allocateNode();
+  Node& node = nodes_[id];
+  node.bounds = bounds;
+  node.fat_bounds = AABB<T>(bounds.min() - glm::tvec3<T>(margin_), bounds.max() + glm::tvec3<T>(margin_));
+  node.data = data;
+  node.height = 0;
+
+  insertLeaf(id);
+  size_++;
+
+  return id;
+}
+
+template <typename T, typename Data>
+void DynamicAABBTree<T, Data>::remove(const NodeId id) {
+  checkEntry(id);
+  removeLeaf(id);
+  freeNode(id);
+  size_--;
+}
+
+template <typename T, typename Data>
+bool DynamicAABBTree<T, Data>::move(const NodeId id, const AABB<T>& bounds) {
+  checkEntry(id);
+  Node& node = nodes_[id];
+  node.bounds = bounds;
+
+  const AABB<T>& fat = node.fat_bounds;
+  if (fat.min().x <= bounds.min().x && fat.min().y <= bounds.min().y && fat.min().z <= bounds.min().z &&
+      bounds.max().x <= fat.max().x && bounds.max().y <= fat.max().y && bounds.max().z <= fat.max().z) {
+    return false;
+  }
+
+  removeLeaf(id);
+  nodes_[id].fat_bounds = AABB<T>(bounds.min() - glm::tvec3<T>(margin_), bounds.max() + glm::tvec3<T>(margin_));
+  insertLeaf(id);
+
+  return true;
+}
+
+template <typename T, typename Data>
+const AABB<T>& DynamicAABBTree<T, Data>::bounds(const NodeId id) const {
+  checkEntry(id);
+  return nodes_[id].bounds;
+}
+
+template <typename T, typename Data>
+const AABB<T>& DynamicAABBTree<T, Data>::fatBounds(const NodeId id) const {
+  checkEntry(id);
+  return nodes_[id].fat_bounds;
+}
+
+template <typename T, typename Data>
+const Data& DynamicAABBTree<T, Data>::data(const NodeId id) const {
+  checkEntry(id);
+  return nodes_[id].data;
+}
+
+template <typename T, typename Data>
+size_t DynamicAABBTree<T, Data>::size() const {
+  return size_;
+}
+
+template <typename T, typename Data>
+bool DynamicAABBTree<T, Data>::empty() const {
+  return size_ == 0u;
+}
+
+template <typename T, typename Data>
+size_t DynamicAABBTree<T, Data>::height() const {
+  return (root_ != k_null_node) ? static_cast<size_t>(nodes_[root_].height) : 0u;
+}
+
+template <typename T, typename Data>
+void DynamicAABBTree<T, Data>::clear() {
+  nodes_.clear();
+  root_ = k_null_node;
+  free_list_ = k_null_node;
+  size_ = 0u;
+}
+
+template <typename T, typename Data>
+template <typename Fn>
+void DynamicAABBTree<T, Data>::queryBox(const AABB<T>& box, const Fn& fn) const {
+  if (root_ == k_null_node) {
+    return;
+  }
+
+  std::vector<NodeId>& stack = traversalStack();
+  const StackGuard guard {stack, stack.size()};
+  stack.emplace_back(root_);
+  while (stack.size() > guard.base) {
+    const Node& node = nodes_[stack.back()];
+    const NodeId id = stack.back();
+    stack.pop_back();
+
+    if (!overlaps(node.isLeaf() ? node.bounds : node.fat_bounds, box)) {
+      continue;
+    }
+
+    if (node.isLeaf()) {
+      if (!report(fn, id, node.data)) {
+        return;
+      }
+    } else {
+      stack.emplace_back(node.children[1]);
+      stack.emplace_back(node.children[0]);
+    }
+  }
+}
+
+template <typename T, typename Data>
+template <typename Fn>
+void DynamicAABBTree<T, Data>::queryRay(const Ray<T>& ray, const T max_distance, const Fn& fn) const {
+  if (root_ == k_null_node) {
+    return;
+  }
+
+  std::vector<NodeId>& stack = traversalStack();
+  const StackGuard guard {stack, stack.size()};
+  stack.emplace_back(root_);
+  while (stack.size() > guard.base) {
+    const Node& node = nodes_[stack.back()];
+    const NodeId id = stack.back();
+    stack.pop_back();
+
+    const std::optional<T> distance = ray.intersectAABBDistance(node.isLeaf() ? node.bounds : node.fat_bounds);
+    if (!distance || *distance > max_distance) {
+      continue;
+    }
+
+    if (node.isLeaf()) {
+      if (!report(fn, id, node.data, *distance)) {
+        return;
+      }
+    } else {
+      stack.emplace_back(node.children[1]);
+      stack.emplace_back(node.children[0]);
+    }
+  }
+}
+
+template <typename T, typename Data>
+template <typename Fn>
+void DynamicAABBTree<T, Data>::queryFrustum(const Frustum<T>& frustum, const Fn& fn) const {
+  if (root_ == k_null_node) {
+    return;
+  }
+
+  // Nodes fully inside the frustum are marked by the highest bit.
+  constexpr NodeId k_inside_bit = NodeId(1u) << (sizeof(NodeId) * 8u - 1u);
+
+  std::vector<NodeId>& stack = traversalStack();
+  const StackGuard guard {stack, stack.size()};
+  stack.emplace_back(root_);
+  while (stack.size() > guard.base) {
+    const bool inside = (stack.back() & k_inside_bit) != 0u;
+    const NodeId id = stack.back() & ~k_inside_bit;
+    const Node& node = nodes_[id];
+    stack.pop_back();
+
+    Containment containment = Containment::kInside;
+    if (!inside) {
+      containment = frustum.classifyAABB(node.isLeaf() ? node.bounds : node.fat_bounds);
+      if (containment == Containment::kOutside) {
+        continue;
+      }
+    }
+
+    if (node.isLeaf()) {
+      if (!report(fn, id, node.data)) {
+        return;
+      }
+    } else {
+      const NodeId flag = (containment == Containment::kInside) ? k_inside_bit : 0u;
+      stack.emplace_back(node.children[1] | flag);
+      stack.emplace_back(node.children[0] | flag);
+    }
+  }
+}
+
+template <typename T, typename Data>
+template <typename Fn, typename... Args>
+bool DynamicAABBTree<T, Data>::report(const Fn& fn, Args&&... args) {
+  if constexpr (std::is_same_v<std::invoke_result_t<const Fn&, Args...>, bool>) {
+    return fn(std::forward<Args>(args)...);
+  } else {
+    fn(std::forward<Args>(args)...);
+    return true;
+  }
+}
+
+template <typename T, typename Data>
+std::vector<typename DynamicAABBTree<T, Data>::NodeId>& DynamicAABBTree<T, Data>::traversalStack() {
+  thread_local std::vector<NodeId> stack;
+  return stack;
+}
+
+template <typename T, typename Data>
+bool DynamicAABBTree<T, Data>::overlaps(const AABB<T>& lhs, const AABB<T>& rhs) {
+  return lhs.min().x <= rhs.max().x && rhs.min().x <= lhs.max().x && lhs.min().y <= rhs.max().y &&
+         rhs.min().y <= lhs.max().y && lhs.min().z <= rhs.max().z && rhs.min().z <= lhs.max().z;
+}
+
+template <typename T, typename Data>
+AABB<T> DynamicAABBTree<T, Data>::merge(const AABB<T>& lhs, const AABB<T>& rhs) {
+  AABB<T> merged = lhs;
+  merged.expand(rhs);
+  return merged;
+}
+
+template <typename T, typename Data>
+typename DynamicAABBTree<T, Data>::NodeId DynamicAABBTree<T, Data>::allocateNode() {
+  NodeId id;
+  if (free_list_ != k_null_node) {
+    id = free_list_;
+    free_list_ = nodes_[id].parent;
+  } else {
+    throwIf<OutOfRange>(nodes_.size() >= (size_t(1u) << (sizeof(NodeId) * 8u - 1u)), "Dynamic AABB tree is full.");
+    id = static_cast<NodeId>(nodes_.size());
+    nodes_.emplace_back();
+  }
+
+  Node& node = nodes_[id];
+  node.parent = k_null_node;
+  node.children[0] = k_null_node;
+  node.children[1] = k_null_node;
+  node.height = 0;
+
+  return id;
+}
+
+template <typename T, typename Data>
+void DynamicAABBTree<T, Data>::freeNode(const NodeId id) {
+  Node& node = nodes_[id];
+  node.data = Data();
+  node.height = -1;
+  node.parent = free_list_;
+  free_list_ = id;
+}
+
+template <typename T, typename Data>
+void DynamicAABBTree<T, Data>::insertLeaf(const NodeId leaf) {
+  if (root_ == k_null_node) {
+    root_ = leaf;
+    nodes_[leaf].parent = k_null_node;
+    return;
+  }
+
+  // Descend towards the sibling with the lowest cost of the new parent plus the enlargement of the ancestors.
+  const AABB<T> leaf_bounds = nodes_[leaf].fat_bounds;
+  NodeId sibling = root_;
+
+  while (!nodes_[sibling].isLeaf()) {
+    const Node& node = nodes_[sibling];
+    const T area = node.fat_bounds.area();
+    const T combined_area = merge(node.fat_bounds, leaf_bounds).area();
+
+    // Cost of creating a new parent for this node and the leaf.
+    const T cost = T(2) * combined_area;
+
+    // Minimum cost of pushing the leaf further down.
+    const T inheritance_cost = T(2) * (combined_area - area);
+
+    T child_costs[2];
+    for (size_t i = 0u; i < 2u; i++) {
+      const Node& child = nodes_[node.children[i]];
+      const T merged_area = merge(child.fat_bounds, leaf_bounds).area();
+      child_costs[i] = (child.isLeaf() ? merged_area : merged_area - child.fat_bounds.area()) + inheritance_cost;
+    }
+
+    if (cost < child_costs[0] && cost < child_costs[1]) {
+      break;
+    }
+
+    sibling = (child_costs[0] < child_costs[1]) ? node.children[0] : node.children[1];
+  }
+
+  const NodeId old_parent = nodes_[sibling].parent;
+  const NodeId new_parent = allocateNode();
+  Node& parent_node = nodes_[new_parent];
+  parent_node.parent = old_parent;
+  parent_node.fat_bounds = merge(leaf_bounds, nodes_[sibling].fat_bounds);
+  parent_node.height = nodes_[sibling].height + 1;
+  parent_node.children[0] = sibling;
+  parent_node.children[1] = leaf;
+  nodes_[sibling].parent = new_parent;
+  nodes_[leaf].parent = new_parent;
+
+  if (old_parent != k_null_node) {
+    Node& old_parent_node = nodes_[old_parent];
+    old_parent_node.children[(old_parent_node.children[0] == sibling) ? 0u : 1u] = new_parent;
+  } else {
+    root_ = new_parent;
+  }
+
+  refit(old_parent);
+}
+
+template <typename T, typename Data>
+void DynamicAABBTree<T, Data>::removeLeaf(const NodeId leaf) {
+  if (leaf == root_) {
+    root_ = k_null_node;
+    return;
+  }
+
+  const NodeId parent = nodes_[leaf].parent;
+  const NodeId grand_parent = nodes_[parent].parent;
+  const NodeId sibling = (nodes_[parent].children[0] == leaf) ? nodes_[parent].children[1] : nodes_[parent].children[0];
+
+  // Sibling takes the place of the parent.
+  nodes_[sibling].parent = grand_parent;
+  if (grand_parent != k_null_node) {
+    Node& grand_parent_node = nodes_[grand_parent];
+    grand_parent_node.children[(grand_parent_node.children[0] == parent) ? 0u : 1u] = sibling;
+  } else {
+    root_ = sibling;
+  }
+
+  freeNode(parent);
+  nodes_[leaf].parent = k_null_node;
+  refit(grand_parent);
+}
+
+template <typename T, typename Data>
+void DynamicAABBTree<T, Data>::refit(NodeId id) {
+  while (id != k_null_node) {
+    id = balance(id);
+
+    Node& node = nodes_[id];
+    const Node& left = nodes_[node.children[0]];
+    const Node& right = nodes_[node.children[1]];
+    node.fat_bounds = merge(left.fat_bounds, right.fat_bounds);
+    node.height = 1 + std::max(left.height, right.height);
+
+    id = node.parent;
+  }
+}
+
+template <typename T, typename Data>
+typename DynamicAABBTree<T, Data>::NodeId DynamicAABBTree<T, Data>::balance(const NodeId id) {
+  Node& node = nodes_[id];
+  if (node.isLeaf() || node.height < 2) {
+    return id;
+  }
+
+  const int32_t difference = nodes_[node.children[1]].height - nodes_[node.children[0]].height;
+  if (difference >= -1 && difference <= 1) {
+    return id;
+  }
+
+  // Promote the higher child. Its higher grandchild stays under the promoted child and the lower one takes its place.
+  const size_t high_index = (difference > 0) ? 1u : 0u;
+  const NodeId high = node.children[high_index];
+  const NodeId low = node.children[1u - high_index];
+  Node& high_node = nodes_[high];
+  const NodeId grandchild_a = high_node.children[0];
+  const NodeId grandchild_b = high_node.children[1];
+
+  // Promoted child takes the place of the node.
+  high_node.children[0] = id;
+  high_node.parent = node.parent;
+  node.parent = high;
+
+  if (high_node.parent != k_null_node) {
+    Node& parent_node = nodes_[high_node.parent];
+    parent_node.children[(parent_node.children[0] == id) ? 0u : 1u] = high;
+  } else {
+    root_ = high;
+  }
+
+  const bool a_higher = nodes_[grandchild_a].height > nodes_[grandchild_b].height;
+  const NodeId kept = a_higher ? grandchild_a : grandchild_b;
+  const NodeId moved = a_higher ? grandchild_b : grandchild_a;
+
+  high_node.children[1] = kept;
+  node.children[high_index] = moved;
+  node.children[1u - high_index] = low;
+  nodes_[moved].parent = id;
+
+  node.fat_bounds = merge(nodes_[node.children[0]].fat_bounds, nodes_[node.children[1]].fat_bounds);
+  node.height = 1 + std::max(nodes_[node.children[0]].height, nodes_[node.children[1]].height);
+  high_node.fat_bounds = merge(node.fat_bounds, nodes_[kept].fat_bounds);
+  high_node.height = 1 + std::max(node.height, nodes_[kept].height);
+
+  return high;
+}
+
+template <typename T, typename Data>
+void DynamicAABBTree<T, Data>::checkEntry(const NodeId id) const {
+  throwIf<OutOfRange>(id >= nodes_.size() || nodes_[id].height != 0, "Invalid dynamic AABB tree entry.");
+}
+
+} // namespace lsg
+
+#endif // LSG_ACCELERATORS_DYNAMIC_AABB_TREE_H
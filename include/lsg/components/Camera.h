@@ -27,6 +27,8 @@ namespace lsg {
 
 class Camera : public Component {
 public:
+	using ComponentBases = ComponentBaseList<Camera>;
+
 	using Component::Component;
 
 	virtual const glm::mat4x4& projectionMatrix() = 0;
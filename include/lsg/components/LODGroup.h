@@ -0,0 +1,209 @@
+/**
+ * Project LogiSceneGraph source code
+ * Copyright (C) 2019 Primoz Lavric
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LSG_COMPONENTS_LOD_GROUP_H
+#define LSG_COMPONENTS_LOD_GROUP_H
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <glm/glm.hpp>
+#include "lsg/core/Component.h"
+#include "lsg/core/VersionTracker.h"
+#include "lsg/math/AABB.h"
+#include "lsg/resources/SubMesh.h"
+
+namespace lsg {
+
+/**
+ * @brief Single level of detail.
+ */
+struct LODLevel {
+  std::vector<Ref<SubMesh>> sub_meshes;
+
+  /**
+   * World space deviation of the level from the full detail surface.
+   */
+  float geometric_error = 0.0f;
+};
+
+class LODGroup;
+
+class LODSelection;
+
+/**
+ * @brief Camera parameters used to project the geometric error of the levels to the screen.
+ */
+struct LODView {
+  glm::vec3 position = glm::vec3(0.0f);
+
+  /**
+   * Projected size of a unit length at unit distance as a fraction of the viewport height (half of the projection
+   * matrix y scale).
+   */
+  float scale = 0.5f;
+
+  /**
+   * False for orthographic projections, where the projected size does not depend on the distance.
+   */
+  bool perspective = true;
+
+  /**
+   * Levels selected for this view by the previous culling pass. Culling starts the selection from these levels and
+   * stores the new selection. If null, every selection starts from the finest level.
+   */
+  LODSelection* selection = nullptr;
+
+  /**
+   * @brief   Create view from the projection matrix and the world matrix of the camera.
+   *
+   * @param	  projection    Projection matrix.
+   * @param	  camera_world  World matrix of the camera.
+   * @return	View.
+   */
+  static LODView fromCamera(const glm::mat4& projection, const glm::mat4& camera_world);
+};
+
+/**
+ * @brief Holds sub-meshes of an object at several levels of detail. Levels are ordered from the finest to the
+ *        coarsest. The selection picks the coarsest level whose geometric error, projected to the screen at the
+ *        distance of the object bounds, does not exceed the maximum screen error. Switching to a coarser level
+ *        additionally requires the error to fall below the hysteresis margin, so that objects near the threshold do
+ *        not alternate between levels every frame. Group does not store the selection, so it may be shared by any
+ *        number of views (see LODSelection).
+ */
+class LODGroup final : public Component, public VersionTracker {
+ public:
+  explicit LODGroup(Object& owner, std::vector<LODLevel> levels = {});
+
+  LODGroup(Object& owner, const std::string& name, std::vector<LODLevel> levels = {});
+
+  /**
+   * @brief Append a level that is coarser than the existing ones.
+   *
+   * @param	sub_meshes      Sub-meshes of the level.
+   * @param	geometric_error World space error of the level. Must not be smaller than the error of the previous level.
+   */
+  void addLevel(std::vector<Ref<SubMesh>> sub_meshes, float geometric_error);
+
+  size_t levelCount() const;
+
+  const LODLevel& level(size_t index) const;
+
+  const std::vector<LODLevel>& levels() const;
+
+  /**
+   * @brief Set maximum projected error as a fraction of the viewport height.
+   *
+   * @param	error Maximum screen error.
+   */
+  void setMaxScreenError(float error);
+
+  float maxScreenError() const;
+
+  /**
+   * @brief Set fraction by which the projected error of a coarser level must be below the maximum screen error before
+   *        the selection switches to it.
+   *
+   * @param	hysteresis  Hysteresis in range [0, 1).
+   */
+  void setHysteresis(float hysteresis);
+
+  float hysteresis() const;
+
+  /**
+   * @brief   Select the level for the view starting from the level previously selected for the same view.
+   *
+   * @param	  world_bounds    World space bounds of the object.
+   * @param	  view            View parameters.
+   * @param	  previous_level  Level selected for the view in the previous frame.
+   * @return	Selected level index.
+   */
+  size_t select(const AABB<float>& world_bounds, const LODView& view, size_t previous_level = 0u) const;
+
+  /**
+   * @brief   Project the geometric error to the screen at the distance between the view and the nearest point of the
+   *          bounds.
+   *
+   * @param	  geometric_error World space error.
+   * @param	  world_bounds    World space bounds.
+   * @param	  view            View parameters.
+   * @return	Error as a fraction of the viewport height.
+   */
+  static float screenError(float geometric_error, const AABB<float>& world_bounds, const LODView& view);
+
+  /**
+   * @brief   Compute union of the bounds of the sub-mesh geometries of all levels, so that the bounds do not change
+   *          with the selection.
+   *
+   * @return	Bounds in object space, invalid if no level has geometry.
+   */
+  AABB<float> localBounds() const override;
+
+  ~LODGroup() override;
+
+ protected:
+  /**
+   * @brief Marks the owner subtree as changed when a sub-mesh, its geometry or its material changes.
+   */
+  void onDependencyChanged(const VersionTracker& dependency) override;
+
+ private:
+  std::vector<LODLevel> levels_;
+
+  float max_screen_error_;
+
+  float hysteresis_;
+};
+
+/**
+ * @brief Levels selected for a single view. Selection is owned by the caller and kept across frames, so that every
+ *        view has its own hysteresis state.
+ */
+class LODSelection {
+ public:
+  /**
+   * @brief   Retrieve level selected for the LOD group.
+   *
+   * @param	  lod_group LOD group.
+   * @return	Selected level or 0 if the group was not selected yet.
+   */
+  size_t level(const LODGroup& lod_group) const;
+
+  /**
+   * @brief Store level selected for the LOD group.
+   *
+   * @param	lod_group LOD group.
+   * @param	level     Selected level.
+   */
+  void setLevel(const LODGroup& lod_group, size_t level);
+
+  size_t size() const;
+
+  void clear();
+
+ private:
+  /**
+   * Selected level keyed by the id of the LOD group.
+   */
+  std::unordered_map<size_t, size_t> levels_;
+};
+
+} // namespace lsg
+
+#endif // LSG_COMPONENTS_LOD_GROUP_H
@@ -19,13 +19,29 @@
 #ifndef LSG_COMPONENTS_MESH_H
 #define LSG_COMPONENTS_MESH_H
 
+#include <mutex>
+#include <utility>
 #include "lsg/core/Component.h"
 #include "lsg/core/VersionTracker.h"
 #include "lsg/resources/SubMesh.h"
 
 namespace lsg {
 
-class Mesh : public Component, public VersionTracker {
+/**
+ * @brief Tells whether the mesh may be used as an occluder by the occlusion culling.
+ */
+enum class OccluderHint : uint8_t {
+  /**
+   * Mesh is used as an occluder if it covers a large part of the screen.
+   */
+  kAuto,
+
+  kAlways,
+
+  kNever
+};
+
+class Mesh final : public Component, public VersionTracker {
  public:
   explicit Mesh(Object& owner, std::vector<Ref<SubMesh>> sub_meshes = {});
 
@@ -35,10 +51,110 @@ class Mesh : public Component, public VersionTracker {
 
   void addSubMesh(const Ref<SubMesh>& sub_mesh);
 
-  const std::vector<Ref<SubMesh>>& subMeshes();
+  const std::vector<Ref<SubMesh>>& subMeshes() const;
+
+  /**
+   * @brief Set whether the mesh may be used as an occluder. Occluders should be large, closed and opaque, since
+   *        everything behind them is culled.
+   *
+   * @param	hint  Occluder hint.
+   */
+  void setOccluderHint(OccluderHint hint);
+
+  OccluderHint occluderHint() const;
+
+  /**
+   * @brief   Retrieve BVH over triangles of all sub-meshes. Primitive indices encode the sub-mesh index in the upper
+   *          k_sub_mesh_index_bits bits and the triangle index in the remaining bits (see subMeshIndex and
+   *          triangleIndex). BVH is built on the first request and cached until the mesh, sub-mesh geometries or
+   *          the requested configuration change. Concurrent requests build the BVH only once.
+   *
+   * @param	  config        BVH builder configuration.
+   * @param	  sah_function  SAH function used by the builder.
+   * @return	Cached BVH.
+   */
+  Ref<BVH<float>> bvh(const bvh::BVHConfig& config = bvh::BVHConfig(),
+                      const bvh::SAHFunction& sah_function = bvh::SAHFunction()) const;
+
+  /**
+   * @brief   Encode sub-mesh and triangle index into a primitive index of the mesh BVH.
+   *
+   * @param	  sub_mesh_index  Sub-mesh index.
+   * @param	  triangle_index  Triangle index within the sub-mesh geometry.
+   * @return	Encoded primitive index.
+   */
+  static uint32_t encodePrimitiveIndex(size_t sub_mesh_index, size_t triangle_index);
+
+  /**
+   * @brief   Retrieve sub-mesh index from the primitive index of the mesh BVH.
+   *
+   * @param	  prim_index  Encoded primitive index.
+   * @return	Sub-mesh index.
+   */
+  static size_t subMeshIndex(uint32_t prim_index);
+
+  /**
+   * @brief   Retrieve triangle index from the primitive index of the mesh BVH.
+   *
+   * @param	  prim_index  Encoded primitive index.
+   * @return	Triangle index within the sub-mesh geometry.
+   */
+  static size_t triangleIndex(uint32_t prim_index);
+
+  /**
+   * Number of primitive index bits used for the sub-mesh index.
+   */
+  static constexpr uint32_t k_sub_mesh_index_bits = 8u;
+
+  /**
+   * Number of primitive index bits used for the triangle index.
+   */
+  static constexpr uint32_t k_triangle_index_bits = 32u - k_sub_mesh_index_bits;
+
+  /**
+   * @brief   Compute union of the bounds of all sub-mesh geometries.
+   *
+   * @return	Bounds in object space, invalid if the mesh has no geometry.
+   */
+  AABB<float> localBounds() const override;
+
+  ~Mesh() override;
+
+ protected:
+  /**
+   * @brief Marks the owner subtree as changed when a sub-mesh, its geometry or its material changes.
+   */
+  void onDependencyChanged(const VersionTracker& dependency) override;
 
  private:
   std::vector<Ref<SubMesh>> sub_meshes_;
+
+  OccluderHint occluder_hint_;
+
+  /**
+   * Guards the cached BVH and serializes the builds.
+   */
+  mutable std::mutex bvh_mutex_;
+
+  /**
+   * Cached BVH or null if it was not built yet.
+   */
+  mutable Ref<BVH<float>> bvh_;
+
+  /**
+   * Mesh version and the geometries with their versions the BVH was built for.
+   */
+  mutable std::vector<std::pair<Ref<Geometry>, size_t>> bvh_versions_;
+
+  /**
+   * Configuration the BVH was built with.
+   */
+  mutable bvh::BVHConfig bvh_config_;
+
+  /**
+   * SAH function the BVH was built with.
+   */
+  mutable bvh::SAHFunction bvh_sah_function_;
 };
 
 } // namespace lsg
@@ -24,8 +24,10 @@
 
 namespace lsg {
 
-class OrthographicCamera : public Camera {
+class OrthographicCamera final : public Camera {
  public:
+  using ComponentBases = ComponentBaseList<OrthographicCamera, Camera>;
+
   /**
    * @brief	Initializes orthographic camera parameters with the given values.
    *
@@ -24,8 +24,10 @@
 
 namespace lsg {
 
-class PerspectiveCamera : public Camera {
+class PerspectiveCamera final : public Camera {
  public:
+  using ComponentBases = ComponentBaseList<PerspectiveCamera, Camera>;
+
   /**
    * @brief	Initializes perspective camera parameters with the given values.
    *
@@ -19,13 +19,20 @@
 #ifndef LSG_COMPONENTS_TRANSFORM_H
 #define LSG_COMPONENTS_TRANSFORM_H
 
+#include <memory>
 #include <glm/glm.hpp>
 #include <glm/gtc/quaternion.hpp>
+#include "lsg/components/TransformSystem.h"
 #include "lsg/core/Component.h"
 
 namespace lsg {
 
-class Transform : public Component {
+/**
+ * @brief Handle to the transform data stored in the TransformSystem of the hierarchy. World matrix of a transform is
+ *        relative to the nearest ancestor object that has a transform. References returned by the getters are valid
+ *        until a transform of the hierarchy is created or destroyed or the hierarchy changes.
+ */
+class Transform final : public Component {
  public:
   /**
    * @brief Initialize transform based on the owner.
@@ -34,6 +41,10 @@ class Transform : public Component {
    */
   explicit Transform(Object& owner);
 
+  Transform(const Transform& other) = delete;
+
+  Transform& operator=(const Transform& rhs) = delete;
+
   /**
    * @brief   Retrieve local transform matrix.
    *
@@ -42,12 +53,36 @@ class Transform : public Component {
   const glm::mat4x4& matrix();
 
   /**
-   * @brief   Retrieve world transform matrix.
+   * @brief   Retrieve world transform matrix. If any transform of the hierarchy is out of date, all dirty transforms
+   *          of the hierarchy are updated first, so the call must not race with other accesses to the hierarchy.
    *
    * @return	World transform matrix.
    */
   const glm::mat4x4& worldMatrix();
 
+  /**
+   * @brief   Retrieve world transform matrix computed by the last update without updating it. Plain read that is safe
+   *          from any number of threads while the hierarchy is not modified.
+   *
+   * @return	World transform matrix, stale if the transform is dirty.
+   */
+  const glm::mat4x4& worldMatrix() const;
+
+  /**
+   * @brief   Retrieve version of the world matrix. Version changes whenever the world matrix is recomputed. Dirty
+   *          transforms of the hierarchy are updated first.
+   *
+   * @return	World matrix version.
+   */
+  uint64_t worldVersion();
+
+  /**
+   * @brief   Retrieve version of the world matrix computed by the last update without updating it.
+   *
+   * @return	World matrix version, stale if the transform is dirty.
+   */
+  uint64_t worldVersion() const;
+
   /**
    * @brief	  Retrieve object position in object space.
    *
@@ -177,26 +212,48 @@ class Transform : public Component {
   void rotateZ(float angle);
 
   /**
-   * @brief Update object world matrix.
+   * @brief Update object world matrix. Updates all dirty transforms in a single pass.
    */
   void updateWorldMatrix();
 
-  bool isWorldMatrixDirty();
+  /**
+   * @brief   Check if the world matrix has to be recomputed.
+   *
+   * @return	True if the transform or any of its ancestor transforms changed since the last update.
+   */
+  bool isWorldMatrixDirty() const;
+
+  ~Transform() override;
 
  protected:
+  friend class TransformSystem;
+
   void markLocalMatrixDirty();
 
   void markWorldMatrixDirty();
 
+  /**
+   * @brief Moves the transform data to the system of the new hierarchy or marks the parent relations as changed.
+   */
+  void onHierarchyChanged() override;
+
+  /**
+   * @brief   Find transform of the nearest ancestor object that has one.
+   *
+   * @return	Parent transform or nullptr.
+   */
+  Transform* findParentTransform() const;
+
  private:
-  glm::mat4x4 world_matrix_;
-  bool world_matrix_dirty_;
-  glm::mat4x4 loc_matrix_;
-  bool loc_matrix_dirty_;
-
-  glm::vec3 loc_position_;
-  glm::quat loc_rotation_;
-  glm::vec3 loc_scale_;
+  /**
+   * System of the hierarchy that stores the transform data.
+   */
+  std::shared_ptr<TransformSystem> system_;
+
+  /**
+   * Slot of the transform in the system.
+   */
+  uint32_t slot_;
 };
 
 } // namespace lsg
@@ -0,0 +1,272 @@
+/**
+ * Project LogiSceneGraph source code
+ * Copyright (C) 2019 Primoz Lavric
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LSG_COMPONENTS_TRANSFORM_SYSTEM_H
+#define LSG_COMPONENTS_TRANSFORM_SYSTEM_H
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include "lsg/core/ThreadPool.h"
+
+namespace lsg {
+
+class Object;
+
+class Transform;
+
+/**
+ * @brief Owns the data of the Transform components of a single object hierarchy. The system is owned by the hierarchy
+ *        root, so systems of different scenes and detached hierarchies are independent. Local and world transforms
+ *        are stored in contiguous arrays that are sorted by hierarchy depth, so that every parent precedes its
+ *        children. Each entry stores the index of the parent entry (the nearest ancestor object with a transform) and
+ *        dirty bits. World matrices of all dirty entries are updated in a single linear pass. Objects that change
+ *        parent notify their transforms, which either mark the arrays for re-sorting on the next update or move to the
+ *        system of their new hierarchy.
+ */
+class TransformSystem {
+ public:
+  /**
+   * Index used for entries without a parent.
+   */
+  static constexpr uint32_t k_no_parent = std::numeric_limits<uint32_t>::max();
+
+  TransformSystem() = default;
+
+  TransformSystem(const TransformSystem& other) = delete;
+
+  TransformSystem& operator=(const TransformSystem& rhs) = delete;
+
+  /**
+   * @brief   Retrieve transform system of the hierarchy that contains the object. System is created on the first
+   *          request.
+   *
+   * @param	  object  Object.
+   * @return	Transform system owned by the hierarchy root.
+   */
+  static std::shared_ptr<TransformSystem> of(Object& object);
+
+  /**
+   * @brief Re-sorts the arrays if the hierarchy changed and updates all dirty local and world matrices.
+   */
+  void update();
+
+  /**
+   * @brief Same as update, but entries of each depth level are updated in parallel on the given thread pool. Levels
+   *        are processed in order, so parents are always up to date before their children.
+   *
+   * @param	pool        Thread pool.
+   * @param	chunk_size  Number of entries updated by a single task. Smaller levels are updated on the calling thread.
+   */
+  void update(ThreadPool& pool, size_t chunk_size = 1024u);
+
+  /**
+   * @brief   Check if update must be called before the world matrices can be read.
+   *
+   * @return	True if any matrix is out of date or the hierarchy changed.
+   */
+  bool needsUpdate() const;
+
+  /**
+   * @brief   Retrieve number of live transforms.
+   *
+   * @return	Number of transforms.
+   */
+  size_t size() const;
+
+ protected:
+  friend class Transform;
+
+  /**
+   * @brief   Allocate an entry for the given transform.
+   *
+   * @param	  transform Transform component.
+   * @return	Stable slot of the entry.
+   */
+  uint32_t create(Transform& transform);
+
+  /**
+   * @brief Release the entry of the slot.
+   *
+   * @param	slot  Slot of the entry.
+   */
+  void destroy(uint32_t slot);
+
+  /**
+   * @brief   Move an entry from another system into this one.
+   *
+   * @param	  source  System that holds the entry.
+   * @param	  slot    Slot of the entry in the source system.
+   * @return	Slot of the entry in this system.
+   */
+  uint32_t adopt(TransformSystem& source, uint32_t slot);
+
+  /**
+   * @brief Marks the parent relations as out of date, so that the arrays are re-sorted on the next update.
+   */
+  void markStructureDirty();
+
+  /**
+   * @brief   Retrieve index of the entry in the depth sorted arrays.
+   *
+   * @param	  slot  Slot of the entry.
+   * @return	Index in the arrays.
+   */
+  uint32_t index(uint32_t slot) const;
+
+  /**
+   * @brief Marks the local matrix of the slot as out of date (position, rotation or scale changed).
+   */
+  void markLocalDirty(uint32_t slot);
+
+  /**
+   * @brief Marks the world matrix of the slot as out of date (local matrix was set directly).
+   */
+  void markWorldDirty(uint32_t slot);
+
+  /**
+   * @brief   Check if the world matrix of the slot or any of its ancestors is out of date.
+   */
+  bool isWorldDirty(uint32_t slot) const;
+
+  /**
+   * @brief Sorts the entries by depth and resolves the parent indices.
+   */
+  void rebuild();
+
+  /**
+   * @brief   Re-sorts the arrays if needed and starts a new update.
+   *
+   * @return	False if nothing is out of date.
+   */
+  bool beginUpdate();
+
+  /**
+   * @brief Clears the dirty bits after all entries were updated.
+   */
+  void endUpdate();
+
+  /**
+   * @brief Computes local and world matrices of the entries in range [begin, end). Only the entries in the range are
+   *        written, so disjoint ranges of the same depth level may be updated concurrently.
+   */
+  void updateRange(size_t begin, size_t end);
+
+  static bool testBit(const std::vector<uint64_t>& bits, size_t index);
+
+  static void setBit(std::vector<uint64_t>& bits, size_t index);
+
+  static void clearBit(std::vector<uint64_t>& bits, size_t index);
+
+  /**
+   * Positions.
+   */
+  std::vector<glm::vec3> positions_;
+
+  /**
+   * Rotations.
+   */
+  std::vector<glm::quat> rotations_;
+
+  /**
+   * Scales.
+   */
+  std::vector<glm::vec3> scales_;
+
+  /**
+   * Local matrices.
+   */
+  std::vector<glm::mat4> local_matrices_;
+
+  /**
+   * World matrices.
+   */
+  std::vector<glm::mat4> world_matrices_;
+
+  /**
+   * Index of the parent entry or k_no_parent.
+   */
+  std::vector<uint32_t> parents_;
+
+  /**
+   * Value of the update counter when the world matrix was last computed.
+   */
+  std::vector<uint64_t> world_versions_;
+
+  /**
+   * Set bit i if local matrix of entry i must be composed.
+   */
+  std::vector<uint64_t> local_dirty_;
+
+  /**
+   * Set bit i if world matrix of entry i must be computed.
+   */
+  std::vector<uint64_t> world_dirty_;
+
+  /**
+   * Slot of each entry.
+   */
+  std::vector<uint32_t> slots_;
+
+  /**
+   * Index of the first entry of each depth level, followed by the number of entries.
+   */
+  std::vector<uint32_t> depth_offsets_;
+
+  /**
+   * Entry index of each slot.
+   */
+  std::vector<uint32_t> slot_indices_;
+
+  /**
+   * Transform of each slot or null if the slot is free.
+   */
+  std::vector<Transform*> slot_transforms_;
+
+  /**
+   * Released slots.
+   */
+  std::vector<uint32_t> free_slots_;
+
+  /**
+   * Number of live transforms.
+   */
+  size_t size_ = 0u;
+
+  /**
+   * True if any dirty bit is set.
+   */
+  bool dirty_ = false;
+
+  /**
+   * True if transforms were created, destroyed or reparented since the last rebuild.
+   */
+  bool structure_dirty_ = false;
+
+  /**
+   * Incremented on every update that recomputes world matrices.
+   */
+  uint64_t update_counter_ = 0u;
+};
+
+} // namespace lsg
+
+#endif // LSG_COMPONENTS_TRANSFORM_SYSTEM_H
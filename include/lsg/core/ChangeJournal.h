@@ -0,0 +1,211 @@
+/**
+ * Project LogiSceneGraph source code
+ * Copyright (C) 2019 Primoz Lavric
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LSG_CORE_CHANGE_JOURNAL_H
+#define LSG_CORE_CHANGE_JOURNAL_H
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <vector>
+#include "lsg/core/Component.h"
+#include "lsg/core/Ref.h"
+
+namespace lsg {
+
+class Object;
+class VersionTracker;
+
+/**
+ * @brief Type of the recorded change.
+ */
+enum class ChangeType {
+  kChildAdded,
+  kChildRemoved,
+  kComponentAdded,
+  kResourceChanged
+};
+
+/**
+ * @brief Single journal entry.
+ */
+struct Change {
+  ChangeType type;
+
+  /**
+   * Added or removed child or owner of the added component.
+   */
+  Object* object = nullptr;
+
+  /**
+   * Keeps the object alive while the change is recorded. Null if the object is the owner of the journal, so that the
+   * scene does not reference itself.
+   */
+  Ref<Object> object_ref;
+
+  /**
+   * Parent to which the child was added or from which it was removed. Not owned, since the parent may be the scene that
+   * owns the journal. Pointer identifies the parent only, a parent removed from the scene may already be destroyed.
+   */
+  Object* parent = nullptr;
+
+  /**
+   * Added component.
+   */
+  Ref<Component> component;
+
+  /**
+   * Changed resource. Pointer identifies the resource only, the resource may already be destroyed.
+   */
+  const VersionTracker* resource = nullptr;
+
+  /**
+   * Version of the resource after the change.
+   */
+  size_t version = 0u;
+};
+
+/**
+ * @brief Bounded journal of structural scene edits and resource version increments. Consumers keep their own cursor
+ *        and read only the changes recorded since their last read, so synchronisation cost scales with the size of
+ *        the edits. When more than capacity changes accumulate the oldest are dropped and consumers that did not keep
+ *        up are told to resynchronise fully. Journal is disabled until enabled by a consumer.
+ *        Resource increments are broadcast to all enabled journals, since resources do not know the scenes that use
+ *        them, so consumers should ignore resources they do not track.
+ */
+class ChangeJournal {
+ public:
+  using Cursor = uint64_t;
+
+  /**
+   * @brief Result of a read.
+   */
+  struct ReadResult {
+    /**
+     * False if some changes since the cursor were dropped and the consumer must resynchronise fully.
+     */
+    bool complete;
+
+    /**
+     * Number of changes appended to the output.
+     */
+    size_t count;
+  };
+
+  static constexpr size_t k_default_capacity = 65536u;
+
+  /**
+   * @brief Construct journal.
+   *
+   * @param	capacity  Maximal number of recorded changes.
+   * @param	owner     Object that owns the journal. Changes of the owner do not reference it.
+   */
+  explicit ChangeJournal(size_t capacity = k_default_capacity, const Object* owner = nullptr);
+
+  ChangeJournal(const ChangeJournal&) = delete;
+
+  ChangeJournal& operator=(const ChangeJournal&) = delete;
+
+  /**
+   * @brief Enable or disable recording. Disabling clears recorded changes.
+   *
+   * @param	enabled True to record changes.
+   */
+  void setEnabled(bool enabled);
+
+  /**
+   * @brief   Check if the journal records changes.
+   *
+   * @return	True if enabled.
+   */
+  bool isEnabled() const;
+
+  /**
+   * @brief   Retrieve cursor that points past the last recorded change. New consumers start here after a full sync.
+   *
+   * @return	Cursor.
+   */
+  Cursor head() const;
+
+  /**
+   * @brief   Append changes recorded since the cursor to the output and advance the cursor to the head.
+   *
+   * @param   cursor  Consumer cursor.
+   * @param   changes Output changes.
+   * @return	Read result.
+   */
+  ReadResult read(Cursor& cursor, std::vector<Change>& changes) const;
+
+  /**
+   * @brief Record structural change.
+   *
+   * @param	type      Change type.
+   * @param	object    Child or component owner.
+   * @param	parent    Parent for child changes.
+   * @param	component Component for component changes.
+   */
+  void record(ChangeType type, Object* object, Object* parent, Component* component = nullptr);
+
+  /**
+   * @brief Record resource version increment in all enabled journals.
+   *
+   * @param	resource  Changed resource.
+   */
+  static void recordResourceChange(const VersionTracker& resource);
+
+  ~ChangeJournal();
+
+ private:
+  /**
+   * @brief Append the change, moving the change dropped due to the capacity to the given list. Dropped changes may hold
+   *        last references to objects, so they are released by the caller after all locks are released.
+   *
+   * @param	change  Change.
+   * @param	dropped Output dropped changes.
+   */
+  void append(Change&& change, std::vector<Change>& dropped);
+
+  const size_t capacity_;
+
+  const Object* owner_;
+
+  std::atomic<bool> enabled_;
+
+  mutable std::mutex mutex_;
+
+  /**
+   * Recorded changes, front change has sequence number begin_.
+   */
+  std::deque<Change> changes_;
+
+  Cursor begin_;
+
+  /**
+   * Number of enabled journals. Resource increments skip the broadcast while zero.
+   */
+  static std::atomic<size_t> num_enabled_;
+
+  static std::mutex journals_mutex_;
+
+  static std::vector<ChangeJournal*> journals_;
+};
+
+} // namespace lsg
+
+#endif // LSG_CORE_CHANGE_JOURNAL_H
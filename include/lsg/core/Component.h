@@ -19,25 +19,183 @@
 #ifndef LSG_CORE_COMPONENT_H
 #define LSG_CORE_COMPONENT_H
 
+#include <algorithm>
+#include <cstdint>
+#include <limits>
 #include <memory>
 #include <string>
+#include <type_traits>
+#include <vector>
 #include "lsg/core/Identifiable.h"
 #include "lsg/core/Ref.h"
+#include "lsg/math/AABB.h"
 
 namespace lsg {
 
 class Object;
 
+/**
+ * Index of a component type. Indices are assigned at run time on the first use of the type and are dense, so they can
+ * be used to index per type tables.
+ */
+using ComponentTypeId = uint32_t;
+
+/**
+ * @brief Declares the component types from which a component type derives, so that lookups of base types are served
+ *        from the per object type table without RTTI. Component types that are looked up as a base of other types
+ *        declare `using ComponentBases = ComponentBaseList<Self>;` and every type deriving from them declares
+ *        `using ComponentBases = ComponentBaseList<Self, Bases...>;`. Types deriving directly from Component only
+ *        need the declaration if they are not final.
+ *
+ * @tparam  Self  Declaring component type.
+ * @tparam  Bases Component types from which Self directly derives.
+ */
+template <typename Self, typename... Bases>
+struct ComponentBaseList {
+  using Type = Self;
+};
+
 class Component : public Identifiable, public RefCounter<Component> {
  public:
+  using ComponentBases = ComponentBaseList<Component>;
+
+  /**
+   * Type id of components that were not added through Object::addComponent.
+   */
+  static constexpr ComponentTypeId k_invalid_type_id = std::numeric_limits<ComponentTypeId>::max();
+
   explicit Component(const std::string& name, Object& owner);
 
+  /**
+   * @brief   Retrieve type id of the given component type.
+   *
+   * @tparam  T Component type.
+   * @return	Type id.
+   */
+  template <typename T>
+  static ComponentTypeId typeIdOf();
+
+  /**
+   * @brief   Retrieve type id of the given component type followed by the type ids of all its declared bases.
+   *
+   * @tparam  T Component type.
+   * @return	Type ids.
+   */
+  template <typename T>
+  static const std::vector<ComponentTypeId>& typeIdsOf();
+
+  /**
+   * @brief   Check if the component type may be looked up, i.e. if all components matching it carry its type id.
+   *
+   * @tparam  T Component type.
+   * @return	True if T is Component, declares its bases or is a final type deriving directly from Component.
+   */
+  template <typename T>
+  static constexpr bool isLookupType();
+
+  /**
+   * @brief   Retrieve type id of the type with which the component was added to the object.
+   *
+   * @return	Type id.
+   */
+  ComponentTypeId typeId() const;
+
+  /**
+   * @brief   Check if the component was added as the type with the given id or as a type declaring it as a base.
+   *
+   * @param   type_id Type id.
+   * @return	True if the component matches the type.
+   */
+  bool hasTypeId(ComponentTypeId type_id) const;
+
+  /**
+   * @brief   Retrieve bounds that the component contributes to the bounds of its owner.
+   *
+   * @return	Bounds in object space of the owner, invalid if the component has no spatial extent.
+   */
+  virtual AABB<float> localBounds() const;
+
   ~Component() override;
 
  protected:
+  friend class Object;
+
+  /**
+   * @brief Invoked after the owner or one of its ancestors changed parent, if the previous hierarchy root had a
+   *        transform system.
+   */
+  virtual void onHierarchyChanged();
+
+  /**
+   * @brief   Allocate new type id.
+   *
+   * @return	Type id.
+   */
+  static ComponentTypeId nextTypeId();
+
+  /**
+   * @brief Append type ids of the declared bases that are not in the list yet.
+   */
+  template <typename Self, typename... Bases>
+  static void appendBaseTypeIds(std::vector<ComponentTypeId>& type_ids, ComponentBaseList<Self, Bases...>* list);
+
   Object& owner_;
+
+  /**
+   * Type id of the type with which the component was added to the object.
+   */
+  ComponentTypeId type_id_;
+
+  /**
+   * Type ids of the type with which the component was added and of its declared bases or nullptr.
+   */
+  const std::vector<ComponentTypeId>* type_ids_;
 };
 
+template <typename T>
+ComponentTypeId Component::typeIdOf() {
+  static const ComponentTypeId type_id = nextTypeId();
+  return type_id;
+}
+
+template <typename T>
+const std::vector<ComponentTypeId>& Component::typeIdsOf() {
+  static_assert(std::is_same_v<typename T::ComponentBases::Type, T> ||
+                  std::is_same_v<typename T::ComponentBases::Type, Component>,
+                "Component types deriving from other component types must declare their ComponentBases.");
+
+  static const std::vector<ComponentTypeId> type_ids = []() {
+    std::vector<ComponentTypeId> ids {typeIdOf<T>()};
+    if constexpr (std::is_same_v<typename T::ComponentBases::Type, T>) {
+      appendBaseTypeIds(ids, static_cast<typename T::ComponentBases*>(nullptr));
+    }
+    return ids;
+  }();
+  return type_ids;
+}
+
+template <typename T>
+constexpr bool Component::isLookupType() {
+  using Declared = typename T::ComponentBases::Type;
+  return std::is_same_v<T, Component> || std::is_same_v<Declared, T> ||
+         (std::is_final_v<T> && std::is_same_v<Declared, Component>);
+}
+
+template <typename Self, typename... Bases>
+void Component::appendBaseTypeIds(std::vector<ComponentTypeId>& type_ids, ComponentBaseList<Self, Bases...>*) {
+  static_assert((std::is_base_of_v<Bases, Self> && ...), "Declared component bases must be bases of the type.");
+
+  if constexpr (sizeof...(Bases) > 0u) {
+    for (const std::vector<ComponentTypeId>* base_ids : {&typeIdsOf<Bases>()...}) {
+      for (const ComponentTypeId type_id : *base_ids) {
+        if (std::find(type_ids.begin(), type_ids.end(), type_id) == type_ids.end()) {
+          type_ids.emplace_back(type_id);
+        }
+      }
+    }
+  }
+}
+
 } // namespace lsg
 
 #endif // LSG_CORE_COMPONENT_H
\ No newline at end of file
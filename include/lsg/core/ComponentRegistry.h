@@ -0,0 +1,286 @@
+/**
+ * Project LogiSceneGraph source code
+ * Copyright (C) 2019 Primoz Lavric
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LSG_CORE_COMPONENT_REGISTRY_H
+#define LSG_CORE_COMPONENT_REGISTRY_H
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+#include "lsg/core/Component.h"
+#include "lsg/core/ThreadPool.h"
+
+namespace lsg {
+
+class Object;
+
+/**
+ * Index of an object within the component registry.
+ */
+using Entity = uint32_t;
+
+template <typename... Ts>
+class RegistryView;
+
+/**
+ * @brief Stores pointers to the components of all objects in the scene in dense per type pools. Pools are sparse sets,
+ *        so membership test and lookup by entity are constant time and read only, while iteration over a single pool
+ *        is linear over contiguous memory. Components are pooled under the exact type with which they were added to the
+ *        object and only the first component of each type per object is pooled.
+ */
+class ComponentRegistry {
+ public:
+  static constexpr Entity k_invalid_entity = std::numeric_limits<Entity>::max();
+
+  /**
+   * @brief Dense storage of the components of a single type.
+   */
+  struct Pool {
+    static constexpr uint32_t k_invalid_index = std::numeric_limits<uint32_t>::max();
+
+    /**
+     * @brief   Retrieve component of the given entity.
+     *
+     * @param   entity  Entity.
+     * @return	Component or nullptr if the entity has no component in this pool.
+     */
+    Component* find(Entity entity) const {
+      return (entity < sparse.size() && sparse[entity] != k_invalid_index) ? components[sparse[entity]] : nullptr;
+    }
+
+    /**
+     * Entities that own the components.
+     */
+    std::vector<Entity> entities;
+
+    /**
+     * Components densely packed.
+     */
+    std::vector<Component*> components;
+
+    /**
+     * Entity to dense index.
+     */
+    std::vector<uint32_t> sparse;
+  };
+
+  /**
+   * @brief   Create entity for the given object.
+   *
+   * @param   object  Object.
+   * @return	Created entity.
+   */
+  Entity createEntity(Object& object);
+
+  /**
+   * @brief Remove entity and all its components from the registry.
+   *
+   * @param	entity  Entity.
+   */
+  void destroyEntity(Entity entity);
+
+  /**
+   * @brief Add component to the pool of its type. Does nothing if the entity already has a component of that type.
+   *
+   * @param	entity    Entity.
+   * @param	component Component.
+   */
+  void addComponent(Entity entity, Component* component);
+
+  /**
+   * @brief   Retrieve object of the given entity.
+   *
+   * @param   entity  Entity.
+   * @return	Object.
+   */
+  Object& object(Entity entity) const;
+
+  /**
+   * @brief   Retrieve number of live entities.
+   *
+   * @return	Number of entities.
+   */
+  size_t numEntities() const;
+
+  /**
+   * @brief   Retrieve pool of the given type.
+   *
+   * @param   type_id Component type id.
+   * @return	Pool or nullptr if no component of the given type was ever registered.
+   */
+  const Pool* pool(ComponentTypeId type_id) const;
+
+  template <typename T>
+  const Pool* pool() const;
+
+  /**
+   * @brief   Retrieve component of type T of the given entity.
+   *
+   * @tparam  T       Component type.
+   * @param   entity  Entity.
+   * @return	Component or nullptr.
+   */
+  template <typename T>
+  T* component(Entity entity) const;
+
+  /**
+   * @brief   Create view over the entities that have components of all given types.
+   *
+   * @tparam  Ts  Component types.
+   * @return	View.
+   */
+  template <typename... Ts>
+  RegistryView<Ts...> view() const;
+
+ private:
+  /**
+   * Entity to object.
+   */
+  std::vector<Object*> objects_;
+
+  /**
+   * Entities available for reuse.
+   */
+  std::vector<Entity> free_entities_;
+
+  /**
+   * Component pools indexed by component type id.
+   */
+  std::vector<Pool> pools_;
+};
+
+/**
+ * @brief View over the entities that have components of all types Ts. Iteration is driven by the smallest pool and
+ *        the remaining components are looked up through the sparse sets. View is invalidated when the registry changes.
+ */
+template <typename... Ts>
+class RegistryView {
+ public:
+  static_assert(sizeof...(Ts) > 0u, "View requires at least one component type.");
+
+  explicit RegistryView(const ComponentRegistry& registry);
+
+  /**
+   * @brief   Retrieve upper bound of the number of entities in the view.
+   *
+   * @return	Size of the driving pool.
+   */
+  size_t sizeHint() const;
+
+  /**
+   * @brief Invoke fn(Object&, Ts&...) for each entity in the view.
+   *
+   * @param	fn  Function.
+   */
+  template <typename Fn>
+  void forEach(const Fn& fn) const;
+
+  /**
+   * @brief Invoke fn(Object&, Ts&...) for each entity in the view in parallel. Function may be invoked concurrently for
+   *        different entities.
+   *
+   * @param	fn          Function.
+   * @param	executor    Thread pool on which the view is processed.
+   * @param	chunk_size  Number of entities processed by a single task.
+   */
+  template <typename Fn>
+  void parallelForEach(const Fn& fn, ThreadPool& executor = ThreadPool::global(), size_t chunk_size = 256u) const;
+
+ private:
+  template <typename Fn, size_t... Is>
+  void processRange(size_t begin, size_t end, const Fn& fn, std::index_sequence<Is...>) const;
+
+  const ComponentRegistry& registry_;
+
+  std::array<const ComponentRegistry::Pool*, sizeof...(Ts)> pools_;
+
+  const ComponentRegistry::Pool* driver_;
+};
+
+template <typename T>
+const ComponentRegistry::Pool* ComponentRegistry::pool() const {
+  return pool(Component::typeIdOf<T>());
+}
+
+template <typename T>
+T* ComponentRegistry::component(const Entity entity) const {
+  const Pool* type_pool = pool<T>();
+  if (type_pool == nullptr) {
+    return nullptr;
+  }
+
+  return static_cast<T*>(type_pool->find(entity));
+}
+
+template <typename... Ts>
+RegistryView<Ts...> ComponentRegistry::view() const {
+  return RegistryView<Ts...>(*this);
+}
+
+template <typename... Ts>
+RegistryView<Ts...>::RegistryView(const ComponentRegistry& registry)
+  : registry_(registry), pools_({registry.pool<Ts>()...}), driver_(nullptr) {
+  for (const ComponentRegistry::Pool* type_pool : pools_) {
+    if (type_pool == nullptr) {
+      // Some type has no components, view is empty.
+      driver_ = nullptr;
+      return;
+    }
+    if (driver_ == nullptr || type_pool->entities.size() < driver_->entities.size()) {
+      driver_ = type_pool;
+    }
+  }
+}
+
+template <typename... Ts>
+size_t RegistryView<Ts...>::sizeHint() const {
+  return (driver_ != nullptr) ? driver_->entities.size() : 0u;
+}
+
+template <typename... Ts>
+template <typename Fn>
+void RegistryView<Ts...>::forEach(const Fn& fn) const {
+  processRange(0u, sizeHint(), fn, std::index_sequence_for<Ts...>());
+}
+
+template <typename... Ts>
+template <typename Fn>
+void RegistryView<Ts...>::parallelForEach(const Fn& fn, ThreadPool& executor, size_t chunk_size) const {
+  executor.parallelFor(sizeHint(), chunk_size, [&](size_t begin, size_t end, size_t) {
+    processRange(begin, end, fn, std::index_sequence_for<Ts...>());
+  });
+}
+
+template <typename... Ts>
+template <typename Fn, size_t... Is>
+void RegistryView<Ts...>::processRange(size_t begin, size_t end, const Fn& fn, std::index_sequence<Is...>) const {
+  std::array<Component*, sizeof...(Ts)> components {};
+
+  for (size_t i = begin; i < end; i++) {
+    const Entity entity = driver_->entities[i];
+    if ((((components[Is] = pools_[Is]->find(entity)) != nullptr) && ...)) {
+      fn(registry_.object(entity), static_cast<Ts&>(*components[Is])...);
+    }
+  }
+}
+
+} // namespace lsg
+
+#endif // LSG_CORE_COMPONENT_REGISTRY_H
@@ -0,0 +1,136 @@
+/**
+ * Project LogiSceneGraph source code
+ * Copyright (C) 2019 Primoz Lavric
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LSG_CORE_HIERARCHY_INDEX_H
+#define LSG_CORE_HIERARCHY_INDEX_H
+
+#include <cstdint>
+#include <limits>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace lsg {
+
+class Object;
+
+/**
+ * @brief Hash index of the objects in a scene keyed by object name and by full hierarchy path. Path hashes are
+ *        combined from the parent path hash and the object name, so an absolute path is resolved in O(path depth)
+ *        without storing path strings. Candidates are always verified, so hash collisions do not produce false matches.
+ */
+class HierarchyIndex {
+ public:
+  static constexpr uint32_t k_invalid_slot = std::numeric_limits<uint32_t>::max();
+
+  /**
+   * @brief Per object index data.
+   */
+  struct Entry {
+    /**
+     * Hash of the full hierarchy path of the object.
+     */
+    size_t path_hash = 0u;
+
+    /**
+     * Position of the object within its name bucket.
+     */
+    uint32_t name_slot = k_invalid_slot;
+
+    /**
+     * Position of the object within its path bucket.
+     */
+    uint32_t path_slot = k_invalid_slot;
+  };
+
+  /**
+   * @brief Insert the object into the index. Parent of the object must already be indexed.
+   *
+   * @param	object  Object.
+   */
+  void insert(Object& object);
+
+  /**
+   * @brief Remove the object from the index.
+   *
+   * @param	object  Object.
+   */
+  void erase(Object& object);
+
+  /**
+   * @brief   Retrieve objects whose name hash matches the hash of the given name.
+   *
+   * @param   name  Object name.
+   * @return	Candidates or nullptr.
+   */
+  const std::vector<Object*>* nameCandidates(std::string_view name) const;
+
+  /**
+   * @brief   Retrieve objects whose path hash matches the given hash.
+   *
+   * @param   path_hash Path hash.
+   * @return	Candidates or nullptr.
+   */
+  const std::vector<Object*>* pathCandidates(size_t path_hash) const;
+
+  /**
+   * @brief   Retrieve candidates that may match the given hierarchy path. Absolute paths are looked up by path hash and
+   *          relative paths by the name of the last path element.
+   *
+   * @param   hierarchy_path  Hierarchy path.
+   * @return	Candidates or nullptr.
+   */
+  const std::vector<Object*>* candidates(std::string_view hierarchy_path) const;
+
+  /**
+   * @brief   Combine hash of the parent path with the object name.
+   *
+   * @param   parent_hash Hash of the parent path.
+   * @param   name        Object name.
+   * @return	Path hash.
+   */
+  static size_t combinePathHash(size_t parent_hash, std::string_view name);
+
+  /**
+   * @brief   Compute hash of an absolute hierarchy path.
+   *
+   * @param   hierarchy_path  Path starting with '/'.
+   * @return	Path hash.
+   */
+  static size_t hashAbsolutePath(std::string_view hierarchy_path);
+
+ private:
+  static size_t hashName(std::string_view name);
+
+  static void removeFromBucket(std::unordered_map<size_t, std::vector<Object*>>& buckets, size_t key, uint32_t slot,
+                               uint32_t Entry::*slot_member);
+
+  /**
+   * Objects bucketed by name hash.
+   */
+  std::unordered_map<size_t, std::vector<Object*>> names_;
+
+  /**
+   * Objects bucketed by path hash.
+   */
+  std::unordered_map<size_t, std::vector<Object*>> paths_;
+};
+
+} // namespace lsg
+
+#endif // LSG_CORE_HIERARCHY_INDEX_H
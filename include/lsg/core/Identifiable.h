@@ -40,7 +40,7 @@ public:
 
   std::string_view name() const;
 
-  void setName(const std::string& name);
+  virtual void setName(const std::string& name);
 
   virtual ~Identifiable() = default;
 
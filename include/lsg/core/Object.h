@@ -19,19 +19,132 @@
 #ifndef LSG_CORE_OBJECT_H
 #define LSG_CORE_OBJECT_H
 
+#include <atomic>
 #include <functional>
+#include <iterator>
 #include <list>
 #include <map>
 #include <memory>
 #include <string>
 #include <string_view>
+#include <type_traits>
 #include <unordered_map>
 #include "lsg/core/Component.h"
+#include "lsg/core/ComponentRegistry.h"
+#include "lsg/core/HierarchyIndex.h"
 #include "lsg/core/Identifiable.h"
 #include "lsg/core/Ref.h"
+#include "lsg/math/AABB.h"
 
 namespace lsg {
 
+class Transform;
+
+class TransformSystem;
+
+class Scene;
+
+/**
+ * @brief   Check if the component is of type T or of a type that declares T as a component base (see
+ *          ComponentBaseList). Exact type id is compared first, declared bases only for non final types.
+ *
+ * @tparam  T         Component type.
+ * @param   component Component.
+ * @return	True if the component is of type T.
+ */
+template <typename T>
+bool isComponentOfType(const Component* component) {
+  static_assert(Component::isLookupType<T>(), "Non final component types must declare their ComponentBases.");
+
+  if constexpr (std::is_same_v<T, Component>) {
+    return true;
+  } else if (component->typeId() == Component::typeIdOf<T>()) {
+    return true;
+  } else if constexpr (std::is_final_v<T>) {
+    return false;
+  } else {
+    return component->hasTypeId(Component::typeIdOf<T>());
+  }
+}
+
+/**
+ * Allocation free view over the components of type T that are attached to an object. T may be const qualified to
+ * provide read only access.
+ */
+template <typename T>
+class ComponentRange {
+ public:
+  class Iterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = std::remove_const_t<T>;
+    using difference_type = std::ptrdiff_t;
+    using pointer = T*;
+    using reference = T&;
+
+    Iterator(const Ref<Component>* current, const Ref<Component>* end) : current_(current), end_(end) {
+      skip();
+    }
+
+    reference operator*() const {
+      return static_cast<T&>(**current_);
+    }
+
+    pointer operator->() const {
+      return static_cast<T*>(current_->get());
+    }
+
+    Iterator& operator++() {
+      ++current_;
+      skip();
+      return *this;
+    }
+
+    Iterator operator++(int) {
+      Iterator it = *this;
+      ++*this;
+      return it;
+    }
+
+    bool operator==(const Iterator& other) const {
+      return current_ == other.current_;
+    }
+
+    bool operator!=(const Iterator& other) const {
+      return current_ != other.current_;
+    }
+
+   private:
+    void skip() {
+      while (current_ != end_ && !isComponentOfType<std::remove_const_t<T>>(current_->get())) {
+        ++current_;
+      }
+    }
+
+    const Ref<Component>* current_;
+    const Ref<Component>* end_;
+  };
+
+  explicit ComponentRange(const std::vector<Ref<Component>>& components)
+    : begin_(components.data()), end_(components.data() + components.size()) {}
+
+  Iterator begin() const {
+    return Iterator(begin_, end_);
+  }
+
+  Iterator end() const {
+    return Iterator(end_, end_);
+  }
+
+  bool empty() const {
+    return begin() == end();
+  }
+
+ private:
+  const Ref<Component>* begin_;
+  const Ref<Component>* end_;
+};
+
 class Object : public Identifiable, public RefCounter<Object> {
  public:
   explicit Object(std::string name, bool active = true);
@@ -60,6 +173,13 @@ class Object : public Identifiable, public RefCounter<Object> {
    */
   bool isActiveInHierarchy() const;
 
+  /**
+   * @brief Set object name. Objects in a scene update the scene hierarchy index.
+   *
+   * @param	name  New name.
+   */
+  void setName(const std::string& name) override;
+
   /**
    * @brief Add child object to this object.
    *
@@ -84,14 +204,21 @@ class Object : public Identifiable, public RefCounter<Object> {
   Ref<Object> getChild(std::string_view name) const;
 
   /**
-   * @brief   Search for object with the given name.
+   * @brief   Search for object with the given name. Objects in a scene are resolved through the scene hierarchy index,
+   *          absolute paths in O(path depth) and relative paths in time proportional to the number of objects that
+   *          share the last path element name.
    *
-   * @tparam  T     Object type.
-   * @param   name  Name of the searched object.
-   * @return  Shared pointer that points to the searched child or nullptr if not found.
+   * @param   hierarchy_path  Hierarchy path of the searched object. Path starting with '/' is absolute.
+   * @return  Shared pointer that points to the first matching object in traversal order or nullptr if not found.
    */
   Ref<Object> find(std::string_view hierarchy_path) const;
 
+  /**
+   * @brief   Search for all objects matching the given hierarchy path.
+   *
+   * @param   hierarchy_path  Hierarchy path of the searched objects.
+   * @return  Matching objects in traversal order.
+   */
   std::vector<Ref<Object>> findAll(std::string_view hierarchy_path) const;
 
   bool matchesHierarchyPath(std::string_view hierarchy_path) const;
@@ -129,11 +256,17 @@ class Object : public Identifiable, public RefCounter<Object> {
 
   /**
    * @brief Traverse the hierarchy passing this and all ascendant object to the traversal function.
-   *        Traversal can be stopped by returning false in traversal function.
+   *        Traversal can be stopped by returning false in traversal function. Traversal function receives Object& or
+   *        const Object& (depending on the constness of this object) and may return void to never stop. Functions that
+   *        take const Ref<Object>& are supported as well, but pay for a reference count update per visited object.
    *
    * @param	traversal_fn  Traversal function.
    */
-  void traverseUp(const std::function<bool(const Ref<Object>&)>& traversal_fn) const;
+  template <typename Fn>
+  void traverseUp(const Fn& traversal_fn);
+
+  template <typename Fn>
+  void traverseUp(const Fn& traversal_fn) const;
 
   /**
    * @brief Traverse the hierarchy passing all ascendant object to the traversal function.
@@ -141,23 +274,37 @@ class Object : public Identifiable, public RefCounter<Object> {
    *
    * @param	traversal_fn  Traversal function.
    */
-  void traverseUpExcl(const std::function<bool(const Ref<Object>&)>& traversal_fn) const;
+  template <typename Fn>
+  void traverseUpExcl(const Fn& traversal_fn);
+
+  template <typename Fn>
+  void traverseUpExcl(const Fn& traversal_fn) const;
 
   /**
-   * @brief Traverse the hierarchy passing this and all descendant object to the traversal function.
-   *        Traversal can be stopped by returning false in traversal function.
+   * @brief Traverse the hierarchy depth first passing this and all descendant object to the traversal function.
+   *        Returning false from the traversal function skips descendants of the visited object. Traversal uses an
+   *        explicit stack, so hierarchy depth is not limited by the call stack. Hierarchy must not be modified
+   *        during the traversal.
    *
    * @param	traversal_fn  Traversal function.
    */
-  void traverseDown(const std::function<bool(const Ref<Object>&)>& traversal_fn) const;
+  template <typename Fn>
+  void traverseDown(const Fn& traversal_fn);
+
+  template <typename Fn>
+  void traverseDown(const Fn& traversal_fn) const;
 
   /**
-   * @brief Traverse the hierarchy passing all descendant object to the traversal function.
-   *        Traversal can be stopped by returning false in traversal function.
+   * @brief Traverse the hierarchy depth first passing all descendant object to the traversal function.
+   *        Returning false from the traversal function skips descendants of the visited object.
    *
    * @param	traversal_fn  Traversal function.
    */
-  void traverseDownExcl(const std::function<bool(const Ref<Object>&)>& traversal_fn) const;
+  template <typename Fn>
+  void traverseDownExcl(const Fn& traversal_fn);
+
+  template <typename Fn>
+  void traverseDownExcl(const Fn& traversal_fn) const;
 
   /**
    * @brief   Add the component to the object.
@@ -178,14 +325,96 @@ class Object : public Identifiable, public RefCounter<Object> {
   template <typename T>
   Ref<T> getComponent();
 
+  /**
+   * @brief   Retrieve pointer to the first component of the given type T without touching its reference count. Lookup
+   *          is served from the per object type table, which holds components under their type and their declared
+   *          bases. Lookups never modify the object, so they may run concurrently.
+   *
+   * @tparam	T Component type.
+   * @return	Pointer to the first component of type T or nullptr if there is no component of the given type T.
+   */
+  template <typename T>
+  T* findComponent();
+
   /**
    * @brief   Retrieve all components of type T
    *
    * @tparam	T	Components type.
-   * @return	Vector of components of the given type.
+   * @return	Range over the components of the given type. Range is invalidated when a component is added.
+   */
+  template <typename T>
+  ComponentRange<T> getComponents();
+
+  /**
+   * @brief   Retrieve all components of type T for read only access.
+   *
+   * @tparam	T	Components type.
+   * @return	Range over the components of the given type. Range is invalidated when a component is added.
    */
   template <typename T>
-  std::vector<Ref<T>> getComponents();
+  ComponentRange<const T> getComponents() const;
+
+  /**
+   * @brief   Retrieve subtree version. Version is raised along the ancestor chain whenever the object or any of its
+   *          descendants changes its transform, activity, children, components or resources referenced by its meshes.
+   *          Consumers call advanceVersionClock before a pass and skip subtrees whose version is not greater than the
+   *          clock value returned before their previous pass.
+   *
+   * @return	Subtree version.
+   */
+  uint64_t subtreeVersion() const;
+
+  /**
+   * @brief Mark this object and thus the subtrees of all its ancestors as changed. Propagation stops at the first
+   *        ancestor above the object that was already marked since the last advanceVersionClock call.
+   */
+  void markSubtreeChanged();
+
+  /**
+   * @brief   Start a new version epoch. All changes made before the call have subtree versions lower or equal to the
+   *          returned value and all changes made after the call have greater versions.
+   *
+   * @return	Clock value before the call.
+   */
+  static uint64_t advanceVersionClock();
+
+  /**
+   * @brief   Retrieve scene that contains the object.
+   *
+   * @return	Scene or nullptr if the object is not part of a scene.
+   */
+  Scene* scene() const;
+
+  /**
+   * @brief   Find transform of this object or of the nearest ancestor that has one. World matrix of this
+   *          transform is the world matrix of the object.
+   *
+   * @return	Transform or nullptr.
+   */
+  Transform* nearestTransform();
+
+  /**
+   * @brief   Compute union of the local bounds of all components of the object (see Component::localBounds).
+   *
+   * @return	Local bounds in object space, invalid if no component has a spatial extent.
+   */
+  AABB<float> localBounds() const;
+
+  /**
+   * @brief   Retrieve world space bounds of the object meshes. Bounds are cached and recomputed on demand once the
+   *          object, its meshes, their resources or its world matrix change.
+   *
+   * @return	World bounds, invalid if the object has no mesh geometry.
+   */
+  const AABB<float>& worldBounds();
+
+  /**
+   * @brief   Retrieve world space bounds of the object and all its descendants. Stale bounds are recomputed bottom-up,
+   *          while unchanged subtrees reuse their cached bounds, so whole subtrees may be rejected by a single test.
+   *
+   * @return	Subtree bounds, invalid if no object in the subtree has mesh geometry.
+   */
+  const AABB<float>& subtreeBounds();
 
   ~Object() override = default;
 
@@ -203,6 +432,105 @@ class Object : public Identifiable, public RefCounter<Object> {
    */
   void notifyParentChange();
 
+  /**
+   * @brief Move this object and its descendants to the given scene, updating the component registries.
+   *
+   * @param	scene Scene or nullptr.
+   */
+  void setScene(Scene* scene);
+
+  /**
+   * @brief Recompute hierarchy index entries of this object and its descendants.
+   */
+  void reindexSubtree();
+
+  /**
+   * @brief   Collect indexed objects within this subtree that match the given hierarchy path.
+   *
+   * @param   hierarchy_path  Hierarchy path.
+   * @param   matches         Output matches in unspecified order.
+   */
+  void findIndexed(std::string_view hierarchy_path, std::vector<Object*>& matches) const;
+
+  /**
+   * @brief   Collect objects within this subtree that match the given hierarchy path from the index of the given scene
+   *          and of the scenes nested in it.
+   *
+   * @param   scene           Scene whose index is searched.
+   * @param   hierarchy_path  Hierarchy path.
+   * @param   matches         Output matches in unspecified order.
+   */
+  void findIndexed(const Scene& scene, std::string_view hierarchy_path, std::vector<Object*>& matches) const;
+
+  /**
+   * @brief Move nested scene from the nested scene list of one enclosing scene to another.
+   *
+   * @param	nested  Nested scene.
+   * @param	from    Previous enclosing scene or nullptr.
+   * @param	to      New enclosing scene or nullptr.
+   */
+  static void moveNestedScene(Scene& nested, Scene* from, Scene* to);
+
+  /**
+   * @brief   Check if the object is this object or its descendant.
+   *
+   * @param   object  Object.
+   * @return	True if the object is within this subtree.
+   */
+  bool containsInSubtree(const Object* object) const;
+
+  /**
+   * @brief   Check if lhs is visited before rhs in depth first traversal.
+   */
+  static bool precedesInTraversal(const Object* lhs, const Object* rhs);
+
+  /**
+   * @brief   Invoke traversal function on the object.
+   *
+   * @return	Value returned by the traversal function or true if it returns void.
+   */
+  template <typename O, typename Fn>
+  static bool visit(O& object, const Fn& traversal_fn);
+
+  template <typename O, typename Fn>
+  static void traverseUpImpl(O& object, const Fn& traversal_fn, bool inclusive);
+
+  template <typename O, typename Fn>
+  static void traverseDownImpl(O& object, const Fn& traversal_fn, bool inclusive);
+
+  /**
+   * @brief   Retrieve traversal stack of the calling thread. Nested traversals share the stack above their base.
+   */
+  static std::vector<const Object*>& traversalStack();
+
+  /**
+   * @brief   Look up direct child with the given name through the scene hierarchy index.
+   *
+   * @param   name      Child name.
+   * @param   resolved  Set to false if multiple children share the name and the lookup must fall back to a scan.
+   * @return	Child or nullptr.
+   */
+  Object* findIndexedChild(std::string_view name, bool& resolved) const;
+
+  /**
+   * @brief Update type table after the component was added.
+   *
+   * @param	component Added component.
+   */
+  void registerComponent(Component* component);
+
+
+  /**
+   * @brief Recompute cached world bounds for the nearest transform and its world version.
+   */
+  void updateWorldBounds(Transform* transform, uint64_t world_version);
+
+  /**
+   * @brief Advance the version clock if needed, so that changes made after caching raise the subtree version above the
+   *        cached one.
+   */
+  void advanceClockPast() const;
+
  private:
   /**
    * Active flag.
@@ -214,6 +542,31 @@ class Object : public Identifiable, public RefCounter<Object> {
    */
   Object* parent_;
 
+  /**
+   * Scene that contains the object.
+   */
+  Scene* scene_;
+
+  /**
+   * Entity of the object within the scene component registry.
+   */
+  Entity entity_;
+
+  /**
+   * Entry of the object within the scene hierarchy index.
+   */
+  HierarchyIndex::Entry index_entry_;
+
+  friend class HierarchyIndex;
+  friend class Scene;
+  friend class TransformSystem;
+
+  /**
+   * Transform system shared by the transforms of the hierarchy. Only set on hierarchy roots. Declared before the
+   * children and components, so that it outlives their transforms.
+   */
+  std::shared_ptr<TransformSystem> transform_system_;
+
   /**
    * Holds child objects.
    */
@@ -224,10 +577,51 @@ class Object : public Identifiable, public RefCounter<Object> {
    */
   std::vector<Ref<Component>> components_;
 
+  /**
+   * Type id to first component of that type or of a type declaring it as a base. Only written when a component is
+   * added.
+   */
+  std::vector<Component*> component_table_;
+
+  /**
+   * @brief Cached bounds together with the versions they were computed for.
+   */
+  struct BoundsCache {
+    bool matches(const uint64_t subtree_version, const uint64_t world_version) const {
+      return cached_subtree_version == subtree_version && cached_world_version == world_version;
+    }
+
+    AABB<float> bounds;
+
+    uint64_t cached_subtree_version = 0u;
+
+    uint64_t cached_world_version = 0u;
+  };
+
+  /**
+   * Cached world bounds of the object meshes.
+   */
+  BoundsCache world_bounds_;
+
+  /**
+   * Cached world bounds of the subtree.
+   */
+  BoundsCache subtree_bounds_;
+
   /**
    * Callbacks that are invoked once the object parent changes.
    */
   std::unordered_map<size_t, std::function<void(const Ref<Object>&)>> on_parent_change_callbacks_;
+
+  /**
+   * Latest version of the object and its descendants.
+   */
+  uint64_t subtree_version_;
+
+  /**
+   * Global version clock.
+   */
+  static std::atomic<uint64_t> version_clock_;
 };
 
 template <typename T>
@@ -241,6 +635,18 @@ Ref<T> Object::parent() const {
 
 template <typename T>
 Ref<Object> Object::getChild(std::string_view name) const {
+  if (scene_ != nullptr) {
+    bool resolved;
+    Object* child = findIndexedChild(name, resolved);
+    if (resolved) {
+      if constexpr (std::is_same_v<T, Object>) {
+        return Ref<Object>(child);
+      } else {
+        return Ref<Object>(dynamic_cast<T*>(child));
+      }
+    }
+  }
+
   for (const auto& child : children_) {
     if (child->name() == name) {
       if constexpr (std::is_same_v<T, Object>) {
@@ -257,35 +663,139 @@ Ref<Object> Object::getChild(std::string_view name) const {
   return nullptr;
 }
 
+template <typename Fn>
+void Object::traverseUp(const Fn& traversal_fn) {
+  traverseUpImpl(*this, traversal_fn, true);
+}
+
+template <typename Fn>
+void Object::traverseUp(const Fn& traversal_fn) const {
+  traverseUpImpl(*this, traversal_fn, true);
+}
+
+template <typename Fn>
+void Object::traverseUpExcl(const Fn& traversal_fn) {
+  traverseUpImpl(*this, traversal_fn, false);
+}
+
+template <typename Fn>
+void Object::traverseUpExcl(const Fn& traversal_fn) const {
+  traverseUpImpl(*this, traversal_fn, false);
+}
+
+template <typename Fn>
+void Object::traverseDown(const Fn& traversal_fn) {
+  traverseDownImpl(*this, traversal_fn, true);
+}
+
+template <typename Fn>
+void Object::traverseDown(const Fn& traversal_fn) const {
+  traverseDownImpl(*this, traversal_fn, true);
+}
+
+template <typename Fn>
+void Object::traverseDownExcl(const Fn& traversal_fn) {
+  traverseDownImpl(*this, traversal_fn, false);
+}
+
+template <typename Fn>
+void Object::traverseDownExcl(const Fn& traversal_fn) const {
+  traverseDownImpl(*this, traversal_fn, false);
+}
+
+template <typename O, typename Fn>
+bool Object::visit(O& object, const Fn& traversal_fn) {
+  if constexpr (std::is_invocable_v<const Fn&, O&>) {
+    if constexpr (std::is_void_v<std::invoke_result_t<const Fn&, O&>>) {
+      traversal_fn(object);
+      return true;
+    } else {
+      return static_cast<bool>(traversal_fn(object));
+    }
+  } else {
+    return static_cast<bool>(traversal_fn(Ref<Object>(const_cast<Object*>(&object))));
+  }
+}
+
+template <typename O, typename Fn>
+void Object::traverseUpImpl(O& object, const Fn& traversal_fn, const bool inclusive) {
+  for (O* current = inclusive ? &object : object.parent_; current != nullptr; current = current->parent_) {
+    if (!visit(*current, traversal_fn)) {
+      return;
+    }
+  }
+}
+
+template <typename O, typename Fn>
+void Object::traverseDownImpl(O& object, const Fn& traversal_fn, const bool inclusive) {
+  if (inclusive && !visit(object, traversal_fn)) {
+    return;
+  }
+
+  std::vector<const Object*>& stack = traversalStack();
+  const size_t base = stack.size();
+
+  // Restores the stack if the traversal function throws.
+  struct StackGuard {
+    std::vector<const Object*>& stack;
+    size_t base;
+    ~StackGuard() {
+      stack.resize(base);
+    }
+  } guard {stack, base};
+
+  // Children are pushed in reverse so that they are visited in order.
+  for (auto it = object.children_.rbegin(); it != object.children_.rend(); ++it) {
+    stack.emplace_back(it->get());
+  }
+
+  while (stack.size() > base) {
+    O& current = *const_cast<O*>(stack.back());
+    stack.pop_back();
+
+    if (visit(current, traversal_fn)) {
+      for (auto it = current.children_.rbegin(); it != current.children_.rend(); ++it) {
+        stack.emplace_back(it->get());
+      }
+    }
+  }
+}
+
 template <typename T, typename... Args>
 Ref<T> Object::addComponent(Args... args) {
-  components_.emplace_back(makeRef<T>(*this, args...));
-  return Ref<T>(staticRefCast<T>(components_.back()));
+  Ref<T> component = makeRef<T>(*this, args...);
+  component->type_ids_ = &Component::typeIdsOf<T>();
+  component->type_id_ = component->type_ids_->front();
+  components_.emplace_back(component);
+  registerComponent(component.get());
+  return component;
 }
 
 template <typename T>
 Ref<T> Object::getComponent() {
-  for (const auto& component : components_) {
-    Ref<T> casted = dynamicRefCast<T>(component);
-    if (casted) {
-      return casted;
-    }
-  }
-
-  return nullptr;
+  return Ref<T>(findComponent<T>());
 }
 
 template <typename T>
-std::vector<Ref<T>> Object::getComponents() {
-  std::vector<Ref<T>> matches;
-  for (const auto& component : components_) {
-    Ref<T> casted = dynamicRefCast<T>(&component);
-    if (casted != nullptr) {
-      matches.emplace_back(casted);
-    }
+T* Object::findComponent() {
+  static_assert(Component::isLookupType<T>(), "Non final component types must declare their ComponentBases.");
+
+  if constexpr (std::is_same_v<T, Component>) {
+    return components_.empty() ? nullptr : components_.front().get();
+  } else {
+    const ComponentTypeId type_id = Component::typeIdOf<T>();
+    return (type_id < component_table_.size()) ? static_cast<T*>(component_table_[type_id]) : nullptr;
   }
+}
 
-  return matches;
+template <typename T>
+ComponentRange<T> Object::getComponents() {
+  return ComponentRange<T>(components_);
+}
+
+template <typename T>
+ComponentRange<const T> Object::getComponents() const {
+  return ComponentRange<const T>(components_);
 }
 
 } // namespace lsg
@@ -0,0 +1,97 @@
+/**
+ * Project LogiSceneGraph source code
+ * Copyright (C) 2019 Primoz Lavric
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LSG_CORE_POOL_ALLOCATOR_H
+#define LSG_CORE_POOL_ALLOCATOR_H
+
+#include <cstddef>
+
+#ifndef LSG_POOL_ALLOCATION
+#define LSG_POOL_ALLOCATION 1
+#endif
+
+namespace lsg {
+
+/**
+ * @brief Process wide size class slab allocator used for reference counted objects. Allocations up to k_max_size bytes
+ *        are rounded up to a multiple of k_granularity and served from 64 KiB slabs of the matching size class, larger
+ *        allocations fall through to the global operator new. Freed slots are kept for reuse until trim() returns
+ *        completely empty slabs to the system.
+ */
+class PoolAllocator {
+ public:
+  static constexpr size_t k_granularity = 16u;
+
+  static constexpr size_t k_max_size = 512u;
+
+  static constexpr size_t k_slab_size = 64u * 1024u;
+
+  /**
+   * @brief Allocator statistics.
+   */
+  struct Stats {
+    /**
+     * Number of slabs currently held by the allocator.
+     */
+    size_t slabs = 0u;
+
+    /**
+     * Number of live pooled allocations.
+     */
+    size_t live_allocations = 0u;
+
+    /**
+     * Total number of pooled allocations.
+     */
+    size_t total_allocations = 0u;
+  };
+
+  /**
+   * @brief   Allocate memory of the given size aligned to k_granularity.
+   *
+   * @param   size  Size in bytes.
+   * @return	Pointer to the allocated memory.
+   */
+  static void* allocate(size_t size);
+
+  /**
+   * @brief Free memory allocated by allocate.
+   *
+   * @param	ptr   Pointer to the memory.
+   * @param	size  Size passed to allocate.
+   */
+  static void deallocate(void* ptr, size_t size) noexcept;
+
+  /**
+   * @brief   Return all empty slabs to the system. Call after a scene is torn down to release its memory in bulk.
+   *
+   * @return	Number of released slabs.
+   */
+  static size_t trim();
+
+  /**
+   * @brief   Retrieve allocator statistics.
+   *
+   * @return	Statistics.
+   */
+  static Stats stats();
+};
+
+} // namespace lsg
+
+#endif // LSG_CORE_POOL_ALLOCATOR_H
@@ -22,18 +22,84 @@
 #include <atomic>
 #include <cstdlib>
 #include <iostream>
+#include <new>
+#include "lsg/core/PoolAllocator.h"
+
+#ifndef LSG_ATOMIC_REF_COUNT
+#define LSG_ATOMIC_REF_COUNT 1
+#endif
 
 namespace lsg {
 
-template <typename DerivedT>
+/**
+ * @brief Thread safe reference count.
+ */
+class AtomicRefCount {
+ public:
+  AtomicRefCount() noexcept : count_(0u) {}
+
+  void increment() noexcept {
+    count_.fetch_add(1u, std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief   Decrement the count.
+   *
+   * @return	True if the count dropped to zero.
+   */
+  bool decrement() noexcept {
+    return count_.fetch_sub(1u, std::memory_order_acq_rel) == 1u;
+  }
+
+  size_t load() const noexcept {
+    return count_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  std::atomic<size_t> count_;
+};
+
+/**
+ * @brief Plain integer reference count. Only valid if Refs to the object are never copied or released concurrently.
+ */
+class PlainRefCount {
+ public:
+  PlainRefCount() noexcept : count_(0u) {}
+
+  void increment() noexcept {
+    count_++;
+  }
+
+  bool decrement() noexcept {
+    return --count_ == 0u;
+  }
+
+  size_t load() const noexcept {
+    return count_;
+  }
+
+ private:
+  size_t count_;
+};
+
+/**
+ * Counting policy of the library types, selected with the LSG_ATOMIC_REF_COUNT build option.
+ */
+#if LSG_ATOMIC_REF_COUNT
+using DefaultRefCount = AtomicRefCount;
+#else
+using DefaultRefCount = PlainRefCount;
+#endif
+
+template <typename DerivedT, typename CountPolicy = DefaultRefCount>
 class RefCounter {
   template <typename T>
   friend class Ref;
 
  public:
-  RefCounter() noexcept : ref_counter_(0) {}
+  RefCounter() noexcept : ref_counter_() {}
 
-  RefCounter(const RefCounter&) noexcept : ref_counter_(0) {}
+  RefCounter(const RefCounter&) noexcept : ref_counter_() {}
 
   RefCounter& operator=(const RefCounter&) noexcept {
     return *this;
@@ -43,21 +109,43 @@ class RefCounter {
     return ref_counter_.load();
   }
 
+#if LSG_POOL_ALLOCATION
+  /**
+   * Reference counted objects are allocated from the size class pools. Objects are always deleted through release(),
+   * which invokes the virtual destructor where needed, so the sized delete receives the size of the dynamic type.
+   */
+  static void* operator new(size_t size) {
+    return PoolAllocator::allocate(size);
+  }
+
+  static void operator delete(void* ptr, size_t size) noexcept {
+    PoolAllocator::deallocate(ptr, size);
+  }
+
+  static void* operator new(size_t size, std::align_val_t alignment) {
+    return ::operator new(size, alignment);
+  }
+
+  static void operator delete(void* ptr, size_t size, std::align_val_t alignment) noexcept {
+    ::operator delete(ptr, size, alignment);
+  }
+#endif
+
  protected:
   ~RefCounter() = default;
 
  private:
   void addRef() const noexcept {
-    ref_counter_.fetch_add(1u, std::memory_order_acq_rel);
+    ref_counter_.increment();
   }
 
   void release() const noexcept {
-    if (ref_counter_.fetch_sub(1u, std::memory_order_acq_rel) == 1u) {
+    if (ref_counter_.decrement()) {
       delete static_cast<const DerivedT*>(this);
     };
   }
 
-  mutable std::atomic<size_t> ref_counter_;
+  mutable CountPolicy ref_counter_;
 };
 
 template <typename T>
@@ -19,16 +19,250 @@
 #ifndef LSG_CORE_SCENE_H
 #define LSG_CORE_SCENE_H
 
+#include <limits>
+#include <memory>
+#include <string>
 #include <vector>
+#include "lsg/accelerators/DynamicAABBTree.h"
+#include "lsg/core/ChangeJournal.h"
+#include "lsg/core/ComponentRegistry.h"
+#include "lsg/core/HierarchyIndex.h"
 #include "lsg/core/Identifiable.h"
 #include "lsg/core/Object.h"
+#include "lsg/core/SceneSnapshot.h"
+#include "lsg/core/ThreadPool.h"
+#include "lsg/math/Frustum.h"
 
 namespace lsg {
 
+class LODGroup;
+
+class LODSelection;
+
+struct LODView;
+
+class SubMesh;
+
+/**
+ * @brief Sub-mesh instance that passed culling. Pointers are valid until the scene is modified.
+ */
+struct VisibleSubMesh {
+  Object* object;
+
+  SubMesh* sub_mesh;
+
+  /**
+   * LOD group the sub-mesh belongs to or nullptr for sub-meshes of a mesh.
+   */
+  const LODGroup* lod_group = nullptr;
+
+  /**
+   * Level of the LOD group selected for the view.
+   */
+  size_t lod_level = 0u;
+};
+
 class Scene : public Object {
-  using Object::Object;
+ public:
+  explicit Scene(std::string name, bool active = true);
+
+  Scene(const Scene& other) = delete;
+  Scene(Scene&& other) = delete;
+
+  /**
+   * @brief   Retrieve registry that holds components of all objects in the scene.
+   *
+   * @return	Component registry.
+   */
+  const ComponentRegistry& registry() const;
+
+  /**
+   * @brief   Retrieve journal of structural edits of the scene and resource version increments. Journal is disabled
+   *          until enabled by a consumer.
+   *
+   * @return	Change journal.
+   */
+  ChangeJournal& changeJournal();
+
+  const ChangeJournal& changeJournal() const;
+
+  /**
+   * @brief   Create view over the objects in the scene that have components of all given types. Components are matched
+   *          by the exact type with which they were added.
+   *
+   * @tparam  Ts  Component types.
+   * @return	View.
+   */
+  template <typename... Ts>
+  RegistryView<Ts...> view() const;
+
+  /**
+   * @brief Computes world matrices of all dirty transforms of the scene. Hierarchy is processed level by level and
+   *        transforms of the same depth are updated in parallel. After the call the const Transform::worldMatrix and
+   *        Transform::worldVersion overloads return up to date values and may be called from any number of threads
+   *        until a transform or the hierarchy of the scene is modified again.
+   *
+   * @param	executor  Thread pool on which the transforms are updated.
+   */
+  void updateTransforms(ThreadPool& executor = ThreadPool::global());
+
+  /**
+   * @brief Update transforms and bring the spatial index up to date. Only subtrees that changed since the previous
+   *        update and subtrees whose ancestors moved are visited.
+   *
+   * @param	executor  Thread pool on which the transforms are updated.
+   */
+  void updateSpatialIndex(ThreadPool& executor = ThreadPool::global());
+
+  /**
+   * @brief   Retrieve spatial index over the world space bounds of all objects in the scene that have a mesh. Bounds
+   *          are the union of the sub-mesh geometry bounds transformed by the world matrix. Index reflects the scene
+   *          at the time of the last updateSpatialIndex call, except that objects removed from the scene are removed
+   *          from the index immediately.
+   *
+   * @return	Spatial index.
+   */
+  const DynamicAABBTree<float, Object*>& spatialIndex() const;
+
+  /**
+   * @brief Collect sub-meshes of the active objects whose world bounds intersect the view frustum of the camera.
+   *        Frustum is built from the projection matrix of the camera component and the world matrix of the camera
+   *        object. Levels of the visible LOD groups are selected for this camera.
+   *
+   * @param	camera_object Object with a camera component.
+   * @param	output        Visible sub-meshes in traversal order.
+   * @param	executor      Thread pool on which the top level subtrees are culled.
+   * @param	lod_selection Levels previously selected for this camera, updated with the new selection. If null, the
+   *                      selection starts from the finest levels.
+   */
+  void cull(Object& camera_object, std::vector<VisibleSubMesh>& output, ThreadPool& executor = ThreadPool::global(),
+            LODSelection* lod_selection = nullptr);
+
+  /**
+   * @brief Collect sub-meshes of the active objects whose world bounds intersect the frustum. Subtrees are rejected
+   *        by their cached subtree bounds and the children of each object are tested together in a batch. Subtrees
+   *        that are fully inside the frustum are accepted without further plane tests. Top level subtrees are culled
+   *        in parallel.
+   *
+   * @param	frustum   World space frustum.
+   * @param	output    Visible sub-meshes in traversal order.
+   * @param	executor  Thread pool on which the top level subtrees are culled.
+   * @param	lod_view  View for which the levels of the visible LOD groups are selected. The selection of the view
+   *                  is updated after the parallel part. If null, the finest levels are emitted.
+   */
+  void cull(const Frustum<float>& frustum, std::vector<VisibleSubMesh>& output,
+            ThreadPool& executor = ThreadPool::global(), const LODView* lod_view = nullptr);
+
+  /**
+   * @brief   Update transforms and flatten the scene into an immutable snapshot that replaces the published one.
+   *          Subtrees that did not change since the previous compilation are copied from the previous snapshot. Must
+   *          be called from the thread that modifies the scene.
+   *
+   * @param	  executor  Thread pool on which the transforms are updated.
+   * @return	Compiled snapshot.
+   */
+  std::shared_ptr<const SceneSnapshot> compile(ThreadPool& executor = ThreadPool::global());
+
+  /**
+   * @brief   Retrieve the most recently compiled snapshot. May be called from any thread concurrently with compile.
+   *          Snapshot stays valid for as long as the caller holds it.
+   *
+   * @return	Snapshot or nullptr if the scene was not compiled yet.
+   */
+  std::shared_ptr<const SceneSnapshot> snapshot() const;
+
+  ~Scene() override;
+
+ private:
+  friend class Object;
+
+  /**
+   * @brief Spatial index state of a single entity.
+   */
+  struct SpatialEntry {
+    /**
+     * Entry in the spatial index or k_null_node if the object has no bounds.
+     */
+    DynamicAABBTree<float, Object*>::NodeId node = DynamicAABBTree<float, Object*>::k_null_node;
+
+    /**
+     * World version of the nearest transform at the last update or k_unset_version if the object was not visited.
+     */
+    uint64_t world_version = k_unset_version;
+  };
+
+  static constexpr uint64_t k_unset_version = std::numeric_limits<uint64_t>::max();
+
+  /**
+   * @brief Cull the subtree of the object with a non-recursive traversal. Reads only cached bounds, so it may run
+   *        concurrently for disjoint subtrees.
+   *
+   * @param	root    Root of the subtree.
+   * @param	frustum World space frustum.
+   * @param	inside    True if the subtree is known to be fully inside the frustum.
+   * @param	lod_view  View for the LOD selection or null. Selection of the view is only read.
+   * @param	output    Visible sub-meshes.
+   */
+  static void cullSubtree(Object& root, const Frustum<float>& frustum, bool inside, const LODView* lod_view,
+                          std::vector<VisibleSubMesh>& output);
+
+  /**
+   * @brief Append all sub-meshes of the object and the selected levels of its LOD groups to the output.
+   */
+  static void emitSubMeshes(Object& object, const LODView* lod_view, std::vector<VisibleSubMesh>& output);
+
+  /**
+   * @brief Remove entity from the spatial index when the object leaves the scene.
+   */
+  void removeFromSpatialIndex(Entity entity);
+
+  /**
+   * Holds components of all objects in the scene.
+   */
+  ComponentRegistry registry_;
+
+  /**
+   * Name and path index of all objects in the scene.
+   */
+  HierarchyIndex index_;
+
+  /**
+   * Scenes nested directly in this scene. Their objects are indexed only by the nested scene, so lookups descend
+   * into their indexes.
+   */
+  std::vector<Scene*> nested_scenes_;
+
+  /**
+   * Records changes of the scene for incremental consumers.
+   */
+  ChangeJournal journal_;
+
+  /**
+   * Bounds of the objects with a mesh.
+   */
+  DynamicAABBTree<float, Object*> spatial_index_;
+
+  /**
+   * Spatial index state of the entities.
+   */
+  std::vector<SpatialEntry> spatial_entries_;
+
+  /**
+   * Version clock value at the last spatial index update.
+   */
+  uint64_t spatial_version_;
+
+  /**
+   * Published snapshot. Accessed only through std::atomic_load and std::atomic_store.
+   */
+  std::shared_ptr<const SceneSnapshot> snapshot_;
 };
 
+template <typename... Ts>
+RegistryView<Ts...> Scene::view() const {
+  return registry_.view<Ts...>();
+}
+
 } // namespace lsg
 
 #endif // LSG_CORE_SCENE_H
\ No newline at end of file
@@ -0,0 +1,208 @@
+/**
+ * Project LogiSceneGraph source code
+ * Copyright (C) 2019 Primoz Lavric
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LSG_CORE_SCENE_SNAPSHOT_H
+#define LSG_CORE_SCENE_SNAPSHOT_H
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
+#include <glm/glm.hpp>
+#include "lsg/core/Ref.h"
+#include "lsg/materials/Material.h"
+#include "lsg/resources/Geometry.h"
+
+namespace lsg {
+
+class Object;
+class Scene;
+
+/**
+ * @brief Immutable flattened copy of the scene produced by Scene::compile. Objects are stored in depth first pre-order,
+ *        so the subtree of the object at index i occupies the range [i, subtreeEnds()[i]). Per object and per sub-mesh
+ *        data is stored in separate arrays. Snapshot never references the live objects, so it may be read from any
+ *        number of threads without locking while the scene is being modified.
+ */
+class SceneSnapshot {
+ public:
+  static constexpr uint32_t k_no_parent = std::numeric_limits<uint32_t>::max();
+
+  SceneSnapshot(const SceneSnapshot& other) = delete;
+
+  SceneSnapshot& operator=(const SceneSnapshot& other) = delete;
+
+  /**
+   * @brief   Retrieve value of the object version clock at the time of the compilation. Objects whose subtree version is
+   *          not greater than this value were not modified since.
+   *
+   * @return	Snapshot version.
+   */
+  uint64_t version() const;
+
+  /**
+   * @brief   Retrieve version of the snapshot this one was compiled from. Modified objects are relative to that
+   *          snapshot, so consumers that did not see it must not rely on them.
+   *
+   * @return	Version of the previous snapshot or 0 if there was none.
+   */
+  uint64_t previousVersion() const;
+
+  /**
+   * @brief   Retrieve version of the snapshot structure. Structure consists of the objects, their parents and active
+   *          flags and the geometries and materials of their sub-meshes. Version is carried over from the previous
+   *          snapshot when the structure did not change, so consumers may then update only the world matrices.
+   *
+   * @return	Structure version.
+   */
+  uint64_t structureVersion() const;
+
+  size_t objectCount() const;
+
+  size_t subMeshCount() const;
+
+  /**
+   * @brief   Retrieve number of objects that were copied from the previous snapshot instead of being read from the scene.
+   *
+   * @return	Number of reused objects.
+   */
+  size_t reusedObjectCount() const;
+
+  /**
+   * @brief   Retrieve indices of the objects that were read from the scene. World matrices of all other objects equal
+   *          the ones in the previous snapshot.
+   *
+   * @return	Modified object indices in ascending order.
+   */
+  const std::vector<uint32_t>& modifiedObjects() const;
+
+  /**
+   * @brief   Retrieve ids of the objects (see Identifiable::id).
+   *
+   * @return	Object ids.
+   */
+  const std::vector<size_t>& objectIds() const;
+
+  /**
+   * @brief   Retrieve index of the parent of each object or k_no_parent for the root.
+   *
+   * @return	Parent indices.
+   */
+  const std::vector<uint32_t>& parents() const;
+
+  /**
+   * @brief   Retrieve index one past the last descendant of each object.
+   *
+   * @return	Subtree end indices.
+   */
+  const std::vector<uint32_t>& subtreeEnds() const;
+
+  /**
+   * @brief   Retrieve world matrices of the objects. Objects without a transform inherit the world matrix of the parent.
+   *
+   * @return	World matrices.
+   */
+  const std::vector<glm::mat4>& worldMatrices() const;
+
+  /**
+   * @brief   Retrieve flags that tell whether the object is active in hierarchy (1) or not (0).
+   *
+   * @return	Active flags.
+   */
+  const std::vector<uint8_t>& activeFlags() const;
+
+  /**
+   * @brief   Retrieve offsets of the object sub-meshes. Sub-meshes of the object at index i occupy the range
+   *          [subMeshOffsets()[i], subMeshOffsets()[i + 1]).
+   *
+   * @return	Sub-mesh offsets (object count + 1 elements).
+   */
+  const std::vector<uint32_t>& subMeshOffsets() const;
+
+  /**
+   * @brief   Retrieve index of the object that owns each sub-mesh.
+   *
+   * @return	Sub-mesh object indices.
+   */
+  const std::vector<uint32_t>& subMeshObjects() const;
+
+  const std::vector<Ref<Geometry>>& geometries() const;
+
+  const std::vector<Ref<Material>>& materials() const;
+
+ private:
+  friend class Scene;
+
+  SceneSnapshot() = default;
+
+  /**
+   * @brief   Flatten the scene. Subtrees that were not modified since the previous snapshot and whose ancestors kept
+   *          their world matrices and active state are copied from the previous snapshot as a whole. World matrices
+   *          must be up to date.
+   *
+   * @param	  scene     Scene.
+   * @param	  previous  Previous snapshot of the same scene or nullptr.
+   * @param	  version   Version clock value taken before the compilation.
+   * @return	Snapshot.
+   */
+  static std::shared_ptr<const SceneSnapshot> compile(Scene& scene, const SceneSnapshot* previous, uint64_t version);
+
+  /**
+   * @brief Append object read from the scene.
+   */
+  void appendObject(Object& object, uint32_t parent, const glm::mat4& parent_matrix, bool parent_active);
+
+  /**
+   * @brief Append subtree copied from the previous snapshot.
+   */
+  void appendSubtree(const SceneSnapshot& previous, uint32_t first, uint32_t parent);
+
+  bool hasSameStructure(const SceneSnapshot& other) const;
+
+  uint64_t version_ = 0u;
+
+  uint64_t previous_version_ = 0u;
+
+  uint64_t structure_version_ = 0u;
+
+  size_t reused_objects_ = 0u;
+
+  std::vector<uint32_t> modified_objects_;
+
+  std::vector<size_t> object_ids_;
+
+  std::vector<uint32_t> parents_;
+
+  std::vector<uint32_t> subtree_ends_;
+
+  std::vector<glm::mat4> world_matrices_;
+
+  std::vector<uint8_t> active_flags_;
+
+  std::vector<uint32_t> sub_mesh_offsets_;
+
+  std::vector<uint32_t> sub_mesh_objects_;
+
+  std::vector<Ref<Geometry>> geometries_;
+
+  std::vector<Ref<Material>> materials_;
+};
+
+} // namespace lsg
+
+#endif // LSG_CORE_SCENE_SNAPSHOT_H
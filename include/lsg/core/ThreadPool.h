@@ -0,0 +1,240 @@
+/**
+ * Project LogiSceneGraph source code
+ * Copyright (C) 2019 Primoz Lavric
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LSG_CORE_THREAD_POOL_H
+#define LSG_CORE_THREAD_POOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace lsg {
+
+/**
+ * @brief Work-stealing thread pool. Each worker owns a task queue and steals from the queues of other workers
+ *        once its own queue runs dry.
+ */
+class ThreadPool {
+ public:
+  /**
+   * @brief Spawns the given number of worker threads (at least one).
+   *
+   * @param	num_threads Number of worker threads.
+   */
+  explicit ThreadPool(size_t num_threads = std::thread::hardware_concurrency());
+
+  ThreadPool(const ThreadPool& other) = delete;
+  ThreadPool(ThreadPool&& other) = delete;
+
+  ThreadPool& operator=(const ThreadPool& rhs) = delete;
+  ThreadPool& operator=(ThreadPool&& rhs) = delete;
+
+  /**
+   * @brief   Retrieve number of worker threads. Slot passed to the tasks is always lower than this value and
+   *          identifies the worker that runs the task, which makes it suitable for indexing per-thread scratch memory.
+   *          A worker waiting in a nested parallelFor runs other tasks with the same slot before the waiting task
+   *          resumes, so per-slot scratch must not be held across calls that may run parallelFor on the same pool.
+   *
+   * @return	Number of worker threads.
+   */
+  size_t numThreads() const;
+
+  /**
+   * @brief Splits range [0, count) into chunks of the given size and executes them on the pool. Function is invoked
+   *        as fn(begin, end, slot). Call blocks until all chunks are processed. If the call is made from a worker
+   *        thread, the worker executes pending tasks while waiting. First exception thrown by fn is rethrown.
+   *
+   * @param	count       Number of elements.
+   * @param	chunk_size  Number of elements processed by a single task.
+   * @param	fn          Function that processes a chunk.
+   */
+  template <typename Fn>
+  void parallelFor(size_t count, size_t chunk_size, const Fn& fn);
+
+  /**
+   * @brief   If the calling thread is a worker, executes pending tasks until the predicate returns true. Workers that
+   *          wait for work running on the pool must do so, otherwise the pool could run out of threads to finish it.
+   *
+   * @param	  done  Predicate that reports whether the awaited work has finished.
+   * @return	False if the calling thread is not a worker of this pool and has to block on its own.
+   */
+  template <typename Predicate>
+  bool helpUntil(const Predicate& done);
+
+  /**
+   * @brief   Retrieve process wide thread pool that uses all hardware threads.
+   *
+   * @return	Global thread pool.
+   */
+  static ThreadPool& global();
+
+  /**
+   * @brief Stops and joins the workers. Pending tasks are executed first.
+   */
+  ~ThreadPool();
+
+ protected:
+  using Task = std::function<void(size_t)>;
+
+  /**
+   * @brief Task queue owned by a single worker.
+   */
+  struct WorkerQueue {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+  };
+
+  /**
+   * @brief Counts down finished chunks of a single parallelFor call.
+   */
+  struct Completion {
+    std::mutex mutex;
+    std::condition_variable cv;
+    size_t remaining = 0u;
+    std::exception_ptr error;
+  };
+
+  /**
+   * @brief Push the task to the queue with the given index and wake a worker.
+   */
+  void push(size_t queue_index, Task task);
+
+  /**
+   * @brief   Pop a task from the back of the own queue or steal one from the front of another queue.
+   *
+   * @param	  slot  Slot of the worker looking for work.
+   * @param	  task  Output task.
+   * @return	True if a task was acquired.
+   */
+  bool acquire(size_t slot, Task& task);
+
+  /**
+   * @brief   Retrieve slot of the calling thread or numThreads() if the calling thread is not a worker of this pool.
+   */
+  size_t currentSlot() const;
+
+  void workerLoop(size_t slot);
+
+ private:
+  /**
+   * Per worker task queues.
+   */
+  std::vector<std::unique_ptr<WorkerQueue>> queues_;
+
+  /**
+   * Worker threads.
+   */
+  std::vector<std::thread> workers_;
+
+  /**
+   * Number of tasks waiting in the queues.
+   */
+  std::atomic<size_t> pending_;
+
+  /**
+   * Used to put idle workers to sleep.
+   */
+  std::mutex wake_mutex_;
+  std::condition_variable wake_cv_;
+  bool stop_;
+
+  /**
+   * Pool and slot of the current thread (only set for worker threads).
+   */
+  static thread_local const ThreadPool* t_current_pool_;
+  static thread_local size_t t_current_slot_;
+};
+
+template <typename Fn>
+void ThreadPool::parallelFor(const size_t count, size_t chunk_size, const Fn& fn) {
+  if (count == 0u) {
+    return;
+  }
+
+  chunk_size = std::max<size_t>(chunk_size, 1u);
+  const size_t num_chunks = (count + chunk_size - 1u) / chunk_size;
+
+  Completion completion;
+  completion.remaining = num_chunks;
+
+  for (size_t i = 0u; i < num_chunks; i++) {
+    push(i % queues_.size(), [&completion, &fn, i, count, chunk_size](const size_t slot) {
+      std::exception_ptr error;
+      try {
+        fn(i * chunk_size, std::min(count, (i + 1u) * chunk_size), slot);
+      } catch (...) {
+        error = std::current_exception();
+      }
+
+      // Notify under the lock so that the completion cannot be destroyed while it is being signaled.
+      std::lock_guard<std::mutex> lock(completion.mutex);
+      if (error && !completion.error) {
+        completion.error = error;
+      }
+      if (--completion.remaining == 0u) {
+        completion.cv.notify_all();
+      }
+    });
+  }
+
+  // Worker thread must keep processing tasks, otherwise nested calls could deadlock the pool.
+  const bool helped = helpUntil([&completion]() {
+    std::lock_guard<std::mutex> lock(completion.mutex);
+    return completion.remaining == 0u;
+  });
+
+  if (!helped) {
+    std::unique_lock<std::mutex> lock(completion.mutex);
+    completion.cv.wait(lock, [&completion]() { return completion.remaining == 0u; });
+  }
+
+  if (completion.error) {
+    std::rethrow_exception(completion.error);
+  }
+}
+
+template <typename Predicate>
+bool ThreadPool::helpUntil(const Predicate& done) {
+  const size_t slot = currentSlot();
+
+  if (slot >= numThreads()) {
+    return false;
+  }
+
+  Task task;
+  while (!done()) {
+    if (acquire(slot, task)) {
+      task(slot);
+    } else {
+      std::this_thread::yield();
+    }
+  }
+
+  return true;
+}
+
+} // namespace lsg
+
+#endif // LSG_CORE_THREAD_POOL_H
@@ -20,6 +20,8 @@
 #define LSG_CORE_VERSION_TRACKER_H
 
 #include <cstddef>
+#include <mutex>
+#include <vector>
 
 namespace lsg {
 
@@ -34,7 +36,14 @@ class VersionTracker {
   VersionTracker();
 
   /**
-   * @brief Increment version by 1.
+   * @brief Copies the version. Dependents are not copied.
+   */
+  VersionTracker(const VersionTracker& other);
+
+  VersionTracker& operator=(const VersionTracker& other);
+
+  /**
+   * @brief Increment version by 1 and notify dependents.
    */
   void incrementVersion();
 
@@ -43,8 +52,51 @@ class VersionTracker {
    */
   size_t version() const;
 
+  /**
+   * @brief Register tracker that is notified whenever this tracker or any of its dependencies change. Dependent must
+   *        unregister itself before it is destroyed. Dependents may be registered and unregistered from any thread,
+   *        but not from within onDependencyChanged of a dependent of the same tracker.
+   *
+   * @param	dependent Dependent tracker.
+   */
+  void addDependent(VersionTracker& dependent) const;
+
+  /**
+   * @brief Unregister dependent tracker. Does nothing if the tracker is not registered. Once the call returns, the
+   *        dependent is no longer notified.
+   *
+   * @param	dependent Dependent tracker.
+   */
+  void removeDependent(VersionTracker& dependent) const;
+
+  virtual ~VersionTracker() = default;
+
+ protected:
+  /**
+   * @brief Invoked when a tracker this tracker depends on changed. Forwards the notification to own dependents
+   *        without changing own version.
+   *
+   * @param	dependency  Changed tracker.
+   */
+  virtual void onDependencyChanged(const VersionTracker& dependency);
+
+  /**
+   * @brief Invoke onDependencyChanged on all dependents.
+   */
+  void notifyDependents() const;
+
  private:
   size_t version_;
+
+  /**
+   * Guards dependents. Held while the dependents are notified.
+   */
+  mutable std::mutex dependents_mutex_;
+
+  /**
+   * Trackers that depend on this tracker.
+   */
+  mutable std::vector<VersionTracker*> dependents_;
 };
 
 } // namespace lsg
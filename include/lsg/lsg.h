@@ -21,25 +21,44 @@
 
 #include "accelerators/BVH/BVH.h"
 #include "accelerators/BVH/BVHBuilder.h"
+#include "accelerators/BVH/BVHConfig.h"
+#include "accelerators/BVH/BVHLayout.h"
+#include "accelerators/BVH/PreSplitBVHBuilder.h"
+#include "accelerators/BVH/QuantizedBVH.h"
+#include "accelerators/BVH/SAHCalibration.h"
 #include "accelerators/BVH/SAHFunction.h"
 #include "accelerators/BVH/SplitBVHBuilder.h"
+#include "accelerators/DynamicAABBTree.h"
 #include "components/Camera.h"
+#include "components/LODGroup.h"
 #include "components/Mesh.h"
 #include "components/OrthographicCamera.h"
 #include "components/PerspectiveCamera.h"
 #include "components/Transform.h"
+#include "components/TransformSystem.h"
+#include "core/ChangeJournal.h"
 #include "core/Component.h"
+#include "core/ComponentRegistry.h"
 #include "core/Exceptions.h"
+#include "core/HierarchyIndex.h"
 #include "core/Identifiable.h"
 #include "core/Math.h"
 #include "core/Object.h"
+#include "core/PoolAllocator.h"
 #include "core/Scene.h"
+#include "core/SceneSnapshot.h"
+#include "core/ThreadPool.h"
 #include "core/VersionTracker.h"
 #include "loaders/GLTFLoader.h"
+#include "render/InstanceBatcher.h"
+#include "render/OcclusionCuller.h"
+#include "render/RenderList.h"
 #include "lsg/util/String.h"
 #include "materials/Material.h"
 #include "materials/MetallicRoughnessMaterial.h"
 #include "math/AABB.h"
+#include "math/AABBBatch.h"
+#include "math/Frustum.h"
 #include "math/Ray.h"
 #include "resources/Buffer.h"
 #include "resources/BufferAccessor.h"
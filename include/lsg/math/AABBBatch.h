@@ -0,0 +1,112 @@
+/**
+ * Project LogiSceneGraph source code
+ * Copyright (C) 2019 Primoz Lavric
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LSG_MATH_AABB_BATCH_H
+#define LSG_MATH_AABB_BATCH_H
+
+#include <vector>
+#include "lsg/math/AABB.h"
+
+namespace lsg {
+
+/**
+ * @brief Bounding boxes stored as separate coordinate arrays, so that tests against many boxes run as branchless loops
+ *        that the compiler vectorizes.
+ *
+ * @tparam  T Component type.
+ */
+template <typename T>
+class AABBBatch {
+ public:
+  /**
+   * @brief Append bounding box to the batch.
+   *
+   * @param	aabb  Bounding box.
+   */
+  void push(const AABB<T>& aabb);
+
+  /**
+   * @brief Remove all bounding boxes while keeping the storage.
+   */
+  void clear();
+
+  size_t size() const;
+
+  bool empty() const;
+
+  /**
+   * @brief   Retrieve array of minimum coordinates along the axis.
+   *
+   * @param	  axis  Axis index.
+   * @return	Minimum coordinates.
+   */
+  const T* min(size_t axis) const;
+
+  /**
+   * @brief   Retrieve array of maximum coordinates along the axis.
+   *
+   * @param	  axis  Axis index.
+   * @return	Maximum coordinates.
+   */
+  const T* max(size_t axis) const;
+
+ private:
+  std::vector<T> min_[3];
+
+  std::vector<T> max_[3];
+};
+
+template <typename T>
+void AABBBatch<T>::push(const AABB<T>& aabb) {
+  for (size_t axis = 0u; axis < 3u; axis++) {
+    min_[axis].emplace_back(aabb.min()[axis]);
+    max_[axis].emplace_back(aabb.max()[axis]);
+  }
+}
+
+template <typename T>
+void AABBBatch<T>::clear() {
+  for (size_t axis = 0u; axis < 3u; axis++) {
+    min_[axis].clear();
+    max_[axis].clear();
+  }
+}
+
+template <typename T>
+size_t AABBBatch<T>::size() const {
+  return min_[0].size();
+}
+
+template <typename T>
+bool AABBBatch<T>::empty() const {
+  return min_[0].empty();
+}
+
+template <typename T>
+const T* AABBBatch<T>::min(const size_t axis) const {
+  return min_[axis].data();
+}
+
+template <typename T>
+const T* AABBBatch<T>::max(const size_t axis) const {
+  return max_[axis].data();
+}
+
+} // namespace lsg
+
+#endif // LSG_MATH_AABB_BATCH_H
@@ -0,0 +1,194 @@
+/**
+ * Project LogiSceneGraph source code
+ * Copyright (C) 2019 Primoz Lavric
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LSG_MATH_FRUSTUM_H
+#define LSG_MATH_FRUSTUM_H
+
+#include <array>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include "lsg/math/AABB.h"
+#include "lsg/math/AABBBatch.h"
+
+namespace lsg {
+
+/**
+ * @brief Result of the bounding box test against the frustum.
+ */
+enum class Containment : uint8_t { kOutside, kIntersecting, kInside };
+
+template <typename T>
+class Frustum {
+ public:
+  /**
+   * @brief Initializes frustum that contains everything.
+   */
+  Frustum();
+
+  /**
+   * @brief Extracts planes from the view projection matrix (OpenGL clip space convention). Planes point inwards.
+   *
+   * @param	view_projection View projection matrix.
+   */
+  explicit Frustum(const glm::tmat4x4<T>& view_projection);
+
+  /**
+   * @brief   Retrieve planes in order left, right, bottom, top, near, far. Normals are stored in xyz and the distance
+   *          in w, so a point p is inside the plane if dot(xyz, p) + w >= 0.
+   *
+   * @return	Frustum planes.
+   */
+  const std::array<glm::tvec4<T>, 6>& planes() const;
+
+  /**
+   * @brief   Conservatively check if the bounding box intersects the frustum.
+   *
+   * @param	  aabb  Bounding box.
+   * @return	False if the bounding box is certainly outside.
+   */
+  bool intersectsAABB(const AABB<T>& aabb) const;
+
+  /**
+   * @brief   Classify the bounding box against the frustum.
+   *
+   * @param	  aabb  Bounding box.
+   * @return	Containment of the bounding box.
+   */
+  Containment classifyAABB(const AABB<T>& aabb) const;
+
+  /**
+   * @brief Classify all bounding boxes of the batch against the frustum. Each plane is tested against all boxes in a
+   *        branchless loop over the coordinate arrays.
+   *
+   * @param	boxes   Bounding boxes.
+   * @param	results Containment of each box.
+   */
+  void classifyAABBs(const AABBBatch<T>& boxes, std::vector<Containment>& results) const;
+
+ private:
+  std::array<glm::tvec4<T>, 6> planes_;
+};
+
+template <typename T>
+Frustum<T>::Frustum() {
+  planes_.fill(glm::tvec4<T>(T(0), T(0), T(0), T(1)));
+}
+
+template <typename T>
+Frustum<T>::Frustum(const glm::tmat4x4<T>& view_projection) {
+  const glm::tvec4<T> row0(view_projection[0][0], view_projection[1][0], view_projection[2][0], view_projection[3][0]);
+  const glm::tvec4<T> row1(view_projection[0][1], view_projection[1][1], view_projection[2][1], view_projection[3][1]);
+  const glm::tvec4<T> row2(view_projection[0][2], view_projection[1][2], view_projection[2][2], view_projection[3][2]);
+  const glm::tvec4<T> row3(view_projection[0][3], view_projection[1][3], view_projection[2][3], view_projection[3][3]);
+
+  planes_ = {row3 + row0, row3 - row0, row3 + row1, row3 - row1, row3 + row2, row3 - row2};
+
+  for (glm::tvec4<T>& plane : planes_) {
+    // Far plane of an infinite projection has no normal and contains everything.
+    const T length = glm::length(glm::tvec3<T>(plane));
+    if (length > T(0)) {
+      plane = plane * (T(1) / length);
+    }
+  }
+}
+
+template <typename T>
+const std::array<glm::tvec4<T>, 6>& Frustum<T>::planes() const {
+  return planes_;
+}
+
+template <typename T>
+bool Frustum<T>::intersectsAABB(const AABB<T>& aabb) const {
+  for (const glm::tvec4<T>& plane : planes_) {
+    // Corner that is the furthest along the plane normal.
+    const glm::tvec3<T> corner(plane.x >= T(0) ? aabb.max().x : aabb.min().x,
+                               plane.y >= T(0) ? aabb.max().y : aabb.min().y,
+                               plane.z >= T(0) ? aabb.max().z : aabb.min().z);
+
+    if (glm::dot(glm::tvec3<T>(plane), corner) + plane.w < T(0)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+template <typename T>
+Containment Frustum<T>::classifyAABB(const AABB<T>& aabb) const {
+  Containment result = Containment::kInside;
+
+  for (const glm::tvec4<T>& plane : planes_) {
+    const glm::tvec3<T> normal(plane);
+    const glm::tvec3<T> positive(plane.x >= T(0) ? aabb.max().x : aabb.min().x,
+                                 plane.y >= T(0) ? aabb.max().y : aabb.min().y,
+                                 plane.z >= T(0) ? aabb.max().z : aabb.min().z);
+
+    if (glm::dot(normal, positive) + plane.w < T(0)) {
+      return Containment::kOutside;
+    }
+
+    const glm::tvec3<T> negative(plane.x >= T(0) ? aabb.min().x : aabb.max().x,
+                                 plane.y >= T(0) ? aabb.min().y : aabb.max().y,
+                                 plane.z >= T(0) ? aabb.min().z : aabb.max().z);
+
+    if (glm::dot(normal, negative) + plane.w < T(0)) {
+      result = Containment::kIntersecting;
+    }
+  }
+
+  return result;
+}
+
+template <typename T>
+void Frustum<T>::classifyAABBs(const AABBBatch<T>& boxes, std::vector<Containment>& results) const {
+  const size_t count = boxes.size();
+  thread_local std::vector<uint8_t> outside;
+  thread_local std::vector<uint8_t> intersecting;
+  outside.assign(count, 0u);
+  intersecting.assign(count, 0u);
+
+  for (const glm::tvec4<T>& plane : planes_) {
+    // Corner furthest along the plane normal (positive) and the opposite corner (negative) are picked per plane.
+    const T* positive[3];
+    const T* negative[3];
+    for (size_t axis = 0u; axis < 3u; axis++) {
+      positive[axis] = (plane[axis] >= T(0)) ? boxes.max(axis) : boxes.min(axis);
+      negative[axis] = (plane[axis] >= T(0)) ? boxes.min(axis) : boxes.max(axis);
+    }
+
+    for (size_t i = 0u; i < count; i++) {
+      const T positive_distance =
+        plane.x * positive[0][i] + plane.y * positive[1][i] + plane.z * positive[2][i] + plane.w;
+      const T negative_distance =
+        plane.x * negative[0][i] + plane.y * negative[1][i] + plane.z * negative[2][i] + plane.w;
+      outside[i] |= static_cast<uint8_t>(positive_distance < T(0));
+      intersecting[i] |= static_cast<uint8_t>(negative_distance < T(0));
+    }
+  }
+
+  results.resize(count);
+  for (size_t i = 0u; i < count; i++) {
+    results[i] = outside[i] ? Containment::kOutside
+                            : (intersecting[i] ? Containment::kIntersecting : Containment::kInside);
+  }
+}
+
+} // namespace lsg
+
+#endif // LSG_MATH_FRUSTUM_H
@@ -19,8 +19,13 @@
 #ifndef LSG_MATH_RAY_H
 #define LSG_MATH_RAY_H
 
+#include <algorithm>
+#include <cstdint>
 #include <glm/glm.hpp>
+#include <limits>
 #include <optional>
+#include <vector>
+#include "lsg/math/AABBBatch.h"
 
 namespace lsg {
 
@@ -37,6 +42,23 @@ class Ray {
 
   bool intersectAABB(const AABB<T>& aabb) const;
 
+  /**
+   * @brief   Computes distance along the ray at which the ray enters the given bounding box.
+   *
+   * @param   aabb  Bounding box.
+   * @return	Entry distance (zero if the origin lies inside the box) or std::nullopt if the box is missed.
+   */
+  std::optional<T> intersectAABBDistance(const AABB<T>& aabb) const;
+
+  /**
+   * @brief Test all bounding boxes of the batch against the ray. Slabs of all boxes are clipped in a branchless loop
+   *        over the coordinate arrays. Produces the same results as intersectAABBDistance.
+   *
+   * @param	boxes Bounding boxes.
+   * @param	hits  Set to 1 for each box that is entered by the ray and to 0 otherwise.
+   */
+  void intersectAABBs(const AABBBatch<T>& boxes, std::vector<uint8_t>& hits) const;
+
   std::optional<glm::tvec3<T>> intersectTriangle(const glm::tvec3<T>& a, const glm::tvec3<T>& b,
                                                  const glm::tvec3<T>& c) const;
 
@@ -120,6 +142,59 @@ bool Ray<T>::intersectAABB(const AABB<T>& aabb) const {
   return (tmin <= tzmax) && (tzmin <= tmax);
 }
 
+template <typename T>
+std::optional<T> Ray<T>::intersectAABBDistance(const AABB<T>& aabb) const {
+  T tmin = T(0);
+  T tmax = std::numeric_limits<T>::max();
+
+  for (size_t axis = 0u; axis < 3u; axis++) {
+    const T inv_dir = T(1) / dir_[axis];
+    T t0 = (aabb.min()[axis] - origin_[axis]) * inv_dir;
+    T t1 = (aabb.max()[axis] - origin_[axis]) * inv_dir;
+
+    if (inv_dir < T(0)) {
+      std::swap(t0, t1);
+    }
+
+    tmin = std::max(tmin, t0);
+    tmax = std::min(tmax, t1);
+
+    if (tmin > tmax) {
+      return std::nullopt;
+    }
+  }
+
+  return tmin;
+}
+
+template <typename T>
+void Ray<T>::intersectAABBs(const AABBBatch<T>& boxes, std::vector<uint8_t>& hits) const {
+  const size_t count = boxes.size();
+  hits.resize(count);
+
+  // Slab the ray enters first (near) and leaves last (far) is picked per axis.
+  T inv_dir[3];
+  const T* near[3];
+  const T* far[3];
+  for (size_t axis = 0u; axis < 3u; axis++) {
+    inv_dir[axis] = T(1) / dir_[axis];
+    near[axis] = (inv_dir[axis] < T(0)) ? boxes.max(axis) : boxes.min(axis);
+    far[axis] = (inv_dir[axis] < T(0)) ? boxes.min(axis) : boxes.max(axis);
+  }
+
+  for (size_t i = 0u; i < count; i++) {
+    T tmin = T(0);
+    T tmax = std::numeric_limits<T>::max();
+
+    for (size_t axis = 0u; axis < 3u; axis++) {
+      tmin = std::max(tmin, (near[axis][i] - origin_[axis]) * inv_dir[axis]);
+      tmax = std::min(tmax, (far[axis][i] - origin_[axis]) * inv_dir[axis]);
+    }
+
+    hits[i] = static_cast<uint8_t>(tmin <= tmax);
+  }
+}
+
 template <typename T>
 std::optional<glm::tvec3<T>> Ray<T>::intersectTriangle(const glm::tvec3<T>& a, const glm::tvec3<T>& b,
                                                        const glm::tvec3<T>& c) const {
@@ -0,0 +1,144 @@
+/**
+ * Project LogiSceneGraph source code
+ * Copyright (C) 2019 Primoz Lavric
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LSG_RENDER_INSTANCE_BATCHER_H
+#define LSG_RENDER_INSTANCE_BATCHER_H
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
+#include <glm/glm.hpp>
+#include "lsg/core/SceneSnapshot.h"
+#include "lsg/materials/Material.h"
+#include "lsg/resources/Geometry.h"
+
+namespace lsg {
+
+/**
+ * @brief All active sub-mesh instances that share the geometry and the material. Per instance data is stored in
+ *        contiguous arrays, so the world matrices may be uploaded to an instance buffer directly.
+ */
+struct InstanceBatch {
+  const Geometry* geometry;
+
+  const Material* material;
+
+  /**
+   * World matrices of the instances.
+   */
+  std::vector<glm::mat4> world_matrices;
+
+  /**
+   * Snapshot indices of the objects that own the instances.
+   */
+  std::vector<uint32_t> objects;
+};
+
+/**
+ * @brief Groups sub-meshes of a compiled scene by geometry and material identity into instance batches. Batches are
+ *        rebuilt only when the snapshot structure changes. Otherwise only the world matrices of the modified objects
+ *        are rewritten in place.
+ */
+class InstanceBatcher {
+ public:
+  InstanceBatcher() = default;
+
+  InstanceBatcher(const InstanceBatcher& other) = delete;
+
+  InstanceBatcher& operator=(const InstanceBatcher& rhs) = delete;
+
+  /**
+   * @brief Update batches from the snapshot. Snapshot should be compiled from the same scene as the previous one. Only
+   *        matrices of the modified objects are rewritten if the snapshot was compiled directly from the previous one
+   *        and has the same structure.
+   *
+   * @param	snapshot  Compiled scene snapshot.
+   */
+  void update(std::shared_ptr<const SceneSnapshot> snapshot);
+
+  /**
+   * @brief   Retrieve instance batches in the order of their first instance in the snapshot.
+   *
+   * @return	Instance batches.
+   */
+  const std::vector<InstanceBatch>& batches() const;
+
+  /**
+   * @brief   Retrieve total number of instances in all batches.
+   *
+   * @return	Number of instances.
+   */
+  size_t instanceCount() const;
+
+  /**
+   * @brief   Retrieve number of world matrices written by the last update.
+   *
+   * @return	Number of updated instances.
+   */
+  size_t updatedInstanceCount() const;
+
+  /**
+   * @brief   Retrieve snapshot the batches were built from.
+   *
+   * @return	Snapshot or nullptr.
+   */
+  const std::shared_ptr<const SceneSnapshot>& snapshot() const;
+
+  /**
+   * @brief Remove all batches and release the snapshot.
+   */
+  void clear();
+
+ private:
+  static constexpr uint32_t k_no_batch = std::numeric_limits<uint32_t>::max();
+
+  /**
+   * @brief Group all sub-meshes of the snapshot.
+   */
+  void rebuild();
+
+  /**
+   * @brief Copy world matrix of the object to its instances.
+   *
+   * @param	object  Object index in the snapshot.
+   */
+  void updateObject(uint32_t object);
+
+  std::shared_ptr<const SceneSnapshot> snapshot_;
+
+  std::vector<InstanceBatch> batches_;
+
+  /**
+   * Batch of each snapshot sub-mesh or k_no_batch if the sub-mesh is not drawn.
+   */
+  std::vector<uint32_t> sub_mesh_batches_;
+
+  /**
+   * Index of each snapshot sub-mesh within its batch.
+   */
+  std::vector<uint32_t> sub_mesh_slots_;
+
+  size_t instance_count_ = 0u;
+
+  size_t updated_instances_ = 0u;
+};
+
+} // namespace lsg
+
+#endif // LSG_RENDER_INSTANCE_BATCHER_H
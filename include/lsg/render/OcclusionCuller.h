@@ -0,0 +1,167 @@
+/**
+ * Project LogiSceneGraph source code
+ * Copyright (C) 2019 Primoz Lavric
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LSG_RENDER_OCCLUSION_CULLER_H
+#define LSG_RENDER_OCCLUSION_CULLER_H
+
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include "lsg/core/Scene.h"
+#include "lsg/core/ThreadPool.h"
+#include "lsg/math/AABB.h"
+#include "lsg/resources/Geometry.h"
+
+namespace lsg {
+
+/**
+ * @brief CPU occlusion culling. Occluder geometry is rasterized into a low resolution depth buffer, from which a
+ *        hierarchy of max depth levels is built. Occludee bounds are then tested against the level at which their
+ *        screen rectangle spans at most two texels per axis. Depth follows the OpenGL clip space convention and is
+ *        mapped to [0, 1]. No GPU is required.
+ */
+class OcclusionCuller {
+ public:
+  /**
+   * @brief Initialize culler with the given depth buffer resolution.
+   *
+   * @param	width   Depth buffer width.
+   * @param	height  Depth buffer height.
+   */
+  explicit OcclusionCuller(uint32_t width = 256u, uint32_t height = 128u);
+
+  uint32_t width() const;
+
+  uint32_t height() const;
+
+  /**
+   * @brief Set fraction of the screen that a mesh with OccluderHint::kAuto must cover to be used as an occluder.
+   *
+   * @param	fraction  Screen fraction.
+   */
+  void setOccluderThreshold(float fraction);
+
+  float occluderThreshold() const;
+
+  /**
+   * @brief Clear the depth buffer and set the view projection matrix for the following calls.
+   *
+   * @param	view_projection View projection matrix.
+   */
+  void clear(const glm::mat4& view_projection);
+
+  /**
+   * @brief Rasterize triangles of the geometry into the depth buffer. Triangles are clipped against the near plane and
+   *        both windings are rasterized.
+   *
+   * @param	geometry      Occluder geometry.
+   * @param	world_matrix  World matrix of the geometry.
+   */
+  void rasterize(const Geometry& geometry, const glm::mat4& world_matrix);
+
+  /**
+   * @brief Build the max depth hierarchy. Must be called after the occluders are rasterized and before the tests.
+   */
+  void buildHierarchy();
+
+  /**
+   * @brief   Check if the bounding box is hidden behind the rasterized occluders. Boxes that cross the near plane are
+   *          never occluded.
+   *
+   * @param	  world_bounds  World space bounding box.
+   * @return	True if the bounding box is certainly hidden.
+   */
+  bool isOccluded(const AABB<float>& world_bounds) const;
+
+  /**
+   * @brief   Compute fraction of the screen covered by the screen rectangle of the bounding box.
+   *
+   * @param	  world_bounds  World space bounding box.
+   * @return	Covered fraction. Boxes that cross the near plane cover the whole screen.
+   */
+  float screenCoverage(const AABB<float>& world_bounds) const;
+
+  /**
+   * @brief Frustum cull the scene from the perspective camera and remove sub-meshes hidden behind the occluders.
+   *        Meshes with OccluderHint::kAlways and meshes with OccluderHint::kAuto that cover at least the occluder
+   *        threshold are rasterized as occluders.
+   *
+   * @param	scene         Scene.
+   * @param	camera_object Object with a perspective camera component.
+   * @param	visible       Visible sub-meshes.
+   * @param	executor      Thread pool used for frustum culling and occludee tests.
+   */
+  void cull(Scene& scene, Object& camera_object, std::vector<VisibleSubMesh>& visible,
+            ThreadPool& executor = ThreadPool::global());
+
+  /**
+   * @brief   Retrieve number of objects rasterized as occluders by the last cull call.
+   *
+   * @return	Number of occluders.
+   */
+  size_t occluderCount() const;
+
+  size_t levelCount() const;
+
+  /**
+   * @brief   Retrieve depth level. Level 0 holds the nearest occluder depth of each pixel and each following level
+   *          holds the maximum of 2x2 texels of the previous level.
+   *
+   * @param	  level Level index.
+   * @return	Depth values in row major order.
+   */
+  const std::vector<float>& depth(size_t level = 0u) const;
+
+ private:
+  /**
+   * @brief Screen space rectangle and the nearest depth of a projected bounding box.
+   */
+  struct ScreenRect {
+    glm::vec2 min;
+    glm::vec2 max;
+    float min_depth;
+    bool crosses_near;
+  };
+
+  ScreenRect project(const AABB<float>& world_bounds) const;
+
+  void rasterizeClipped(const glm::vec4& a, const glm::vec4& b, const glm::vec4& c);
+
+  void rasterizeTriangle(const glm::vec3& a, glm::vec3 b, glm::vec3 c);
+
+  uint32_t width_;
+
+  uint32_t height_;
+
+  float occluder_threshold_;
+
+  size_t occluder_count_;
+
+  glm::mat4 view_projection_;
+
+  /**
+   * Level dimensions.
+   */
+  std::vector<glm::uvec2> level_sizes_;
+
+  std::vector<std::vector<float>> levels_;
+};
+
+} // namespace lsg
+
+#endif // LSG_RENDER_OCCLUSION_CULLER_H
@@ -0,0 +1,174 @@
+/**
+ * Project LogiSceneGraph source code
+ * Copyright (C) 2019 Primoz Lavric
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LSG_RENDER_RENDER_LIST_H
+#define LSG_RENDER_RENDER_LIST_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <glm/glm.hpp>
+#include "lsg/core/SceneSnapshot.h"
+#include "lsg/core/ThreadPool.h"
+#include "lsg/materials/Material.h"
+#include "lsg/math/AABB.h"
+#include "lsg/resources/Geometry.h"
+
+namespace lsg {
+
+/**
+ * @brief Single sub-mesh instance to be drawn. Geometry and material are kept alive by the snapshot of the render list.
+ */
+struct DrawItem {
+  /**
+   * World matrix of the object.
+   */
+  glm::mat4 world_matrix;
+
+  const Geometry* geometry;
+
+  const Material* material;
+
+  /**
+   * World space bounds of the geometry.
+   */
+  AABB<float> bounds;
+
+  /**
+   * Index of the object in the snapshot.
+   */
+  uint32_t object;
+
+  /**
+   * Sort key (see RenderList::makeSortKey).
+   */
+  uint64_t key;
+};
+
+/**
+ * @brief Range of consecutive draw items that share the geometry and the material.
+ */
+struct DrawBatch {
+  uint32_t first;
+
+  uint32_t count;
+};
+
+/**
+ * @brief Contiguous list of draw items extracted from a scene snapshot and sorted by material, geometry and depth.
+ *        Items of inactive objects and sub-meshes without geometry are skipped. Render list is reused between frames to
+ *        avoid reallocations.
+ */
+class RenderList {
+ public:
+  static constexpr uint32_t k_depth_key_bits = 16u;
+  static constexpr uint32_t k_geometry_key_bits = 24u;
+  static constexpr uint32_t k_material_key_bits = 64u - k_geometry_key_bits - k_depth_key_bits;
+
+  RenderList() = default;
+
+  RenderList(const RenderList& other) = delete;
+
+  RenderList& operator=(const RenderList& rhs) = delete;
+
+  /**
+   * @brief Extract draw items from the snapshot and sort them. Items are generated in parallel over chunks of the
+   *        snapshot sub-meshes. Since the snapshot is stored in pre-order, each chunk covers a run of whole subtrees.
+   *
+   * @param	snapshot      Compiled scene snapshot.
+   * @param	view_position World space position of the viewer used for the depth part of the key.
+   * @param	executor      Thread pool on which the items are generated.
+   */
+  void extract(std::shared_ptr<const SceneSnapshot> snapshot, const glm::vec3& view_position,
+               ThreadPool& executor = ThreadPool::global());
+
+  /**
+   * @brief   Build the sort key. Material id occupies the highest bits, followed by the geometry id and the squared view
+   *          distance. Ids are truncated to the available bits, so resources whose ids collide are only sorted
+   *          together. Depth uses the upper bits of the float representation, which are monotonic for non negative
+   *          values, so no depth range is required.
+   *
+   * @param	  material  Material.
+   * @param	  geometry  Geometry.
+   * @param	  depth     Squared distance from the viewer.
+   * @return	Sort key.
+   */
+  static uint64_t makeSortKey(const Material* material, const Geometry* geometry, float depth);
+
+  /**
+   * @brief   Retrieve sorted draw items.
+   *
+   * @return	Draw items.
+   */
+  const std::vector<DrawItem>& items() const;
+
+  /**
+   * @brief   Retrieve ranges of items that may be drawn with the same geometry and material bindings.
+   *
+   * @return	Draw batches.
+   */
+  const std::vector<DrawBatch>& batches() const;
+
+  /**
+   * @brief   Retrieve snapshot the items were extracted from.
+   *
+   * @return	Snapshot or nullptr if nothing was extracted.
+   */
+  const std::shared_ptr<const SceneSnapshot>& snapshot() const;
+
+  /**
+   * @brief Remove all items and release the snapshot.
+   */
+  void clear();
+
+  /**
+   * @brief Sort keys and their values with a least significant digit radix sort using 8 bit digits. Passes in which
+   *        all keys share the digit are skipped.
+   *
+   * @param	keys            Keys to be sorted.
+   * @param	values          Values to be reordered together with the keys.
+   * @param	keys_scratch    Scratch buffer for the keys.
+   * @param	values_scratch  Scratch buffer for the values.
+   */
+  static void radixSort(std::vector<uint64_t>& keys, std::vector<uint32_t>& values,
+                        std::vector<uint64_t>& keys_scratch, std::vector<uint32_t>& values_scratch);
+
+ private:
+  std::shared_ptr<const SceneSnapshot> snapshot_;
+
+  std::vector<DrawItem> items_;
+
+  std::vector<DrawBatch> batches_;
+
+  /**
+   * Unsorted items of all sub-meshes of the snapshot.
+   */
+  std::vector<DrawItem> unsorted_items_;
+
+  std::vector<uint64_t> keys_;
+
+  std::vector<uint32_t> indices_;
+
+  std::vector<uint64_t> keys_scratch_;
+
+  std::vector<uint32_t> indices_scratch_;
+};
+
+} // namespace lsg
+
+#endif // LSG_RENDER_RENDER_LIST_H
@@ -20,15 +20,26 @@
 #define LSG_RESOURCES_GEOMETRY_H
 
 #include <array>
+#include <future>
+#include <mutex>
 #include <optional>
+#include "lsg/accelerators/BVH/BVH.h"
+#include "lsg/accelerators/BVH/BVHConfig.h"
+#include "lsg/accelerators/BVH/SAHFunction.h"
 #include "lsg/core/Ref.h"
+#include "lsg/core/VersionTracker.h"
 #include "lsg/math/AABB.h"
 #include "lsg/resources/BufferAccessor.h"
 #include "lsg/resources/Triangle.h"
 
 namespace lsg {
 
-class Geometry : public Identifiable, public RefCounter<Geometry> {
+/**
+ * @brief Geometry vertex data. Version is incremented whenever vertex positions or indices are replaced or cleared.
+ *        If the buffer data is modified in place, incrementVersion must be called manually to invalidate the cached
+ *        BVH.
+ */
+class Geometry : public Identifiable, public RefCounter<Geometry>, public VersionTracker {
  public:
   Geometry();
 
@@ -90,6 +101,18 @@ class Geometry : public Identifiable, public RefCounter<Geometry> {
 
   Ref<TriangleAccessor<glm::vec4>> getTriangleTangentAccessor() const;
 
+  /**
+   * @brief   Retrieve BVH over geometry triangles built with the given configuration. BVH is built on the first request
+   *          and cached until the geometry version or the requested configuration changes. Concurrent requests build
+   *          the BVH only once. Primitive indices are triangle indices.
+   *
+   * @param	  config        BVH builder configuration.
+   * @param	  sah_function  SAH function used by the builder.
+   * @return	Cached BVH.
+   */
+  Ref<BVH<float>> bvh(const bvh::BVHConfig& config = bvh::BVHConfig(),
+                      const bvh::SAHFunction& sah_function = bvh::SAHFunction()) const;
+
  protected:
   template <typename IndexT, typename T>
   class IndexedTriAccessor : public TriangleAccessor<T> {
@@ -163,6 +186,52 @@ class Geometry : public Identifiable, public RefCounter<Geometry> {
    * Bounding box that tightly encapsulates geometry vertices.
    */
   AABB<float> bounding_box_;
+
+  /**
+   * @brief Lazily built BVH. Copies of the geometry start with an empty cache.
+   */
+  struct BVHCache {
+    BVHCache() = default;
+
+    BVHCache(const BVHCache& other);
+
+    BVHCache& operator=(const BVHCache& rhs);
+
+    /**
+     * Guards the cache state. Not held while a BVH is being built.
+     */
+    std::mutex mutex;
+
+    /**
+     * Pending or finished build or invalid if no BVH was requested yet.
+     */
+    std::shared_future<Ref<BVH<float>>> build;
+
+    /**
+     * Incremented whenever a build is started or the cache is cleared.
+     */
+    size_t generation = 0u;
+
+    /**
+     * Geometry version the BVH was built for.
+     */
+    size_t version = 0u;
+
+    /**
+     * Configuration the BVH was built with.
+     */
+    bvh::BVHConfig config;
+
+    /**
+     * SAH function the BVH was built with.
+     */
+    bvh::SAHFunction sah_function;
+  };
+
+  /**
+   * BVH cache.
+   */
+  mutable BVHCache bvh_cache_;
 };
 
 } // namespace lsg
@@ -45,6 +45,10 @@ class SubMesh : public Identifiable, public RefCounter<SubMesh>, public VersionT
    */
   explicit SubMesh(const Ref<Geometry>& geometry, const Ref<Material>& material);
 
+  SubMesh(const SubMesh& other);
+
+  SubMesh& operator=(const SubMesh& other) = delete;
+
   /**
    * @brief Set sub-mesh material.
    *
@@ -73,7 +77,16 @@ class SubMesh : public Identifiable, public RefCounter<SubMesh>, public VersionT
    */
   const Ref<Material>& material() const;
 
+  ~SubMesh() override;
+
  private:
+  /**
+   * @brief Register as dependent of the geometry and material, so their changes are forwarded to the meshes.
+   */
+  void addDependencies();
+
+  void removeDependencies();
+
   /**
    * Sub-mesh geometry
    */
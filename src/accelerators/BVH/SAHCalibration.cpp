@@ -0,0 +1,170 @@
+/**
+ * Project LogiSceneGraph source code
+ * Copyright (C) 2019 Primoz Lavric
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "lsg/accelerators/BVH/SAHCalibration.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include "lsg/core/Exceptions.h"
+#include "lsg/math/AABB.h"
+#include "lsg/math/AABBBatch.h"
+#include "lsg/math/Ray.h"
+
+namespace lsg {
+namespace bvh {
+
+namespace {
+
+/**
+ * Random benchmark working set.
+ */
+struct WorkingSet {
+  std::vector<AABB<float>> boxes;
+  std::vector<glm::vec3> vertices;
+  std::vector<Ray<float>> rays;
+};
+
+WorkingSet generateWorkingSet(const SAHCalibrationConfig& config) {
+  std::mt19937 generator(config.seed);
+  std::uniform_real_distribution<float> position(-1.0f, 1.0f);
+  std::uniform_real_distribution<float> extent(0.01f, 0.2f);
+
+  auto random_point = [&]() { return glm::vec3(position(generator), position(generator), position(generator)); };
+
+  WorkingSet set;
+  set.boxes.reserve(config.num_primitives);
+  set.vertices.reserve(config.num_primitives * 3u);
+
+  for (size_t i = 0u; i < config.num_primitives; i++) {
+    const glm::vec3 a = random_point();
+    const glm::vec3 b = a + glm::vec3(extent(generator), extent(generator), 0.0f);
+    const glm::vec3 c = a + glm::vec3(0.0f, extent(generator), extent(generator));
+
+    set.boxes.emplace_back(a, a + glm::vec3(extent(generator), extent(generator), extent(generator)));
+    set.vertices.insert(set.vertices.end(), {a, b, c});
+  }
+
+  set.rays.reserve(config.num_rays);
+  for (size_t i = 0u; i < config.num_rays; i++) {
+    set.rays.emplace_back(random_point() * 2.0f, random_point() + glm::vec3(1.0e-3f));
+  }
+
+  return set;
+}
+
+/**
+ * @brief   Measures average time of a single test. Every ray runs the given number of tests and the fastest repetition
+ *          is reported.
+ *
+ * @param   test_fn Function invoked as test_fn(ray, index) for index in [0, num_tests) that returns number of hits.
+ * @return  Average time of a single test in nanoseconds.
+ */
+template <typename TestFn>
+double measure(const SAHCalibrationConfig& config, const WorkingSet& set, const size_t num_tests,
+               const TestFn& test_fn) {
+  double best = std::numeric_limits<double>::max();
+  // Consumes the results so that the compiler cannot remove the tests.
+  volatile size_t sink = 0u;
+
+  for (size_t repetition = 0u; repetition < config.num_repetitions; repetition++) {
+    size_t hits = 0u;
+    const auto start = std::chrono::steady_clock::now();
+
+    for (const Ray<float>& ray : set.rays) {
+      for (size_t i = 0u; i < num_tests; i++) {
+        hits += test_fn(ray, i);
+      }
+    }
+
+    const auto end = std::chrono::steady_clock::now();
+    sink = sink + hits;
+
+    const double elapsed = std::chrono::duration<double, std::nano>(end - start).count();
+    best = std::min(best, elapsed / double(set.rays.size() * num_tests));
+  }
+
+  return best;
+}
+
+/**
+ * @brief   Selects the largest node batch size whose batched ray-box test costs at most (1 + tolerance) times a single
+ *          scalar test. Batches are tested with Ray::intersectAABBs over consecutive boxes of the working set.
+ */
+size_t fitNodeBatchSize(const SAHCalibrationConfig& config, const WorkingSet& set, const double single_test_ns) {
+  size_t best_batch_size = 1u;
+  std::vector<uint8_t> hits;
+
+  for (const size_t batch_size : config.batch_sizes) {
+    if (batch_size <= best_batch_size) {
+      continue;
+    }
+
+    std::vector<AABBBatch<float>> batches(std::max<size_t>(set.boxes.size() / batch_size, 1u));
+    for (size_t i = 0u; i < batches.size() * batch_size; i++) {
+      batches[i / batch_size].push(set.boxes[i % set.boxes.size()]);
+    }
+
+    const double batch_test_ns = measure(config, set, batches.size(), [&](const Ray<float>& ray, const size_t index) {
+      ray.intersectAABBs(batches[index], hits);
+      return size_t(std::count(hits.begin(), hits.end(), uint8_t(1u)));
+    });
+
+    if (batch_test_ns <= single_test_ns * (1.0 + config.batch_tolerance)) {
+      best_batch_size = batch_size;
+    }
+  }
+
+  return best_batch_size;
+}
+
+} // namespace
+
+SAHCalibrationResult calibrateSAH(const SAHCalibrationConfig& config, const std::string& name) {
+  throwIf<InvalidArgument>(config.num_primitives == 0u || config.num_rays == 0u || config.num_repetitions == 0u,
+                           "SAH calibration requires non-empty working set and at least one repetition.");
+
+  const WorkingSet set = generateWorkingSet(config);
+
+  auto node_test = [&set](const Ray<float>& ray, const size_t index) {
+    return size_t(ray.intersectAABBDistance(set.boxes[index]).has_value());
+  };
+
+  auto primitive_test = [&set](const Ray<float>& ray, const size_t index) {
+    return size_t(
+      ray.intersectTriangle(set.vertices[index * 3u], set.vertices[index * 3u + 1u], set.vertices[index * 3u + 2u])
+        .has_value());
+  };
+
+  SAHCalibrationResult result;
+  result.node_test_ns = measure(config, set, config.num_primitives, node_test);
+  result.primitive_test_ns = measure(config, set, config.num_primitives, primitive_test);
+
+  const size_t node_batch_size = fitNodeBatchSize(config, set, result.node_test_ns);
+
+  // Costs are relative, so node cost is normalized to one.
+  const float primitive_cost = float(result.primitive_test_ns / std::max(result.node_test_ns, 1.0e-3));
+  result.sah_function = SAHFunction(name, 1.0f, primitive_cost, node_batch_size,
+                                   std::max<size_t>(config.primitive_batch_size, 1u));
+
+  return result;
+}
+
+} // namespace bvh
+} // namespace lsg
@@ -58,5 +58,14 @@ size_t SAHFunction::roundToNodeBatchSize(const size_t n) const {
   return (n + node_batch_size_ - 1) / node_batch_size_;
 }
 
+bool SAHFunction::operator==(const SAHFunction& rhs) const {
+  return node_cost_ == rhs.node_cost_ && primitive_cost_ == rhs.primitive_cost_ &&
+         node_batch_size_ == rhs.node_batch_size_ && primitive_batch_size_ == rhs.primitive_batch_size_;
+}
+
+bool SAHFunction::operator!=(const SAHFunction& rhs) const {
+  return !(*this == rhs);
+}
+
 }
 }
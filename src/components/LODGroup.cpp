@@ -0,0 +1,177 @@
+/**
+ * Project LogiSceneGraph source code
+ * Copyright (C) 2019 Primoz Lavric
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "lsg/components/LODGroup.h"
+#include <algorithm>
+#include <limits>
+#include "lsg/core/Exceptions.h"
+#include "lsg/core/Object.h"
+
+namespace lsg {
+
+LODView LODView::fromCamera(const glm::mat4& projection, const glm::mat4& camera_world) {
+  LODView view;
+  view.position = glm::vec3(camera_world[3]);
+  view.scale = std::abs(projection[1][1]) * 0.5f;
+  view.perspective = projection[3][3] == 0.0f;
+  return view;
+}
+
+LODGroup::LODGroup(Object& owner, std::vector<LODLevel> levels)
+  : LODGroup(owner, "LODGroup", std::move(levels)) {}
+
+LODGroup::LODGroup(Object& owner, const std::string& name, std::vector<LODLevel> levels)
+  : Component(name, owner), max_screen_error_(0.002f), hysteresis_(0.2f) {
+  throwIf<InvalidArgument>(!std::is_sorted(levels.begin(), levels.end(),
+                                           [](const LODLevel& a, const LODLevel& b) {
+                                             return a.geometric_error < b.geometric_error;
+                                           }),
+                           "LOD levels must be ordered by ascending geometric error.");
+
+  for (LODLevel& level : levels) {
+    addLevel(std::move(level.sub_meshes), level.geometric_error);
+  }
+}
+
+void LODGroup::addLevel(std::vector<Ref<SubMesh>> sub_meshes, const float geometric_error) {
+  throwIf<InvalidArgument>(!levels_.empty() && geometric_error < levels_.back().geometric_error,
+                           "LOD levels must be ordered by ascending geometric error.");
+
+  for (const Ref<SubMesh>& sub_mesh : sub_meshes) {
+    sub_mesh->addDependent(*this);
+  }
+  levels_.push_back({std::move(sub_meshes), geometric_error});
+  incrementVersion();
+  owner_.markSubtreeChanged();
+}
+
+size_t LODGroup::levelCount() const {
+  return levels_.size();
+}
+
+const LODLevel& LODGroup::level(const size_t index) const {
+  throwIf<OutOfRange>(index >= levels_.size(), "LOD level index out of range.");
+  return levels_[index];
+}
+
+const std::vector<LODLevel>& LODGroup::levels() const {
+  return levels_;
+}
+
+void LODGroup::setMaxScreenError(const float error) {
+  max_screen_error_ = error;
+}
+
+float LODGroup::maxScreenError() const {
+  return max_screen_error_;
+}
+
+void LODGroup::setHysteresis(const float hysteresis) {
+  throwIf<InvalidArgument>(hysteresis < 0.0f || hysteresis >= 1.0f, "LOD hysteresis must be in range [0, 1).");
+  hysteresis_ = hysteresis;
+}
+
+float LODGroup::hysteresis() const {
+  return hysteresis_;
+}
+
+size_t LODGroup::select(const AABB<float>& world_bounds, const LODView& view, const size_t previous_level) const {
+  if (levels_.empty()) {
+    return 0u;
+  }
+
+  size_t level = std::min(previous_level, levels_.size() - 1u);
+
+  // Refine while the current level is visibly wrong.
+  while (level > 0u && screenError(levels_[level].geometric_error, world_bounds, view) > max_screen_error_) {
+    level--;
+  }
+
+  // Coarsen only while the next level is accurate with a margin.
+  const float coarsen_error = max_screen_error_ * (1.0f - hysteresis_);
+  while (level + 1u < levels_.size() &&
+         screenError(levels_[level + 1u].geometric_error, world_bounds, view) <= coarsen_error) {
+    level++;
+  }
+
+  return level;
+}
+
+float LODGroup::screenError(const float geometric_error, const AABB<float>& world_bounds, const LODView& view) {
+  if (!view.perspective) {
+    return geometric_error * view.scale;
+  }
+  if (!world_bounds.valid()) {
+    return 0.0f;
+  }
+
+  // Distance to the nearest point of the bounds. Views inside the bounds see the error at full size.
+  const glm::vec3 nearest = glm::clamp(view.position, world_bounds.min(), world_bounds.max());
+  const float distance = glm::length(nearest - view.position);
+  if (distance <= 0.0f) {
+    return geometric_error > 0.0f ? std::numeric_limits<float>::infinity() : 0.0f;
+  }
+
+  return geometric_error * view.scale / distance;
+}
+
+AABB<float> LODGroup::localBounds() const {
+  AABB<float> bounds;
+
+  for (const LODLevel& level : levels_) {
+    for (const Ref<SubMesh>& sub_mesh : level.sub_meshes) {
+      if (sub_mesh->geometry() && sub_mesh->geometry()->getBoundingBox().valid()) {
+        bounds.expand(sub_mesh->geometry()->getBoundingBox());
+      }
+    }
+  }
+
+  return bounds;
+}
+
+LODGroup::~LODGroup() {
+  for (const LODLevel& level : levels_) {
+    for (const Ref<SubMesh>& sub_mesh : level.sub_meshes) {
+      sub_mesh->removeDependent(*this);
+    }
+  }
+}
+
+void LODGroup::onDependencyChanged(const VersionTracker& dependency) {
+  owner_.markSubtreeChanged();
+  VersionTracker::onDependencyChanged(dependency);
+}
+
+size_t LODSelection::level(const LODGroup& lod_group) const {
+  const auto it = levels_.find(lod_group.id());
+  return (it != levels_.end()) ? it->second : 0u;
+}
+
+void LODSelection::setLevel(const LODGroup& lod_group, const size_t level) {
+  levels_[lod_group.id()] = level;
+}
+
+size_t LODSelection::size() const {
+  return levels_.size();
+}
+
+void LODSelection::clear() {
+  levels_.clear();
+}
+
+} // namespace lsg
@@ -17,14 +17,25 @@
  */
 
 #include "lsg/components/Mesh.h"
+#include <algorithm>
+#include "lsg/accelerators/BVH/BVHBuilder.h"
+#include "lsg/core/Object.h"
 
 namespace lsg {
 
 Mesh::Mesh(Object& owner, std::vector<Ref<SubMesh>> sub_meshes)
-  : Component("Mesh", owner), sub_meshes_(std::move(sub_meshes)) {}
+  : Component("Mesh", owner), sub_meshes_(std::move(sub_meshes)), occluder_hint_(OccluderHint::kAuto) {
+  for (const auto& sub_mesh : sub_meshes_) {
+    sub_mesh->addDependent(*this);
+  }
+}
 
 Mesh::Mesh(Object& owner, const std::string& name, std::vector<Ref<SubMesh>> sub_meshes)
-  : Component(name, owner), sub_meshes_(std::move(sub_meshes)) {}
+  : Component(name, owner), sub_meshes_(std::move(sub_meshes)), occluder_hint_(OccluderHint::kAuto) {
+  for (const auto& sub_mesh : sub_meshes_) {
+    sub_mesh->addDependent(*this);
+  }
+}
 
 size_t Mesh::subMeshCount() const {
   return sub_meshes_.size();
@@ -32,10 +43,124 @@ size_t Mesh::subMeshCount() const {
 
 void Mesh::addSubMesh(const Ref<SubMesh>& sub_mesh) {
   sub_meshes_.emplace_back(sub_mesh);
+  sub_mesh->addDependent(*this);
+  incrementVersion();
+  owner_.markSubtreeChanged();
 }
 
-const std::vector<Ref<SubMesh>>& Mesh::subMeshes() {
+const std::vector<Ref<SubMesh>>& Mesh::subMeshes() const {
   return sub_meshes_;
 }
 
+void Mesh::setOccluderHint(const OccluderHint hint) {
+  occluder_hint_ = hint;
+}
+
+OccluderHint Mesh::occluderHint() const {
+  return occluder_hint_;
+}
+
+Ref<BVH<float>> Mesh::bvh(const bvh::BVHConfig& config, const bvh::SAHFunction& sah_function) const {
+  throwIf<OutOfRange>(sub_meshes_.size() > (size_t(1u) << k_sub_mesh_index_bits),
+                      "Mesh BVH supports at most " + std::to_string(size_t(1u) << k_sub_mesh_index_bits) +
+                        " sub-meshes.");
+
+  // Collect versions of everything the BVH depends on. The first entry holds the mesh version. Geometries are
+  // referenced, so that a new geometry cannot be allocated at the address of a cached one.
+  std::vector<std::pair<Ref<Geometry>, size_t>> versions;
+  versions.reserve(sub_meshes_.size() + 1u);
+  versions.emplace_back(nullptr, version());
+
+  for (const Ref<SubMesh>& sub_mesh : sub_meshes_) {
+    const Ref<Geometry>& geometry = sub_mesh->geometry();
+    versions.emplace_back(geometry, geometry ? geometry->version() : 0u);
+  }
+
+  // Build under the lock so that concurrent first requests wait for a single build.
+  std::lock_guard<std::mutex> lock(bvh_mutex_);
+
+  const bool versions_match = std::equal(versions.begin(), versions.end(), bvh_versions_.begin(), bvh_versions_.end(),
+                                         [](const auto& lhs, const auto& rhs) {
+                                           return lhs.first.get() == rhs.first.get() && lhs.second == rhs.second;
+                                         });
+  if (bvh_ && versions_match && bvh_config_ == config && bvh_sah_function_ == sah_function) {
+    return bvh_;
+  }
+
+  // Generate triangle bounds of all sub-meshes and remember where each sub-mesh starts.
+  std::vector<AABB<float>> bounds;
+  std::vector<uint32_t> prim_indices;
+
+  for (size_t i = 0; i < sub_meshes_.size(); i++) {
+    const Ref<Geometry>& geometry = sub_meshes_[i]->geometry();
+    if (!geometry || !geometry->hasVertices()) {
+      continue;
+    }
+
+    Ref<TriangleAccessor<glm::vec3>> triangles = geometry->getTrianglePositionAccessor();
+
+    for (size_t j = 0; j < triangles->count(); j++) {
+      Triangle<glm::vec3> triangle = (*triangles)[j];
+      AABB<float>& triangle_bounds = bounds.emplace_back();
+      triangle_bounds.expand(triangle[0]);
+      triangle_bounds.expand(triangle[1]);
+      triangle_bounds.expand(triangle[2]);
+      prim_indices.emplace_back(encodePrimitiveIndex(i, j));
+    }
+  }
+
+  // Replace positions in the bounds vector with encoded primitive indices.
+  bvh::BVHBuilder<float> builder(sah_function, config);
+  Ref<BVH<float>> built = builder.process(bounds);
+  std::vector<uint32_t> encoded_indices(built->getPrimitiveIndices());
+
+  for (uint32_t& index : encoded_indices) {
+    index = prim_indices[index];
+  }
+
+  bvh_ = makeRef<BVH<float>>(built->getNodes(), std::move(encoded_indices));
+  bvh_versions_ = std::move(versions);
+  bvh_config_ = config;
+  bvh_sah_function_ = sah_function;
+
+  return bvh_;
+}
+
+AABB<float> Mesh::localBounds() const {
+  AABB<float> bounds;
+
+  for (const Ref<SubMesh>& sub_mesh : sub_meshes_) {
+    if (sub_mesh->geometry() && sub_mesh->geometry()->getBoundingBox().valid()) {
+      bounds.expand(sub_mesh->geometry()->getBoundingBox());
+    }
+  }
+
+  return bounds;
+}
+
+Mesh::~Mesh() {
+  for (const auto& sub_mesh : sub_meshes_) {
+    sub_mesh->removeDependent(*this);
+  }
+}
+
+void Mesh::onDependencyChanged(const VersionTracker& dependency) {
+  owner_.markSubtreeChanged();
+  VersionTracker::onDependencyChanged(dependency);
+}
+
+uint32_t Mesh::encodePrimitiveIndex(const size_t sub_mesh_index, const size_t triangle_index) {
+  throwIf<OutOfRange>(triangle_index >= (size_t(1u) << k_triangle_index_bits),
+                      "Triangle index (" + std::to_string(triangle_index) + ") cannot be encoded in mesh BVH.");
+  return static_cast<uint32_t>((sub_mesh_index << k_triangle_index_bits) | triangle_index);
+}
+
+size_t Mesh::subMeshIndex(const uint32_t prim_index) {
+  return prim_index >> k_triangle_index_bits;
+}
+
+size_t Mesh::triangleIndex(const uint32_t prim_index) {
+  return prim_index & ((1u << k_triangle_index_bits) - 1u);
+}
+
 } // namespace lsg
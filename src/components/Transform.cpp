@@ -23,97 +23,104 @@
 namespace lsg {
 
 Transform::Transform(Object& owner)
-  : Component("Transform", owner), world_matrix_(1.0), world_matrix_dirty_(false), loc_matrix_(1.0),
-    loc_matrix_dirty_(false), loc_position_(), loc_rotation_(), loc_scale_(1.0f) {
-  // Traverse ancestors.
-  owner_.traverseUpExcl([this](const Ref<Object>& object) {
-    const auto transform = object->getComponent<Transform>();
-
-    // Check if the ancestor has transform component.
-    if (transform) {
-      if (transform->world_matrix_dirty_) {
-        this->markWorldMatrixDirty();
-      } else {
-        world_matrix_ = world_matrix_ * loc_matrix_;
-      }
-
-      return false;
-    }
-
-    return true;
-  });
+  : Component("Transform", owner), system_(TransformSystem::of(owner)), slot_(system_->create(*this)) {}
 
-  // When the parent changes mark the world matrix dirty.
-  owner_.setOnParentChangeCallback(*this, [this](const Ref<Object>&) { this->markWorldMatrixDirty(); });
+Transform::~Transform() {
+  system_->destroy(slot_);
 }
 
 const glm::mat4x4& Transform::matrix() {
-  if (loc_matrix_dirty_) {
-    composeMatrix(loc_matrix_, loc_position_, loc_rotation_, loc_scale_);
+  const uint32_t index = system_->index(slot_);
+
+  if (TransformSystem::testBit(system_->local_dirty_, index)) {
+    composeMatrix(system_->local_matrices_[index], system_->positions_[index], system_->rotations_[index],
+                  system_->scales_[index]);
+    // The world matrix must still be recomputed by the system.
+    TransformSystem::clearBit(system_->local_dirty_, index);
+    system_->markWorldDirty(slot_);
   }
 
-  return loc_matrix_;
+  return system_->local_matrices_[index];
 }
 
 const glm::mat4x4& Transform::worldMatrix() {
-  if (world_matrix_dirty_) {
-    updateWorldMatrix();
+  if (system_->needsUpdate()) {
+    system_->update();
+  }
+
+  return system_->world_matrices_[system_->index(slot_)];
+}
+
+const glm::mat4x4& Transform::worldMatrix() const {
+  return system_->world_matrices_[system_->index(slot_)];
+}
+
+uint64_t Transform::worldVersion() {
+  if (system_->needsUpdate()) {
+    system_->update();
   }
 
-  return world_matrix_;
+  return system_->world_versions_[system_->index(slot_)];
+}
+
+uint64_t Transform::worldVersion() const {
+  return system_->world_versions_[system_->index(slot_)];
 }
 
 const glm::vec3& Transform::position() const {
-  return loc_position_;
+  return system_->positions_[system_->index(slot_)];
 }
 
 const glm::quat& Transform::rotation() const {
-  return loc_rotation_;
+  return system_->rotations_[system_->index(slot_)];
 }
 
 glm::vec3 Transform::eulerRotation() const {
-  return glm::eulerAngles(loc_rotation_);
+  return glm::eulerAngles(rotation());
 }
 
 const glm::vec3& Transform::scale() const {
-  return loc_scale_;
+  return system_->scales_[system_->index(slot_)];
 }
 
 void Transform::applyMatrix(const glm::mat4& mat) {
-  loc_matrix_ = mat * matrix();
-  decomposeMatrix(loc_matrix_, loc_position_, loc_rotation_, loc_scale_);
-  markWorldMatrixDirty();
+  setLocalMatrix(mat * matrix());
 }
 
 void Transform::applyQuaternion(const glm::quat& quaternion) {
-  loc_rotation_ *= quaternion;
+  system_->rotations_[system_->index(slot_)] *= quaternion;
   markLocalMatrixDirty();
 }
 
 void Transform::setLocalMatrix(const glm::mat4& mat) {
-  loc_matrix_ = mat;
-  decomposeMatrix(loc_matrix_, loc_position_, loc_rotation_, loc_scale_);
+  const uint32_t index = system_->index(slot_);
+  system_->local_matrices_[index] = mat;
+  decomposeMatrix(mat, system_->positions_[index], system_->rotations_[index], system_->scales_[index]);
+
+  // Matrix was set directly, so it must not be recomposed from the decomposed values.
+  TransformSystem::clearBit(system_->local_dirty_, index);
   markWorldMatrixDirty();
+  owner_.markSubtreeChanged();
 }
 
 void Transform::setRotation(const glm::quat& quaternion) {
-  loc_rotation_ = quaternion;
+  system_->rotations_[system_->index(slot_)] = quaternion;
   markLocalMatrixDirty();
 }
 
 void Transform::setScale(const glm::vec3& scale) {
-  loc_scale_ = scale;
+  system_->scales_[system_->index(slot_)] = scale;
   markLocalMatrixDirty();
 }
 
 void Transform::setPosition(const glm::vec3& position) {
-  loc_position_ = position;
+  system_->positions_[system_->index(slot_)] = position;
   markLocalMatrixDirty();
 }
 
 void Transform::translateOnAxis(const glm::vec3& axis, const float distance) {
-  const glm::vec3 loc_axis = loc_rotation_ * axis;
-  setPosition(loc_position_ + (loc_axis * distance));
+  const glm::vec3 loc_axis = rotation() * axis;
+  setPosition(position() + (loc_axis * distance));
 }
 
 void Transform::translateX(const float distance) {
@@ -133,7 +140,7 @@ void Transform::translateZ(const float distance) {
 
 void Transform::rotateOnAxis(const glm::vec3& axis, const float angle) {
   const auto quaternion = glm::quat(axis * angle);
-  loc_rotation_ *= quaternion;
+  system_->rotations_[system_->index(slot_)] *= quaternion;
   markLocalMatrixDirty();
 }
 
@@ -153,55 +160,42 @@ void Transform::rotateZ(const float angle) {
 }
 
 void Transform::updateWorldMatrix() {
-  // Do not update world matrix if not dirty.
-  if (!world_matrix_dirty_) {
-    return;
-  }
-
-  Ref<Transform> transform;
-  // Find first ancestor with transform.
-  owner_.traverseUpExcl([this, &transform](const Ref<Object>& object) {
-    transform = object->getComponent<Transform>();
-    return !static_cast<bool>(transform);
-  });
-
-  // Update ancestor transform and compute the world matrix.
-  if (transform) {
-    transform->updateWorldMatrix();
-    world_matrix_ = transform->world_matrix_ * matrix();
-  } else {
-    world_matrix_ = matrix();
-  }
-
-  world_matrix_dirty_ = false;
+  system_->update();
 }
 
 void Transform::markLocalMatrixDirty() {
-  loc_matrix_dirty_ = true;
-  markWorldMatrixDirty();
+  system_->markLocalDirty(slot_);
+  owner_.markSubtreeChanged();
 }
 
 void Transform::markWorldMatrixDirty() {
-  // Don't do anything if the matrix is already marked as dirty.
-  if (world_matrix_dirty_) {
-    return;
+  system_->markWorldDirty(slot_);
+}
+
+void Transform::onHierarchyChanged() {
+  std::shared_ptr<TransformSystem> system = TransformSystem::of(owner_);
+
+  if (system == system_) {
+    // Nearest ancestor transform may have changed.
+    system_->markStructureDirty();
+  } else {
+    slot_ = system->adopt(*system_, slot_);
+    system_ = std::move(system);
   }
+}
 
-  world_matrix_dirty_ = true;
-  // Mark all child objects world matrices as dirty.
-  owner_.traverseDownExcl([](const Ref<Object>& object) {
-    const Ref<Transform>& transform = object->getComponent<Transform>();
-    if (transform) {
-      transform->world_matrix_dirty_ = true;
-    }
+bool Transform::isWorldMatrixDirty() const {
+  return system_->isWorldDirty(slot_);
+}
 
-    // Descend.
-    return true;
+Transform* Transform::findParentTransform() const {
+  Transform* transform = nullptr;
+  owner_.traverseUpExcl([&](Object& object) {
+    transform = object.findComponent<Transform>();
+    return transform == nullptr;
   });
-}
 
-bool Transform::isWorldMatrixDirty() {
-  return world_matrix_dirty_;
+  return transform;
 }
 
 } // namespace lsg
@@ -0,0 +1,320 @@
+/**
+ * Project LogiSceneGraph source code
+ * Copyright (C) 2019 Primoz Lavric
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "lsg/components/TransformSystem.h"
+#include <algorithm>
+#include "lsg/components/Transform.h"
+#include "lsg/core/Math.h"
+#include "lsg/core/Object.h"
+
+namespace lsg {
+
+std::shared_ptr<TransformSystem> TransformSystem::of(Object& object) {
+  Object* root = &object;
+  while (root->parent_ != nullptr) {
+    root = root->parent_;
+  }
+
+  if (root->transform_system_ == nullptr) {
+    root->transform_system_ = std::make_shared<TransformSystem>();
+  }
+
+  return root->transform_system_;
+}
+
+void TransformSystem::update() {
+  if (beginUpdate()) {
+    updateRange(0u, slots_.size());
+    endUpdate();
+  }
+}
+
+void TransformSystem::update(ThreadPool& pool, const size_t chunk_size) {
+  if (!beginUpdate()) {
+    return;
+  }
+
+  // Entries of the same depth level are independent of each other.
+  for (size_t level = 0u; level + 1u < depth_offsets_.size(); level++) {
+    const size_t begin = depth_offsets_[level];
+    const size_t count = depth_offsets_[level + 1u] - begin;
+
+    if (count <= chunk_size) {
+      updateRange(begin, begin + count);
+    } else {
+      pool.parallelFor(count, chunk_size, [this, begin](const size_t chunk_begin, const size_t chunk_end, size_t) {
+        updateRange(begin + chunk_begin, begin + chunk_end);
+      });
+    }
+  }
+
+  endUpdate();
+}
+
+bool TransformSystem::beginUpdate() {
+  if (!needsUpdate()) {
+    return false;
+  }
+
+  if (structure_dirty_) {
+    rebuild();
+  }
+
+  update_counter_++;
+  return true;
+}
+
+void TransformSystem::endUpdate() {
+  std::fill(local_dirty_.begin(), local_dirty_.end(), 0u);
+  std::fill(world_dirty_.begin(), world_dirty_.end(), 0u);
+  dirty_ = false;
+}
+
+bool TransformSystem::needsUpdate() const {
+  return dirty_ || structure_dirty_;
+}
+
+size_t TransformSystem::size() const {
+  return size_;
+}
+
+uint32_t TransformSystem::create(Transform& transform) {
+  uint32_t slot;
+
+  if (free_slots_.empty()) {
+    slot = static_cast<uint32_t>(slot_transforms_.size());
+    slot_transforms_.emplace_back(&transform);
+    slot_indices_.emplace_back();
+  } else {
+    slot = free_slots_.back();
+    free_slots_.pop_back();
+    slot_transforms_[slot] = &transform;
+  }
+
+  // Append the entry. It is moved to the correct depth on the next rebuild.
+  const uint32_t index = static_cast<uint32_t>(slots_.size());
+  slot_indices_[slot] = index;
+  slots_.emplace_back(slot);
+  positions_.emplace_back(0.0f);
+  rotations_.emplace_back(glm::vec3(0.0f));
+  scales_.emplace_back(1.0f);
+  local_matrices_.emplace_back(1.0f);
+  world_matrices_.emplace_back(1.0f);
+  parents_.emplace_back(k_no_parent);
+  world_versions_.emplace_back(0u);
+
+  local_dirty_.resize((slots_.size() + 63u) / 64u, 0u);
+  world_dirty_.resize(local_dirty_.size(), 0u);
+  setBit(world_dirty_, index);
+
+  size_++;
+  dirty_ = true;
+  structure_dirty_ = true;
+  return slot;
+}
+
+void TransformSystem::destroy(const uint32_t slot) {
+  // Entry is dropped on the next rebuild.
+  slot_transforms_[slot] = nullptr;
+  free_slots_.emplace_back(slot);
+  size_--;
+  structure_dirty_ = true;
+}
+
+uint32_t TransformSystem::adopt(TransformSystem& source, const uint32_t source_slot) {
+  const uint32_t source_index = source.slot_indices_[source_slot];
+  const uint32_t slot = create(*source.slot_transforms_[source_slot]);
+  const uint32_t index = slot_indices_[slot];
+
+  positions_[index] = source.positions_[source_index];
+  rotations_[index] = source.rotations_[source_index];
+  scales_[index] = source.scales_[source_index];
+  local_matrices_[index] = source.local_matrices_[source_index];
+  if (testBit(source.local_dirty_, source_index)) {
+    setBit(local_dirty_, index);
+  }
+
+  source.destroy(source_slot);
+  return slot;
+}
+
+void TransformSystem::markStructureDirty() {
+  structure_dirty_ = true;
+}
+
+uint32_t TransformSystem::index(const uint32_t slot) const {
+  return slot_indices_[slot];
+}
+
+void TransformSystem::markLocalDirty(const uint32_t slot) {
+  setBit(local_dirty_, slot_indices_[slot]);
+  dirty_ = true;
+}
+
+void TransformSystem::markWorldDirty(const uint32_t slot) {
+  setBit(world_dirty_, slot_indices_[slot]);
+  dirty_ = true;
+}
+
+bool TransformSystem::isWorldDirty(const uint32_t slot) const {
+  if (structure_dirty_) {
+    return true;
+  }
+
+  for (uint32_t i = slot_indices_[slot]; i != k_no_parent; i = parents_[i]) {
+    if (testBit(local_dirty_, i) || testBit(world_dirty_, i)) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void TransformSystem::rebuild() {
+  const uint32_t num_slots = static_cast<uint32_t>(slot_transforms_.size());
+  constexpr uint32_t k_unknown = std::numeric_limits<uint32_t>::max();
+
+  // Resolve parent slots. This is the only place where the object hierarchy is walked.
+  std::vector<uint32_t> parent_slots(num_slots, k_no_parent);
+  std::vector<uint32_t> depths(num_slots, k_unknown);
+
+  for (uint32_t slot = 0; slot < num_slots; slot++) {
+    if (slot_transforms_[slot] != nullptr) {
+      Transform* parent = slot_transforms_[slot]->findParentTransform();
+      parent_slots[slot] = (parent != nullptr) ? parent->slot_ : k_no_parent;
+    }
+  }
+
+  // Compute depths by walking up until a known depth is reached.
+  std::vector<uint32_t> chain;
+  uint32_t max_depth = 0u;
+
+  for (uint32_t slot = 0; slot < num_slots; slot++) {
+    if (slot_transforms_[slot] == nullptr || depths[slot] != k_unknown) {
+      continue;
+    }
+
+    chain.clear();
+    uint32_t current = slot;
+    while (current != k_no_parent && depths[current] == k_unknown) {
+      chain.emplace_back(current);
+      current = parent_slots[current];
+    }
+
+    uint32_t depth = (current == k_no_parent) ? 0u : depths[current] + 1u;
+    for (auto it = chain.rbegin(); it != chain.rend(); it++) {
+      depths[*it] = depth++;
+    }
+    max_depth = std::max(max_depth, depth - 1u);
+  }
+
+  // Counting sort of live slots by depth.
+  depth_offsets_.assign(size_ > 0u ? max_depth + 2u : 1u, 0u);
+  for (uint32_t slot = 0; slot < num_slots; slot++) {
+    if (slot_transforms_[slot] != nullptr) {
+      depth_offsets_[depths[slot] + 1u]++;
+    }
+  }
+  for (size_t i = 1u; i < depth_offsets_.size(); i++) {
+    depth_offsets_[i] += depth_offsets_[i - 1u];
+  }
+
+  std::vector<uint32_t> order(size_);
+  std::vector<uint32_t> cursor(depth_offsets_.begin(), depth_offsets_.end() - 1);
+  for (uint32_t slot = 0; slot < num_slots; slot++) {
+    if (slot_transforms_[slot] != nullptr) {
+      order[cursor[depths[slot]]++] = slot;
+    }
+  }
+
+  // Gather entry data in the new order.
+  auto gather = [&order, this](auto& data) {
+    std::remove_reference_t<decltype(data)> sorted;
+    sorted.reserve(order.size());
+    for (const uint32_t slot : order) {
+      sorted.emplace_back(data[slot_indices_[slot]]);
+    }
+    data.swap(sorted);
+  };
+
+  gather(positions_);
+  gather(rotations_);
+  gather(scales_);
+  gather(local_matrices_);
+  gather(world_matrices_);
+  gather(world_versions_);
+
+  std::vector<uint64_t> local_dirty((order.size() + 63u) / 64u, 0u);
+  for (uint32_t i = 0; i < order.size(); i++) {
+    if (testBit(local_dirty_, slot_indices_[order[i]])) {
+      setBit(local_dirty, i);
+    }
+  }
+  local_dirty_.swap(local_dirty);
+
+  // Parent relations may have changed, so all world matrices must be recomputed.
+  world_dirty_.assign(local_dirty_.size(), ~uint64_t(0u));
+
+  slots_ = order;
+  for (uint32_t i = 0; i < order.size(); i++) {
+    slot_indices_[order[i]] = i;
+  }
+
+  parents_.resize(order.size());
+  for (uint32_t i = 0; i < order.size(); i++) {
+    const uint32_t parent_slot = parent_slots[order[i]];
+    parents_[i] = (parent_slot != k_no_parent) ? slot_indices_[parent_slot] : k_no_parent;
+  }
+
+  structure_dirty_ = false;
+  dirty_ = true;
+}
+
+void TransformSystem::updateRange(const size_t begin, const size_t end) {
+  for (size_t i = begin; i < end; i++) {
+    const bool local_dirty = testBit(local_dirty_, i);
+    if (local_dirty) {
+      composeMatrix(local_matrices_[i], positions_[i], rotations_[i], scales_[i]);
+    }
+
+    // Parents precede children, so the parent was already processed. If it was recomputed in this update, its world
+    // version equals the update counter. Dirty bits are only read here, which keeps the ranges independent.
+    const uint32_t parent = parents_[i];
+    const bool parent_changed = parent != k_no_parent && world_versions_[parent] == update_counter_;
+
+    if (local_dirty || parent_changed || testBit(world_dirty_, i)) {
+      world_matrices_[i] =
+        (parent != k_no_parent) ? world_matrices_[parent] * local_matrices_[i] : local_matrices_[i];
+      world_versions_[i] = update_counter_;
+    }
+  }
+}
+
+bool TransformSystem::testBit(const std::vector<uint64_t>& bits, const size_t index) {
+  return (bits[index / 64u] >> (index % 64u)) & 1u;
+}
+
+void TransformSystem::setBit(std::vector<uint64_t>& bits, const size_t index) {
+  bits[index / 64u] |= uint64_t(1u) << (index % 64u);
+}
+
+void TransformSystem::clearBit(std::vector<uint64_t>& bits, const size_t index) {
+  bits[index / 64u] &= ~(uint64_t(1u) << (index % 64u));
+}
+
+} // namespace lsg
@@ -0,0 +1,131 @@
+/**
+ * Project LogiSceneGraph source code
+ * Copyright (C) 2019 Primoz Lavric
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "lsg/core/ChangeJournal.h"
+#include <algorithm>
+#include "lsg/core/Object.h"
+#include "lsg/core/VersionTracker.h"
+
+namespace lsg {
+
+std::atomic<size_t> ChangeJournal::num_enabled_ = 0u;
+std::mutex ChangeJournal::journals_mutex_;
+std::vector<ChangeJournal*> ChangeJournal::journals_;
+
+ChangeJournal::ChangeJournal(const size_t capacity, const Object* owner)
+  : capacity_(std::max<size_t>(capacity, 1u)), owner_(owner), enabled_(false), begin_(0u) {}
+
+void ChangeJournal::setEnabled(const bool enabled) {
+  // Released after the locks, since changes may hold last references to objects.
+  std::deque<Change> released;
+  std::lock_guard<std::mutex> journals_lock(journals_mutex_);
+  if (enabled_ == enabled) {
+    return;
+  }
+
+  if (enabled) {
+    journals_.emplace_back(this);
+    num_enabled_++;
+  } else {
+    journals_.erase(std::find(journals_.begin(), journals_.end(), this));
+    num_enabled_--;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    begin_ += changes_.size();
+    released.swap(changes_);
+  }
+
+  enabled_ = enabled;
+}
+
+bool ChangeJournal::isEnabled() const {
+  return enabled_.load(std::memory_order_relaxed);
+}
+
+ChangeJournal::Cursor ChangeJournal::head() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return begin_ + changes_.size();
+}
+
+ChangeJournal::ReadResult ChangeJournal::read(Cursor& cursor, std::vector<Change>& changes) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const Cursor head = begin_ + changes_.size();
+  ReadResult result {true, 0u};
+
+  if (cursor < begin_ || cursor > head) {
+    // Changes were dropped, consumer must resynchronise.
+    result.complete = false;
+  } else {
+    changes.insert(changes.end(), changes_.begin() + static_cast<ptrdiff_t>(cursor - begin_), changes_.end());
+    result.count = head - cursor;
+  }
+
+  cursor = head;
+  return result;
+}
+
+void ChangeJournal::record(const ChangeType type, Object* object, Object* parent, Component* component) {
+  if (!isEnabled()) {
+    return;
+  }
+
+  Change change;
+  change.type = type;
+  change.object = object;
+  if (object != owner_) {
+    change.object_ref = object;
+  }
+  change.parent = parent;
+  change.component = component;
+
+  std::vector<Change> dropped;
+  append(std::move(change), dropped);
+}
+
+void ChangeJournal::recordResourceChange(const VersionTracker& resource) {
+  if (num_enabled_.load(std::memory_order_relaxed) == 0u) {
+    return;
+  }
+
+  std::vector<Change> dropped;
+  std::lock_guard<std::mutex> journals_lock(journals_mutex_);
+  for (ChangeJournal* journal : journals_) {
+    Change change;
+    change.type = ChangeType::kResourceChanged;
+    change.resource = &resource;
+    change.version = resource.version();
+    journal->append(std::move(change), dropped);
+  }
+}
+
+void ChangeJournal::append(Change&& change, std::vector<Change>& dropped) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (changes_.size() == capacity_) {
+    dropped.emplace_back(std::move(changes_.front()));
+    changes_.pop_front();
+    begin_++;
+  }
+
+  changes_.emplace_back(std::move(change));
+}
+
+ChangeJournal::~ChangeJournal() {
+  setEnabled(false);
+}
+
+} // namespace lsg
@@ -17,10 +17,32 @@
  */
 
 #include "lsg/core/Component.h"
+#include <algorithm>
+#include <atomic>
 
 namespace lsg {
 
-Component::Component(const std::string& name, Object& owner) : Identifiable(name), owner_(owner) {}
+Component::Component(const std::string& name, Object& owner)
+  : Identifiable(name), owner_(owner), type_id_(k_invalid_type_id), type_ids_(nullptr) {}
+
+ComponentTypeId Component::typeId() const {
+  return type_id_;
+}
+
+bool Component::hasTypeId(const ComponentTypeId type_id) const {
+  return type_ids_ != nullptr && std::find(type_ids_->begin(), type_ids_->end(), type_id) != type_ids_->end();
+}
+
+ComponentTypeId Component::nextTypeId() {
+  static std::atomic<ComponentTypeId> next_type_id = 0u;
+  return next_type_id.fetch_add(1u, std::memory_order_relaxed);
+}
+
+AABB<float> Component::localBounds() const {
+  return AABB<float>();
+}
+
+void Component::onHierarchyChanged() {}
 
 Component::~Component() = default;
 
@@ -0,0 +1,93 @@
+/**
+ * Project LogiSceneGraph source code
+ * Copyright (C) 2019 Primoz Lavric
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "lsg/core/ComponentRegistry.h"
+
+namespace lsg {
+
+Entity ComponentRegistry::createEntity(Object& object) {
+  Entity entity;
+  if (!free_entities_.empty()) {
+    entity = free_entities_.back();
+    free_entities_.pop_back();
+    objects_[entity] = &object;
+  } else {
+    entity = static_cast<Entity>(objects_.size());
+    objects_.emplace_back(&object);
+  }
+
+  return entity;
+}
+
+void ComponentRegistry::destroyEntity(const Entity entity) {
+  for (Pool& type_pool : pools_) {
+    if (entity >= type_pool.sparse.size() || type_pool.sparse[entity] == Pool::k_invalid_index) {
+      continue;
+    }
+
+    // Swap remove to keep the pool dense.
+    const uint32_t index = type_pool.sparse[entity];
+    const Entity last_entity = type_pool.entities.back();
+    type_pool.entities[index] = last_entity;
+    type_pool.components[index] = type_pool.components.back();
+    type_pool.sparse[last_entity] = index;
+    type_pool.entities.pop_back();
+    type_pool.components.pop_back();
+    type_pool.sparse[entity] = Pool::k_invalid_index;
+  }
+
+  objects_[entity] = nullptr;
+  free_entities_.emplace_back(entity);
+}
+
+void ComponentRegistry::addComponent(const Entity entity, Component* component) {
+  const ComponentTypeId type_id = component->typeId();
+  if (type_id == Component::k_invalid_type_id) {
+    return;
+  }
+
+  if (type_id >= pools_.size()) {
+    pools_.resize(type_id + 1u);
+  }
+
+  Pool& type_pool = pools_[type_id];
+  if (entity >= type_pool.sparse.size()) {
+    type_pool.sparse.resize(objects_.size(), Pool::k_invalid_index);
+  }
+  if (type_pool.sparse[entity] != Pool::k_invalid_index) {
+    return;
+  }
+
+  type_pool.sparse[entity] = static_cast<uint32_t>(type_pool.entities.size());
+  type_pool.entities.emplace_back(entity);
+  type_pool.components.emplace_back(component);
+}
+
+Object& ComponentRegistry::object(const Entity entity) const {
+  return *objects_[entity];
+}
+
+size_t ComponentRegistry::numEntities() const {
+  return objects_.size() - free_entities_.size();
+}
+
+const ComponentRegistry::Pool* ComponentRegistry::pool(const ComponentTypeId type_id) const {
+  return (type_id < pools_.size()) ? &pools_[type_id] : nullptr;
+}
+
+} // namespace lsg
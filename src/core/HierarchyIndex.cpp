@@ -0,0 +1,109 @@
+/**
+ * Project LogiSceneGraph source code
+ * Copyright (C) 2019 Primoz Lavric
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "lsg/core/HierarchyIndex.h"
+#include <functional>
+#include "lsg/core/Object.h"
+
+namespace lsg {
+
+void HierarchyIndex::insert(Object& object) {
+  Entry& entry = object.index_entry_;
+  const size_t parent_hash = (object.parent_ != nullptr) ? object.parent_->index_entry_.path_hash : 0u;
+  entry.path_hash = combinePathHash(parent_hash, object.name());
+
+  std::vector<Object*>& name_bucket = names_[hashName(object.name())];
+  entry.name_slot = static_cast<uint32_t>(name_bucket.size());
+  name_bucket.emplace_back(&object);
+
+  std::vector<Object*>& path_bucket = paths_[entry.path_hash];
+  entry.path_slot = static_cast<uint32_t>(path_bucket.size());
+  path_bucket.emplace_back(&object);
+}
+
+void HierarchyIndex::erase(Object& object) {
+  Entry& entry = object.index_entry_;
+  if (entry.name_slot == k_invalid_slot) {
+    return;
+  }
+
+  removeFromBucket(names_, hashName(object.name()), entry.name_slot, &Entry::name_slot);
+  removeFromBucket(paths_, entry.path_hash, entry.path_slot, &Entry::path_slot);
+  entry = Entry();
+}
+
+const std::vector<Object*>* HierarchyIndex::nameCandidates(std::string_view name) const {
+  auto it = names_.find(hashName(name));
+  return (it != names_.end()) ? &it->second : nullptr;
+}
+
+const std::vector<Object*>* HierarchyIndex::pathCandidates(const size_t path_hash) const {
+  auto it = paths_.find(path_hash);
+  return (it != paths_.end()) ? &it->second : nullptr;
+}
+
+const std::vector<Object*>* HierarchyIndex::candidates(std::string_view hierarchy_path) const {
+  if (!hierarchy_path.empty() && hierarchy_path.front() == '/') {
+    return pathCandidates(hashAbsolutePath(hierarchy_path));
+  }
+
+  const size_t separator = hierarchy_path.rfind('/');
+  return nameCandidates((separator != std::string_view::npos) ? hierarchy_path.substr(separator + 1u) : hierarchy_path);
+}
+
+size_t HierarchyIndex::combinePathHash(const size_t parent_hash, std::string_view name) {
+  return parent_hash ^ (hashName(name) + 0x9e3779b97f4a7c15ull + (parent_hash << 6u) + (parent_hash >> 2u));
+}
+
+size_t HierarchyIndex::hashAbsolutePath(std::string_view hierarchy_path) {
+  size_t hash = 0u;
+  size_t begin = 1u;
+
+  while (begin <= hierarchy_path.size()) {
+    size_t end = hierarchy_path.find('/', begin);
+    if (end == std::string_view::npos) {
+      end = hierarchy_path.size();
+    }
+
+    hash = combinePathHash(hash, hierarchy_path.substr(begin, end - begin));
+    begin = end + 1u;
+  }
+
+  return hash;
+}
+
+size_t HierarchyIndex::hashName(std::string_view name) {
+  return std::hash<std::string_view>()(name);
+}
+
+void HierarchyIndex::removeFromBucket(std::unordered_map<size_t, std::vector<Object*>>& buckets, const size_t key,
+                                      const uint32_t slot, uint32_t Entry::*slot_member) {
+  auto it = buckets.find(key);
+  std::vector<Object*>& bucket = it->second;
+
+  // Swap remove and patch the slot of the moved object.
+  bucket[slot] = bucket.back();
+  bucket[slot]->index_entry_.*slot_member = slot;
+  bucket.pop_back();
+
+  if (bucket.empty()) {
+    buckets.erase(it);
+  }
+}
+
+} // namespace lsg
@@ -17,15 +17,28 @@
  */
 
 #include "lsg/core/Object.h"
+#include <algorithm>
 #include <utility>
+#include "lsg/components/Transform.h"
+#include "lsg/core/Scene.h"
 
 namespace lsg {
 
+std::atomic<uint64_t> Object::version_clock_ = 1u;
+
 Object::Object(std::string name, const bool active)
-  : Identifiable(std::move(name)), active_(active), parent_(nullptr) {}
+  : Identifiable(std::move(name)),
+    active_(active),
+    parent_(nullptr),
+    scene_(nullptr),
+    entity_(ComponentRegistry::k_invalid_entity),
+    subtree_version_(version_clock_.load(std::memory_order_relaxed)) {}
 
 void Object::setActive(const bool value) {
-  active_ = value;
+  if (active_ != value) {
+    active_ = value;
+    markSubtreeChanged();
+  }
 }
 
 bool Object::isActive() const {
@@ -33,16 +46,29 @@ bool Object::isActive() const {
 }
 
 bool Object::isActiveInHierarchy() const {
-  if (parent_ != nullptr) {
-    return active_ && parent_->isActiveInHierarchy();
-  } else {
-    return active_;
+  bool active = true;
+  traverseUp([&](const Object& object) {
+    active = object.active_;
+    return active;
+  });
+
+  return active;
+}
+
+void Object::setName(const std::string& name) {
+  if (scene_ == nullptr) {
+    Identifiable::setName(name);
+    return;
   }
+
+  scene_->index_.erase(*this);
+  Identifiable::setName(name);
+  reindexSubtree();
 }
 
 void Object::addChild(const Ref<Object>& obj) {
   if (obj->parent_ != nullptr) {
-    removeChildSilently(obj->id());
+    obj->parent_->removeChildSilently(obj->id());
   }
 
   children_.emplace_back(obj);
@@ -58,12 +84,14 @@ void Object::addChildren(const std::vector<Ref<Object>>& objs) {
 }
 
 void Object::removeChild(std::string_view name) {
-  for (auto it = children_.begin(); it < children_.end(); it++) {
-    if ((*it)->name() == name) {
-      Ref<Object> deleted_child = *it;
-      children_.erase(it);
-      deleted_child->changeParent(nullptr);
-    }
+  std::vector<Ref<Object>> deleted_children;
+  auto it = std::stable_partition(children_.begin(), children_.end(),
+                                  [&](const Ref<Object>& child) { return child->name() != name; });
+  deleted_children.assign(std::make_move_iterator(it), std::make_move_iterator(children_.end()));
+  children_.erase(it, children_.end());
+
+  for (const auto& deleted_child : deleted_children) {
+    deleted_child->changeParent(nullptr);
   }
 }
 
@@ -73,33 +101,50 @@ void Object::removeChild(size_t id) {
       Ref<Object> deleted_child = *it;
       children_.erase(it);
       deleted_child->changeParent(nullptr);
+      break;
     }
   }
 }
 
 Ref<Object> Object::find(std::string_view hierarchy_path) const {
-  Ref<Object> match;
+  if (scene_ != nullptr) {
+    std::vector<Object*> matches;
+    findIndexed(hierarchy_path, matches);
+    if (matches.empty()) {
+      return nullptr;
+    }
 
-  traverseDown([&](const Ref<Object>& obj) {
-    if (obj->matchesHierarchyPath(hierarchy_path)) {
-      match = obj;
-      return false;
-    } else {
-      return true;
+    return Ref<Object>(*std::min_element(matches.begin(), matches.end(), &Object::precedesInTraversal));
+  }
+
+  const Object* match = nullptr;
+
+  traverseDown([&](const Object& obj) {
+    if (match == nullptr && obj.matchesHierarchyPath(hierarchy_path)) {
+      match = &obj;
     }
+    // Descend only until the first match.
+    return match == nullptr;
   });
 
-  return match;
+  return Ref<Object>(const_cast<Object*>(match));
 }
 
 std::vector<Ref<Object>> Object::findAll(std::string_view hierarchy_path) const {
   std::vector<Ref<Object>> matches;
 
-  traverseDown([&](const Ref<Object>& obj) {
-    if (obj->matchesHierarchyPath(hierarchy_path)) {
-      matches.emplace_back(obj);
+  if (scene_ != nullptr) {
+    std::vector<Object*> indexed_matches;
+    findIndexed(hierarchy_path, indexed_matches);
+    std::sort(indexed_matches.begin(), indexed_matches.end(), &Object::precedesInTraversal);
+    matches.assign(indexed_matches.begin(), indexed_matches.end());
+    return matches;
+  }
+
+  traverseDown([&](const Object& obj) {
+    if (obj.matchesHierarchyPath(hierarchy_path)) {
+      matches.emplace_back(const_cast<Object*>(&obj));
     }
-    return true;
   });
 
   return matches;
@@ -129,7 +174,7 @@ bool Object::matchesHierarchyPath(std::string_view hierarchy_path) const {
   if (remaining_path.empty()) {
     return parent_ == nullptr;
   } else {
-    return parent_->matchesHierarchyPath(remaining_path);
+    return parent_ != nullptr && parent_->matchesHierarchyPath(remaining_path);
   }
 }
 
@@ -152,30 +197,9 @@ void Object::detach() {
   }
 }
 
-void Object::traverseUp(const std::function<bool(const Ref<Object>&)>& traversal_fn) const {
-  if (traversal_fn(Ref<Object>(const_cast<Object*>(this)))) {
-    traverseUpExcl(traversal_fn);
-  }
-}
-
-void Object::traverseUpExcl(const std::function<bool(const Ref<Object>&)>& traversal_fn) const {
-  if (parent_ != nullptr && traversal_fn(Ref<Object>(parent_))) {
-    parent_->traverseUpExcl(traversal_fn);
-  }
-}
-
-void Object::traverseDown(const std::function<bool(const Ref<Object>&)>& traversal_fn) const {
-  if (traversal_fn(Ref<Object>(const_cast<Object*>(this)))) {
-    traverseDownExcl(traversal_fn);
-  }
-}
-
-void Object::traverseDownExcl(const std::function<bool(const Ref<Object>&)>& traversal_fn) const {
-  for (const auto& child : children_) {
-    if (traversal_fn(child)) {
-      child->traverseDownExcl(traversal_fn);
-    }
-  }
+std::vector<const Object*>& Object::traversalStack() {
+  thread_local std::vector<const Object*> stack;
+  return stack;
 }
 
 void Object::removeChildSilently(size_t id) {
@@ -183,17 +207,122 @@ void Object::removeChildSilently(size_t id) {
     if ((*it)->id() == id) {
       Ref<Object> deleted_child = *it;
       children_.erase(it);
+      break;
     }
   }
 }
 
 void Object::changeParent(Object* new_parent) {
   if (parent_ != new_parent) {
+    Object* old_parent = parent_;
+    Object* old_root = this;
+    while (old_root->parent_ != nullptr) {
+      old_root = old_root->parent_;
+    }
+
     parent_ = new_parent;
+    // Scene roots always belong to their own scene.
+    if (scene_ != this) {
+      Scene* old_scene = scene_;
+      Scene* new_scene = (new_parent != nullptr) ? new_parent->scene_ : nullptr;
+      if (new_scene != nullptr && new_scene == scene_) {
+        // Moved within the scene, only the paths changed.
+        reindexSubtree();
+      } else {
+        setScene(new_scene);
+      }
+
+      if (old_scene != nullptr && old_parent != nullptr) {
+        old_scene->journal_.record(ChangeType::kChildRemoved, this, old_parent);
+      }
+      if (new_scene != nullptr) {
+        new_scene->journal_.record(ChangeType::kChildAdded, this, new_parent);
+      }
+    } else {
+      // Nested scene moves to the list of the new enclosing scene. Its paths change with the new parent.
+      moveNestedScene(*scene_, (old_parent != nullptr) ? old_parent->scene_ : nullptr,
+                      (new_parent != nullptr) ? new_parent->scene_ : nullptr);
+      reindexSubtree();
+    }
+
+    // Transforms of the subtree may have to move to the transform system of the new root.
+    if (old_root->transform_system_ != nullptr) {
+      traverseDown([](Object& object) {
+        for (const auto& component : object.components_) {
+          component->onHierarchyChanged();
+        }
+      });
+    }
+    if (old_parent == nullptr) {
+      transform_system_.reset();
+    }
+
+    if (old_parent != nullptr) {
+      old_parent->markSubtreeChanged();
+    }
+    // Also marks the new ancestors.
+    markSubtreeChanged();
     notifyParentChange();
   }
 }
 
+uint64_t Object::subtreeVersion() const {
+  return subtree_version_;
+}
+
+void Object::markSubtreeChanged() {
+  const uint64_t version = version_clock_.load(std::memory_order_relaxed);
+  // Object itself may already carry the version while its ancestors do not, e.g. when it was created in this epoch or
+  // was moved to a new parent. Current ancestors of any other object marked in this epoch were marked as well.
+  subtree_version_ = version;
+  for (Object* object = parent_; object != nullptr && object->subtree_version_ != version; object = object->parent_) {
+    object->subtree_version_ = version;
+  }
+}
+
+uint64_t Object::advanceVersionClock() {
+  return version_clock_.fetch_add(1u, std::memory_order_relaxed);
+}
+
+Scene* Object::scene() const {
+  return scene_;
+}
+
+void Object::setScene(Scene* scene) {
+  if (scene_ == scene) {
+    return;
+  }
+
+  Scene* old_scene = scene_;
+  traverseDown([this, scene, old_scene](Object& object) {
+    // Nested scenes keep their own registries and indexes. Only their paths change with the enclosing hierarchy.
+    if (&object != this && object.scene_ == &object) {
+      moveNestedScene(*object.scene_, old_scene, scene);
+      object.reindexSubtree();
+      return false;
+    }
+
+    if (object.scene_ != nullptr) {
+      object.scene_->removeFromSpatialIndex(object.entity_);
+      object.scene_->registry_.destroyEntity(object.entity_);
+      object.scene_->index_.erase(object);
+      object.entity_ = ComponentRegistry::k_invalid_entity;
+    }
+
+    object.scene_ = scene;
+
+    if (scene != nullptr) {
+      object.entity_ = scene->registry_.createEntity(object);
+      scene->index_.insert(object);
+      for (const auto& component : object.components_) {
+        scene->registry_.addComponent(object.entity_, component.get());
+      }
+    }
+
+    return true;
+  });
+}
+
 void Object::notifyParentChange() {
   Ref<Object> parent_ref(parent_);
   for (const auto& callback : on_parent_change_callbacks_) {
@@ -201,4 +330,276 @@ void Object::notifyParentChange() {
   }
 }
 
+void Object::reindexSubtree() {
+  Scene* scene = scene_;
+  traverseDown([scene](Object& object) {
+    if (object.scene_ != scene) {
+      // Paths of nested scenes change as well.
+      if (object.scene_ == &object) {
+        object.reindexSubtree();
+      }
+      return false;
+    }
+
+    scene->index_.erase(object);
+    scene->index_.insert(object);
+    return true;
+  });
+}
+
+void Object::findIndexed(std::string_view hierarchy_path, std::vector<Object*>& matches) const {
+  findIndexed(*scene_, hierarchy_path, matches);
+}
+
+void Object::findIndexed(const Scene& scene, std::string_view hierarchy_path, std::vector<Object*>& matches) const {
+  const std::vector<Object*>* candidates = scene.index_.candidates(hierarchy_path);
+  if (candidates != nullptr) {
+    for (Object* candidate : *candidates) {
+      if (candidate->matchesHierarchyPath(hierarchy_path) && containsInSubtree(candidate)) {
+        matches.emplace_back(candidate);
+      }
+    }
+  }
+
+  for (const Scene* nested : scene.nested_scenes_) {
+    if (containsInSubtree(nested)) {
+      findIndexed(*nested, hierarchy_path, matches);
+    }
+  }
+}
+
+Object* Object::findIndexedChild(std::string_view name, bool& resolved) const {
+  const std::vector<Object*>* candidates =
+    scene_->index_.pathCandidates(HierarchyIndex::combinePathHash(index_entry_.path_hash, name));
+  Object* match = nullptr;
+  resolved = true;
+
+  auto consider = [this, name, &match, &resolved](Object* candidate) {
+    if (candidate->parent_ == this && candidate->name() == name) {
+      // Multiple children share the name, caller must respect the child order.
+      resolved = resolved && match == nullptr;
+      match = candidate;
+    }
+  };
+
+  if (candidates != nullptr) {
+    for (Object* candidate : *candidates) {
+      consider(candidate);
+    }
+  }
+
+  // Child scenes are indexed only by themselves.
+  for (Scene* nested : scene_->nested_scenes_) {
+    consider(nested);
+  }
+
+  return resolved ? match : nullptr;
+}
+
+void Object::moveNestedScene(Scene& nested, Scene* from, Scene* to) {
+  if (from == to) {
+    return;
+  }
+
+  if (from != nullptr) {
+    auto it = std::find(from->nested_scenes_.begin(), from->nested_scenes_.end(), &nested);
+    if (it != from->nested_scenes_.end()) {
+      from->nested_scenes_.erase(it);
+    }
+  }
+
+  if (to != nullptr) {
+    to->nested_scenes_.emplace_back(&nested);
+  }
+}
+
+bool Object::containsInSubtree(const Object* object) const {
+  for (; object != nullptr; object = object->parent_) {
+    if (object == this) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+bool Object::precedesInTraversal(const Object* lhs, const Object* rhs) {
+  if (lhs == rhs) {
+    return false;
+  }
+
+  size_t lhs_depth = 0u;
+  size_t rhs_depth = 0u;
+  for (const Object* object = lhs->parent_; object != nullptr; object = object->parent_) {
+    lhs_depth++;
+  }
+  for (const Object* object = rhs->parent_; object != nullptr; object = object->parent_) {
+    rhs_depth++;
+  }
+
+  // Lift the deeper object to the depth of the other one. Ancestor precedes its descendants.
+  const bool lhs_shallower = lhs_depth < rhs_depth;
+  for (; lhs_depth > rhs_depth; lhs_depth--) {
+    lhs = lhs->parent_;
+  }
+  for (; rhs_depth > lhs_depth; rhs_depth--) {
+    rhs = rhs->parent_;
+  }
+  if (lhs == rhs) {
+    return lhs_shallower;
+  }
+
+  // Walk up until both are children of the common parent.
+  while (lhs->parent_ != rhs->parent_) {
+    lhs = lhs->parent_;
+    rhs = rhs->parent_;
+  }
+  if (lhs->parent_ == nullptr) {
+    return false;
+  }
+
+  for (const auto& child : lhs->parent_->children_) {
+    if (child.get() == lhs) {
+      return true;
+    }
+    if (child.get() == rhs) {
+      return false;
+    }
+  }
+
+  return false;
+}
+
+void Object::registerComponent(Component* component) {
+  if (scene_ != nullptr) {
+    scene_->registry_.addComponent(entity_, component);
+    scene_->journal_.record(ChangeType::kComponentAdded, this, nullptr, component);
+  }
+  markSubtreeChanged();
+
+  // Component is stored under its type and its declared bases. First matching component wins.
+  for (const ComponentTypeId type_id : *component->type_ids_) {
+    if (type_id >= component_table_.size()) {
+      component_table_.resize(type_id + 1u, nullptr);
+    }
+    if (component_table_[type_id] == nullptr) {
+      component_table_[type_id] = component;
+    }
+  }
+}
+
+AABB<float> Object::localBounds() const {
+  AABB<float> bounds;
+
+  for (const auto& component : components_) {
+    const AABB<float> component_bounds = component->localBounds();
+    if (component_bounds.valid()) {
+      bounds.expand(component_bounds);
+    }
+  }
+
+  return bounds;
+}
+
+const AABB<float>& Object::worldBounds() {
+  Transform* transform = nearestTransform();
+  const uint64_t world_version = (transform != nullptr) ? transform->worldVersion() : 0u;
+
+  if (!world_bounds_.matches(subtree_version_, world_version)) {
+    updateWorldBounds(transform, world_version);
+  }
+
+  return world_bounds_.bounds;
+}
+
+const AABB<float>& Object::subtreeBounds() {
+  struct Frame {
+    Object* object;
+    Transform* transform;
+    uint64_t world_version;
+    bool expanded;
+  };
+
+  Transform* transform = nearestTransform();
+  std::vector<Frame> stack {{this, transform, (transform != nullptr) ? transform->worldVersion() : 0u, false}};
+
+  // Post-order traversal that descends only into subtrees with stale bounds.
+  while (!stack.empty()) {
+    const Frame frame = stack.back();
+    Object& object = *frame.object;
+
+    if (!frame.expanded) {
+      if (object.subtree_bounds_.matches(object.subtree_version_, frame.world_version)) {
+        stack.pop_back();
+        continue;
+      }
+
+      stack.back().expanded = true;
+      for (const Ref<Object>& child : object.children_) {
+        Transform* child_transform = child->findComponent<Transform>();
+        if (child_transform != nullptr) {
+          stack.push_back({child.get(), child_transform, child_transform->worldVersion(), false});
+        } else {
+          stack.push_back({child.get(), frame.transform, frame.world_version, false});
+        }
+      }
+      continue;
+    }
+
+    stack.pop_back();
+
+    if (!object.world_bounds_.matches(object.subtree_version_, frame.world_version)) {
+      object.updateWorldBounds(frame.transform, frame.world_version);
+    }
+
+    AABB<float> bounds = object.world_bounds_.bounds;
+    for (const Ref<Object>& child : object.children_) {
+      if (child->subtree_bounds_.bounds.valid()) {
+        bounds.expand(child->subtree_bounds_.bounds);
+      }
+    }
+
+    object.advanceClockPast();
+    object.subtree_bounds_.bounds = bounds;
+    object.subtree_bounds_.cached_subtree_version = object.subtree_version_;
+    object.subtree_bounds_.cached_world_version = frame.world_version;
+  }
+
+  return subtree_bounds_.bounds;
+}
+
+Transform* Object::nearestTransform() {
+  for (Object* object = this; object != nullptr; object = object->parent_) {
+    Transform* transform = object->findComponent<Transform>();
+    if (transform != nullptr) {
+      return transform;
+    }
+  }
+
+  return nullptr;
+}
+
+void Object::updateWorldBounds(Transform* transform, const uint64_t world_version) {
+  advanceClockPast();
+
+  const AABB<float> local_bounds = localBounds();
+  if (!local_bounds.valid()) {
+    world_bounds_.bounds = AABB<float>();
+  } else if (transform != nullptr) {
+    world_bounds_.bounds = local_bounds.transform(transform->worldMatrix());
+  } else {
+    world_bounds_.bounds = local_bounds;
+  }
+
+  world_bounds_.cached_subtree_version = subtree_version_;
+  world_bounds_.cached_world_version = world_version;
+}
+
+void Object::advanceClockPast() const {
+  // Changes made while the clock equals the subtree version would stop propagating at this object.
+  if (subtree_version_ >= version_clock_.load(std::memory_order_relaxed)) {
+    advanceVersionClock();
+  }
+}
+
 } // namespace lsg
@@ -0,0 +1,239 @@
+/**
+ * Project LogiSceneGraph source code
+ * Copyright (C) 2019 Primoz Lavric
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "lsg/core/PoolAllocator.h"
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <thread>
+
+namespace lsg {
+
+namespace {
+
+constexpr size_t k_num_size_classes = PoolAllocator::k_max_size / PoolAllocator::k_granularity;
+
+struct FreeSlot {
+  FreeSlot* next;
+};
+
+struct SizeClass;
+
+/**
+ * Slab header is stored at the start of the slab, so the slab of a slot is found by masking the slot address.
+ */
+struct alignas(64) Slab {
+  SizeClass* owner;
+  Slab* prev;
+  Slab* next;
+  FreeSlot* free_slots;
+  char* bump;
+  char* end;
+  size_t used;
+  size_t capacity;
+};
+
+/**
+ * Size class guarded by a spin lock. Lock is held only for a handful of instructions.
+ */
+struct SizeClass {
+  void lock() {
+    while (locked.exchange(true, std::memory_order_acquire)) {
+      while (locked.load(std::memory_order_relaxed)) {
+        std::this_thread::yield();
+      }
+    }
+  }
+
+  void unlock() {
+    locked.store(false, std::memory_order_release);
+  }
+
+  /**
+   * Unlinks the slab from the list of slabs with free slots.
+   */
+  void unlink(Slab* slab) {
+    (slab->prev != nullptr ? slab->prev->next : available) = slab->next;
+    if (slab->next != nullptr) {
+      slab->next->prev = slab->prev;
+    }
+    slab->prev = nullptr;
+    slab->next = nullptr;
+  }
+
+  void pushFront(Slab* slab) {
+    slab->prev = nullptr;
+    slab->next = available;
+    if (available != nullptr) {
+      available->prev = slab;
+    }
+    available = slab;
+  }
+
+  std::atomic<bool> locked {false};
+  size_t slot_size = 0u;
+  Slab* available = nullptr;
+  size_t slabs = 0u;
+  size_t live_allocations = 0u;
+  size_t total_allocations = 0u;
+};
+
+SizeClass* sizeClasses() {
+  // Leaked on purpose, objects may be released during static destruction.
+  static SizeClass* size_classes = []() {
+    auto* classes = new SizeClass[k_num_size_classes];
+    for (size_t i = 0u; i < k_num_size_classes; i++) {
+      classes[i].slot_size = (i + 1u) * PoolAllocator::k_granularity;
+    }
+    return classes;
+  }();
+
+  return size_classes;
+}
+
+size_t sizeClassIndex(const size_t size) {
+  return (size == 0u) ? 0u : (size - 1u) / PoolAllocator::k_granularity;
+}
+
+Slab* createSlab(SizeClass& size_class) {
+  void* memory = std::aligned_alloc(PoolAllocator::k_slab_size, PoolAllocator::k_slab_size);
+  if (memory == nullptr) {
+    throw std::bad_alloc();
+  }
+
+  auto* slab = new (memory) Slab();
+  slab->owner = &size_class;
+  slab->bump = static_cast<char*>(memory) + sizeof(Slab);
+  slab->end = static_cast<char*>(memory) + PoolAllocator::k_slab_size;
+  slab->capacity = static_cast<size_t>(slab->end - slab->bump) / size_class.slot_size;
+  size_class.slabs++;
+
+  return slab;
+}
+
+} // namespace
+
+void* PoolAllocator::allocate(const size_t size) {
+  if (size > k_max_size) {
+    return ::operator new(size);
+  }
+
+  SizeClass& size_class = sizeClasses()[sizeClassIndex(size)];
+  size_class.lock();
+
+  Slab* slab = size_class.available;
+  if (slab == nullptr) {
+    try {
+      slab = createSlab(size_class);
+    } catch (...) {
+      size_class.unlock();
+      throw;
+    }
+    size_class.pushFront(slab);
+  }
+
+  void* ptr;
+  if (slab->free_slots != nullptr) {
+    ptr = slab->free_slots;
+    slab->free_slots = slab->free_slots->next;
+  } else {
+    // Slots are carved lazily so that fresh slabs are not touched up front.
+    ptr = slab->bump;
+    slab->bump += size_class.slot_size;
+  }
+
+  if (++slab->used == slab->capacity) {
+    size_class.unlink(slab);
+  }
+  size_class.live_allocations++;
+  size_class.total_allocations++;
+
+  size_class.unlock();
+  return ptr;
+}
+
+void PoolAllocator::deallocate(void* ptr, const size_t size) noexcept {
+  if (ptr == nullptr) {
+    return;
+  }
+  if (size > k_max_size) {
+    ::operator delete(ptr);
+    return;
+  }
+
+  auto* slab = reinterpret_cast<Slab*>(reinterpret_cast<uintptr_t>(ptr) & ~uintptr_t(k_slab_size - 1u));
+  SizeClass& size_class = *slab->owner;
+  size_class.lock();
+
+  auto* slot = static_cast<FreeSlot*>(ptr);
+  slot->next = slab->free_slots;
+  slab->free_slots = slot;
+
+  // Full slabs are not linked, link the slab again once it has a free slot.
+  if (slab->used-- == slab->capacity) {
+    size_class.pushFront(slab);
+  }
+  size_class.live_allocations--;
+
+  size_class.unlock();
+}
+
+size_t PoolAllocator::trim() {
+  size_t released = 0u;
+  SizeClass* size_classes = sizeClasses();
+
+  for (size_t i = 0u; i < k_num_size_classes; i++) {
+    SizeClass& size_class = size_classes[i];
+    size_class.lock();
+
+    for (Slab* slab = size_class.available; slab != nullptr;) {
+      Slab* next = slab->next;
+      if (slab->used == 0u) {
+        size_class.unlink(slab);
+        size_class.slabs--;
+        slab->~Slab();
+        std::free(slab);
+        released++;
+      }
+      slab = next;
+    }
+
+    size_class.unlock();
+  }
+
+  return released;
+}
+
+PoolAllocator::Stats PoolAllocator::stats() {
+  Stats stats;
+  SizeClass* size_classes = sizeClasses();
+
+  for (size_t i = 0u; i < k_num_size_classes; i++) {
+    SizeClass& size_class = size_classes[i];
+    size_class.lock();
+    stats.slabs += size_class.slabs;
+    stats.live_allocations += size_class.live_allocations;
+    stats.total_allocations += size_class.total_allocations;
+    size_class.unlock();
+  }
+
+  return stats;
+}
+
+} // namespace lsg
@@ -17,5 +17,285 @@
  */
 
 #include "lsg/core/Scene.h"
+#include "lsg/components/Camera.h"
+#include "lsg/components/LODGroup.h"
+#include "lsg/components/Mesh.h"
+#include "lsg/components/Transform.h"
+#include "lsg/components/TransformSystem.h"
+#include <utility>
 
-namespace lsg {}
\ No newline at end of file
+namespace lsg {
+
+Scene::Scene(std::string name, const bool active)
+  : Object(std::move(name), active), journal_(ChangeJournal::k_default_capacity, this), spatial_version_(0u) {
+  setScene(this);
+}
+
+const ComponentRegistry& Scene::registry() const {
+  return registry_;
+}
+
+ChangeJournal& Scene::changeJournal() {
+  return journal_;
+}
+
+const ChangeJournal& Scene::changeJournal() const {
+  return journal_;
+}
+
+void Scene::updateTransforms(ThreadPool& executor) {
+  TransformSystem::of(*this)->update(executor);
+}
+
+void Scene::updateSpatialIndex(ThreadPool& executor) {
+  updateTransforms(executor);
+
+  const uint64_t last_version = spatial_version_;
+  spatial_version_ = advanceVersionClock();
+
+  struct Frame {
+    Object* object;
+    // World matrix and version of the nearest ancestor transform.
+    glm::mat4 parent_matrix;
+    uint64_t parent_version;
+    // Set if the world matrix of an ancestor changed or the ancestor was not indexed yet.
+    bool ancestor_moved;
+  };
+
+  std::vector<Frame> stack {{this, glm::mat4(1.0f), 0u, false}};
+
+  while (!stack.empty()) {
+    Frame frame = stack.back();
+    stack.pop_back();
+    Object& object = *frame.object;
+
+    // Nested scenes keep their own index.
+    if (object.scene_ != this || (!frame.ancestor_moved && object.subtreeVersion() <= last_version)) {
+      continue;
+    }
+
+    if (object.entity_ >= spatial_entries_.size()) {
+      spatial_entries_.resize(object.entity_ + 1u);
+    }
+
+    SpatialEntry& entry = spatial_entries_[object.entity_];
+    Transform* transform = object.findComponent<Transform>();
+    const glm::mat4 world_matrix = (transform != nullptr) ? transform->worldMatrix() : frame.parent_matrix;
+    const uint64_t world_version = (transform != nullptr) ? transform->worldVersion() : frame.parent_version;
+    const bool moved = frame.ancestor_moved || entry.world_version != world_version;
+    entry.world_version = world_version;
+
+    const AABB<float> local_bounds = object.localBounds();
+    if (local_bounds.valid()) {
+      const AABB<float> world_bounds = local_bounds.transform(world_matrix);
+      if (entry.node == DynamicAABBTree<float, Object*>::k_null_node) {
+        entry.node = spatial_index_.insert(world_bounds, &object);
+      } else {
+        spatial_index_.move(entry.node, world_bounds);
+      }
+    } else if (entry.node != DynamicAABBTree<float, Object*>::k_null_node) {
+      spatial_index_.remove(entry.node);
+      entry.node = DynamicAABBTree<float, Object*>::k_null_node;
+    }
+
+    for (auto it = object.children_.rbegin(); it != object.children_.rend(); ++it) {
+      stack.push_back({it->get(), world_matrix, world_version, moved});
+    }
+  }
+}
+
+const DynamicAABBTree<float, Object*>& Scene::spatialIndex() const {
+  return spatial_index_;
+}
+
+void Scene::removeFromSpatialIndex(const Entity entity) {
+  if (entity >= spatial_entries_.size()) {
+    return;
+  }
+
+  SpatialEntry& entry = spatial_entries_[entity];
+  if (entry.node != DynamicAABBTree<float, Object*>::k_null_node) {
+    spatial_index_.remove(entry.node);
+  }
+  entry = SpatialEntry();
+}
+
+void Scene::cull(Object& camera_object, std::vector<VisibleSubMesh>& output, ThreadPool& executor,
+                 LODSelection* lod_selection) {
+  Camera* camera = camera_object.findComponent<Camera>();
+  throwIf<InvalidArgument>(camera == nullptr, "Culling requires an object with a camera.");
+
+  updateTransforms(executor);
+  Transform* transform = camera_object.nearestTransform();
+  const glm::mat4 camera_world = (transform != nullptr) ? transform->worldMatrix() : glm::mat4(1.0f);
+  LODView lod_view = LODView::fromCamera(camera->projectionMatrix(), camera_world);
+  lod_view.selection = lod_selection;
+
+  cull(Frustum<float>(camera->projectionMatrix() * glm::inverse(camera_world)), output, executor, &lod_view);
+}
+
+void Scene::cull(const Frustum<float>& frustum, std::vector<VisibleSubMesh>& output, ThreadPool& executor,
+                 const LODView* lod_view) {
+  output.clear();
+
+  // Bring all cached bounds up to date, so that the parallel part only reads them.
+  const AABB<float>& bounds = subtreeBounds();
+  if (!isActive() || !bounds.valid()) {
+    return;
+  }
+
+  const Containment containment = frustum.classifyAABB(bounds);
+  if (containment == Containment::kOutside) {
+    return;
+  }
+
+  if (world_bounds_.bounds.valid() &&
+      (containment == Containment::kInside || frustum.intersectsAABB(world_bounds_.bounds))) {
+    emitSubMeshes(*this, lod_view, output);
+  }
+
+  // Top level subtrees that are not rejected outright are culled in parallel.
+  struct Task {
+    Object* object;
+    bool inside;
+  };
+
+  std::vector<Task> tasks;
+  AABBBatch<float> batch;
+  for (const Ref<Object>& child : children_) {
+    if (child->isActive() && child->subtree_bounds_.bounds.valid()) {
+      tasks.push_back({child.get(), containment == Containment::kInside});
+      batch.push(child->subtree_bounds_.bounds);
+    }
+  }
+
+  if (containment != Containment::kInside) {
+    std::vector<Containment> results;
+    frustum.classifyAABBs(batch, results);
+
+    size_t count = 0u;
+    for (size_t i = 0u; i < tasks.size(); i++) {
+      if (results[i] != Containment::kOutside) {
+        tasks[count++] = {tasks[i].object, results[i] == Containment::kInside};
+      }
+    }
+    tasks.resize(count);
+  }
+
+  std::vector<std::vector<VisibleSubMesh>> outputs(tasks.size());
+  executor.parallelFor(tasks.size(), 1u, [&](const size_t begin, const size_t end, size_t) {
+    for (size_t i = begin; i < end; i++) {
+      cullSubtree(*tasks[i].object, frustum, tasks[i].inside, lod_view, outputs[i]);
+    }
+  });
+
+  for (const std::vector<VisibleSubMesh>& task_output : outputs) {
+    output.insert(output.end(), task_output.begin(), task_output.end());
+  }
+
+  // Selection is only read by the tasks, so it is stored once all of them finished.
+  if (lod_view != nullptr && lod_view->selection != nullptr) {
+    for (const VisibleSubMesh& item : output) {
+      if (item.lod_group != nullptr) {
+        lod_view->selection->setLevel(*item.lod_group, item.lod_level);
+      }
+    }
+  }
+}
+
+void Scene::cullSubtree(Object& root, const Frustum<float>& frustum, const bool inside, const LODView* lod_view,
+                        std::vector<VisibleSubMesh>& output) {
+  struct Frame {
+    Object* object;
+    bool inside;
+  };
+
+  std::vector<Frame> stack {{&root, inside}};
+  std::vector<Object*> children;
+  std::vector<Containment> results;
+  AABBBatch<float> batch;
+
+  while (!stack.empty()) {
+    const Frame frame = stack.back();
+    stack.pop_back();
+    Object& object = *frame.object;
+
+    const AABB<float>& world_bounds = object.world_bounds_.bounds;
+    if (world_bounds.valid() && (frame.inside || frustum.intersectsAABB(world_bounds))) {
+      emitSubMeshes(object, lod_view, output);
+    }
+
+    children.clear();
+    for (const Ref<Object>& child : object.children_) {
+      if (child->isActive() && child->subtree_bounds_.bounds.valid()) {
+        children.emplace_back(child.get());
+      }
+    }
+
+    if (frame.inside) {
+      for (auto it = children.rbegin(); it != children.rend(); ++it) {
+        stack.push_back({*it, true});
+      }
+      continue;
+    }
+
+    batch.clear();
+    for (Object* child : children) {
+      batch.push(child->subtree_bounds_.bounds);
+    }
+    frustum.classifyAABBs(batch, results);
+
+    for (size_t i = children.size(); i-- > 0u;) {
+      if (results[i] != Containment::kOutside) {
+        stack.push_back({children[i], results[i] == Containment::kInside});
+      }
+    }
+  }
+}
+
+void Scene::emitSubMeshes(Object& object, const LODView* lod_view, std::vector<VisibleSubMesh>& output) {
+  for (Mesh& mesh : object.getComponents<Mesh>()) {
+    for (const Ref<SubMesh>& sub_mesh : mesh.subMeshes()) {
+      output.push_back({&object, sub_mesh.get()});
+    }
+  }
+
+  for (const LODGroup& lod_group : object.getComponents<LODGroup>()) {
+    if (lod_group.levelCount() == 0u) {
+      continue;
+    }
+
+    size_t level = 0u;
+    if (lod_view != nullptr) {
+      const size_t previous_level = (lod_view->selection != nullptr) ? lod_view->selection->level(lod_group) : 0u;
+      level = lod_group.select(object.world_bounds_.bounds, *lod_view, previous_level);
+    }
+
+    for (const Ref<SubMesh>& sub_mesh : lod_group.level(level).sub_meshes) {
+      output.push_back({&object, sub_mesh.get(), &lod_group, level});
+    }
+  }
+}
+
+std::shared_ptr<const SceneSnapshot> Scene::compile(ThreadPool& executor) {
+  updateTransforms(executor);
+
+  // Changes made after this point get a greater subtree version than the snapshot.
+  const uint64_t version = advanceVersionClock();
+  std::shared_ptr<const SceneSnapshot> previous = std::atomic_load(&snapshot_);
+  std::shared_ptr<const SceneSnapshot> snapshot = SceneSnapshot::compile(*this, previous.get(), version);
+  std::atomic_store(&snapshot_, snapshot);
+
+  return snapshot;
+}
+
+std::shared_ptr<const SceneSnapshot> Scene::snapshot() const {
+  return std::atomic_load(&snapshot_);
+}
+
+Scene::~Scene() {
+  // Objects may outlive the scene.
+  setScene(nullptr);
+}
+
+} // namespace lsg
\ No newline at end of file
@@ -0,0 +1,264 @@
+/**
+ * Project LogiSceneGraph source code
+ * Copyright (C) 2019 Primoz Lavric
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "lsg/core/SceneSnapshot.h"
+#include <algorithm>
+#include "lsg/components/Mesh.h"
+#include "lsg/components/Transform.h"
+#include "lsg/core/Scene.h"
+
+namespace lsg {
+
+uint64_t SceneSnapshot::version() const {
+  return version_;
+}
+
+uint64_t SceneSnapshot::previousVersion() const {
+  return previous_version_;
+}
+
+uint64_t SceneSnapshot::structureVersion() const {
+  return structure_version_;
+}
+
+size_t SceneSnapshot::objectCount() const {
+  return object_ids_.size();
+}
+
+size_t SceneSnapshot::subMeshCount() const {
+  return geometries_.size();
+}
+
+size_t SceneSnapshot::reusedObjectCount() const {
+  return reused_objects_;
+}
+
+const std::vector<uint32_t>& SceneSnapshot::modifiedObjects() const {
+  return modified_objects_;
+}
+
+const std::vector<size_t>& SceneSnapshot::objectIds() const {
+  return object_ids_;
+}
+
+const std::vector<uint32_t>& SceneSnapshot::parents() const {
+  return parents_;
+}
+
+const std::vector<uint32_t>& SceneSnapshot::subtreeEnds() const {
+  return subtree_ends_;
+}
+
+const std::vector<glm::mat4>& SceneSnapshot::worldMatrices() const {
+  return world_matrices_;
+}
+
+const std::vector<uint8_t>& SceneSnapshot::activeFlags() const {
+  return active_flags_;
+}
+
+const std::vector<uint32_t>& SceneSnapshot::subMeshOffsets() const {
+  return sub_mesh_offsets_;
+}
+
+const std::vector<uint32_t>& SceneSnapshot::subMeshObjects() const {
+  return sub_mesh_objects_;
+}
+
+const std::vector<Ref<Geometry>>& SceneSnapshot::geometries() const {
+  return geometries_;
+}
+
+const std::vector<Ref<Material>>& SceneSnapshot::materials() const {
+  return materials_;
+}
+
+std::shared_ptr<const SceneSnapshot> SceneSnapshot::compile(Scene& scene, const SceneSnapshot* previous,
+                                                            const uint64_t version) {
+  std::shared_ptr<SceneSnapshot> snapshot(new SceneSnapshot());
+  snapshot->version_ = version;
+  snapshot->sub_mesh_offsets_.emplace_back(0u);
+
+  if (previous != nullptr) {
+    snapshot->previous_version_ = previous->version_;
+    snapshot->object_ids_.reserve(previous->objectCount());
+    snapshot->parents_.reserve(previous->objectCount());
+    snapshot->subtree_ends_.reserve(previous->objectCount());
+    snapshot->world_matrices_.reserve(previous->objectCount());
+    snapshot->active_flags_.reserve(previous->objectCount());
+    snapshot->sub_mesh_offsets_.reserve(previous->objectCount() + 1u);
+    snapshot->sub_mesh_objects_.reserve(previous->subMeshCount());
+    snapshot->geometries_.reserve(previous->subMeshCount());
+    snapshot->materials_.reserve(previous->subMeshCount());
+  }
+
+  struct Frame {
+    Object* object;
+    uint32_t parent;
+    // Index of the object in the previous snapshot or k_no_parent.
+    uint32_t previous;
+    // Set if an ancestor changed its world matrix or active state.
+    bool ancestor_changed;
+  };
+
+  const bool has_previous = previous != nullptr && previous->objectCount() > 0u &&
+                            previous->object_ids_.front() == scene.id();
+  std::vector<Frame> stack {{&scene, k_no_parent, has_previous ? 0u : k_no_parent, !has_previous}};
+
+  while (!stack.empty()) {
+    const Frame frame = stack.back();
+    stack.pop_back();
+
+    if (!frame.ancestor_changed && frame.previous != k_no_parent && frame.object->subtreeVersion() <= previous->version_) {
+      snapshot->appendSubtree(*previous, frame.previous, frame.parent);
+      continue;
+    }
+
+    const auto index = static_cast<uint32_t>(snapshot->objectCount());
+    const bool has_parent = frame.parent != k_no_parent;
+    snapshot->appendObject(*frame.object, frame.parent,
+                           has_parent ? snapshot->world_matrices_[frame.parent] : glm::mat4(1.0f),
+                           !has_parent || snapshot->active_flags_[frame.parent] != 0u);
+
+    const bool changed = frame.ancestor_changed || frame.previous == k_no_parent ||
+                         previous->world_matrices_[frame.previous] != snapshot->world_matrices_[index] ||
+                         previous->active_flags_[frame.previous] != snapshot->active_flags_[index];
+
+    // Match children with the children in the previous snapshot. Children usually keep their order, so the next
+    // previous sibling is checked first.
+    const uint32_t previous_begin = (frame.previous != k_no_parent) ? frame.previous + 1u : 0u;
+    const uint32_t previous_end = (frame.previous != k_no_parent) ? previous->subtree_ends_[frame.previous] : 0u;
+    uint32_t cursor = previous_begin;
+
+    const size_t first_frame = stack.size();
+    for (const Ref<Object>& child : frame.object->children()) {
+      uint32_t match = k_no_parent;
+
+      if (cursor < previous_end && previous->object_ids_[cursor] == child->id()) {
+        match = cursor;
+      } else {
+        for (uint32_t sibling = previous_begin; sibling < previous_end; sibling = previous->subtree_ends_[sibling]) {
+          if (previous->object_ids_[sibling] == child->id()) {
+            match = sibling;
+            break;
+          }
+        }
+      }
+
+      if (match != k_no_parent) {
+        cursor = previous->subtree_ends_[match];
+      }
+
+      stack.push_back({child.get(), index, match, changed});
+    }
+
+    // Visit children in order.
+    std::reverse(stack.begin() + first_frame, stack.end());
+  }
+
+  // Extend subtree ends of the objects read from the scene. Children always follow their parents.
+  for (size_t i = snapshot->objectCount(); i-- > 1u;) {
+    uint32_t& parent_end = snapshot->subtree_ends_[snapshot->parents_[i]];
+    parent_end = std::max(parent_end, snapshot->subtree_ends_[i]);
+  }
+
+  const bool same_structure = previous != nullptr && snapshot->hasSameStructure(*previous);
+  snapshot->structure_version_ = same_structure ? previous->structure_version_ : version;
+
+  return snapshot;
+}
+
+void SceneSnapshot::appendObject(Object& object, const uint32_t parent, const glm::mat4& parent_matrix,
+                                 const bool parent_active) {
+  const auto index = static_cast<uint32_t>(objectCount());
+  Transform* transform = object.findComponent<Transform>();
+
+  modified_objects_.emplace_back(index);
+  object_ids_.emplace_back(object.id());
+  parents_.emplace_back(parent);
+  subtree_ends_.emplace_back(index + 1u);
+  world_matrices_.emplace_back(transform != nullptr ? transform->worldMatrix() : parent_matrix);
+  active_flags_.emplace_back(static_cast<uint8_t>(parent_active && object.isActive()));
+
+  for (Mesh& mesh : object.getComponents<Mesh>()) {
+    for (const Ref<SubMesh>& sub_mesh : mesh.subMeshes()) {
+      sub_mesh_objects_.emplace_back(index);
+      geometries_.emplace_back(sub_mesh->geometry());
+      materials_.emplace_back(sub_mesh->material());
+    }
+  }
+
+  sub_mesh_offsets_.emplace_back(static_cast<uint32_t>(geometries_.size()));
+}
+
+void SceneSnapshot::appendSubtree(const SceneSnapshot& previous, const uint32_t first, const uint32_t parent) {
+  const uint32_t last = previous.subtree_ends_[first];
+  const auto index = static_cast<uint32_t>(objectCount());
+  const uint32_t sub_mesh_first = previous.sub_mesh_offsets_[first];
+  const uint32_t sub_mesh_last = previous.sub_mesh_offsets_[last];
+  const auto sub_mesh_index = static_cast<uint32_t>(geometries_.size());
+
+  // Indices are shifted with unsigned wrap around, which is well defined in both directions.
+  object_ids_.insert(object_ids_.end(), previous.object_ids_.begin() + first, previous.object_ids_.begin() + last);
+  parents_.emplace_back(parent);
+  for (uint32_t i = first + 1u; i < last; i++) {
+    parents_.emplace_back(previous.parents_[i] - first + index);
+  }
+  for (uint32_t i = first; i < last; i++) {
+    subtree_ends_.emplace_back(previous.subtree_ends_[i] - first + index);
+  }
+  world_matrices_.insert(world_matrices_.end(), previous.world_matrices_.begin() + first,
+                         previous.world_matrices_.begin() + last);
+  active_flags_.insert(active_flags_.end(), previous.active_flags_.begin() + first,
+                       previous.active_flags_.begin() + last);
+  for (uint32_t i = first + 1u; i <= last; i++) {
+    sub_mesh_offsets_.emplace_back(previous.sub_mesh_offsets_[i] - sub_mesh_first + sub_mesh_index);
+  }
+
+  for (uint32_t i = sub_mesh_first; i < sub_mesh_last; i++) {
+    sub_mesh_objects_.emplace_back(previous.sub_mesh_objects_[i] - first + index);
+  }
+  geometries_.insert(geometries_.end(), previous.geometries_.begin() + sub_mesh_first,
+                     previous.geometries_.begin() + sub_mesh_last);
+  materials_.insert(materials_.end(), previous.materials_.begin() + sub_mesh_first,
+                    previous.materials_.begin() + sub_mesh_last);
+
+  reused_objects_ += last - first;
+}
+
+bool SceneSnapshot::hasSameStructure(const SceneSnapshot& other) const {
+  if (objectCount() != other.objectCount() || subMeshCount() != other.subMeshCount()) {
+    return false;
+  }
+
+  // Snapshot copied as a whole.
+  if (modified_objects_.empty()) {
+    return true;
+  }
+
+  const auto same_resources = [](const auto& lhs, const auto& rhs) {
+    return std::equal(lhs.begin(), lhs.end(), rhs.begin(),
+                      [](const auto& lhs_ref, const auto& rhs_ref) { return lhs_ref.get() == rhs_ref.get(); });
+  };
+
+  return object_ids_ == other.object_ids_ && parents_ == other.parents_ && active_flags_ == other.active_flags_ &&
+         sub_mesh_offsets_ == other.sub_mesh_offsets_ && same_resources(geometries_, other.geometries_) &&
+         same_resources(materials_, other.materials_);
+}
+
+} // namespace lsg
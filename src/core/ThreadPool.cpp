@@ -0,0 +1,128 @@
+/**
+ * Project LogiSceneGraph source code
+ * Copyright (C) 2019 Primoz Lavric
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "lsg/core/ThreadPool.h"
+
+namespace lsg {
+
+thread_local const ThreadPool* ThreadPool::t_current_pool_ = nullptr;
+thread_local size_t ThreadPool::t_current_slot_ = 0u;
+
+ThreadPool::ThreadPool(size_t num_threads) : pending_(0u), stop_(false) {
+  num_threads = std::max<size_t>(num_threads, 1u);
+
+  queues_.reserve(num_threads);
+  for (size_t i = 0u; i < num_threads; i++) {
+    queues_.emplace_back(std::make_unique<WorkerQueue>());
+  }
+
+  workers_.reserve(num_threads);
+  for (size_t i = 0u; i < num_threads; i++) {
+    workers_.emplace_back(&ThreadPool::workerLoop, this, i);
+  }
+}
+
+size_t ThreadPool::numThreads() const {
+  return workers_.size();
+}
+
+ThreadPool& ThreadPool::global() {
+  static ThreadPool pool;
+  return pool;
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(wake_mutex_);
+    stop_ = true;
+  }
+  wake_cv_.notify_all();
+
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+}
+
+void ThreadPool::push(const size_t queue_index, Task task) {
+  // Count the task before it becomes visible so that the counter never underflows.
+  pending_.fetch_add(1u, std::memory_order_acq_rel);
+
+  {
+    std::lock_guard<std::mutex> lock(queues_[queue_index]->mutex);
+    queues_[queue_index]->tasks.emplace_back(std::move(task));
+  }
+
+  // Lock is required so that the worker cannot miss the notification between checking the predicate and waiting.
+  { std::lock_guard<std::mutex> lock(wake_mutex_); }
+  wake_cv_.notify_one();
+}
+
+bool ThreadPool::acquire(const size_t slot, Task& task) {
+  // Own queue is processed in LIFO order to keep the working set hot.
+  {
+    WorkerQueue& own = *queues_[slot];
+    std::lock_guard<std::mutex> lock(own.mutex);
+    if (!own.tasks.empty()) {
+      task = std::move(own.tasks.back());
+      own.tasks.pop_back();
+      pending_.fetch_sub(1u, std::memory_order_acq_rel);
+      return true;
+    }
+  }
+
+  // Steal the oldest task from other queues.
+  for (size_t i = 1u; i < queues_.size(); i++) {
+    WorkerQueue& victim = *queues_[(slot + i) % queues_.size()];
+    std::lock_guard<std::mutex> lock(victim.mutex);
+    if (!victim.tasks.empty()) {
+      task = std::move(victim.tasks.front());
+      victim.tasks.pop_front();
+      pending_.fetch_sub(1u, std::memory_order_acq_rel);
+      return true;
+    }
+  }
+
+  return false;
+}
+
+size_t ThreadPool::currentSlot() const {
+  return (t_current_pool_ == this) ? t_current_slot_ : numThreads();
+}
+
+void ThreadPool::workerLoop(const size_t slot) {
+  t_current_pool_ = this;
+  t_current_slot_ = slot;
+
+  Task task;
+  while (true) {
+    if (acquire(slot, task)) {
+      task(slot);
+      task = nullptr;
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(wake_mutex_);
+    wake_cv_.wait(lock, [this]() { return stop_ || pending_.load(std::memory_order_acquire) > 0u; });
+
+    if (stop_ && pending_.load(std::memory_order_acquire) == 0u) {
+      return;
+    }
+  }
+}
+
+} // namespace lsg
@@ -17,18 +17,52 @@
  */
 
 #include "lsg/core/VersionTracker.h"
+#include <algorithm>
+#include "lsg/core/ChangeJournal.h"
 
 namespace lsg {
 
-VersionTracker::VersionTracker()
-  : version_(0u) {}
+VersionTracker::VersionTracker() : version_(0u) {}
+
+VersionTracker::VersionTracker(const VersionTracker& other) : version_(other.version_) {}
+
+VersionTracker& VersionTracker::operator=(const VersionTracker& other) {
+  version_ = other.version_;
+  return *this;
+}
 
 void VersionTracker::incrementVersion() {
-	version_++;
+  version_++;
+  ChangeJournal::recordResourceChange(*this);
+  notifyDependents();
 }
 
 size_t VersionTracker::version() const {
-	return version_;
+  return version_;
+}
+
+void VersionTracker::addDependent(VersionTracker& dependent) const {
+  std::lock_guard<std::mutex> lock(dependents_mutex_);
+  dependents_.emplace_back(&dependent);
 }
 
+void VersionTracker::removeDependent(VersionTracker& dependent) const {
+  std::lock_guard<std::mutex> lock(dependents_mutex_);
+  auto it = std::find(dependents_.begin(), dependents_.end(), &dependent);
+  if (it != dependents_.end()) {
+    dependents_.erase(it);
+  }
 }
+
+void VersionTracker::onDependencyChanged(const VersionTracker&) {
+  notifyDependents();
+}
+
+void VersionTracker::notifyDependents() const {
+  std::lock_guard<std::mutex> lock(dependents_mutex_);
+  for (VersionTracker* dependent : dependents_) {
+    dependent->onDependencyChanged(*this);
+  }
+}
+
+} // namespace lsg
@@ -0,0 +1,129 @@
+/**
+ * Project LogiSceneGraph source code
+ * Copyright (C) 2019 Primoz Lavric
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "lsg/render/InstanceBatcher.h"
+#include <functional>
+#include <unordered_map>
+#include <utility>
+
+namespace lsg {
+
+void InstanceBatcher::update(std::shared_ptr<const SceneSnapshot> snapshot) {
+  const bool same_structure = snapshot_ && snapshot && snapshot_->structureVersion() == snapshot->structureVersion();
+  const bool consecutive = same_structure && snapshot->previousVersion() == snapshot_->version();
+  snapshot_ = std::move(snapshot);
+  updated_instances_ = 0u;
+
+  if (!same_structure) {
+    rebuild();
+    return;
+  }
+
+  // Structure is unchanged, so objects and sub-meshes kept their indices. Modified objects are relative to the
+  // snapshot the new one was compiled from, so all matrices are rewritten if a snapshot was skipped.
+  if (consecutive) {
+    for (const uint32_t object : snapshot_->modifiedObjects()) {
+      updateObject(object);
+    }
+  } else {
+    for (uint32_t object = 0u; object < snapshot_->objectCount(); object++) {
+      updateObject(object);
+    }
+  }
+}
+
+void InstanceBatcher::updateObject(const uint32_t object) {
+  const SceneSnapshot& scene = *snapshot_;
+  for (uint32_t i = scene.subMeshOffsets()[object]; i < scene.subMeshOffsets()[object + 1u]; i++) {
+    if (sub_mesh_batches_[i] != k_no_batch) {
+      batches_[sub_mesh_batches_[i]].world_matrices[sub_mesh_slots_[i]] = scene.worldMatrices()[object];
+      updated_instances_++;
+    }
+  }
+}
+
+void InstanceBatcher::rebuild() {
+  batches_.clear();
+  sub_mesh_batches_.clear();
+  sub_mesh_slots_.clear();
+  instance_count_ = 0u;
+
+  if (!snapshot_) {
+    return;
+  }
+
+  struct KeyHash {
+    size_t operator()(const std::pair<const Geometry*, const Material*>& key) const {
+      const size_t geometry_hash = std::hash<const Geometry*>()(key.first);
+      return geometry_hash ^ (std::hash<const Material*>()(key.second) + 0x9e3779b9u + (geometry_hash << 6u) +
+                              (geometry_hash >> 2u));
+    }
+  };
+
+  const SceneSnapshot& scene = *snapshot_;
+  std::unordered_map<std::pair<const Geometry*, const Material*>, uint32_t, KeyHash> batch_indices;
+  sub_mesh_batches_.resize(scene.subMeshCount(), k_no_batch);
+  sub_mesh_slots_.resize(scene.subMeshCount(), 0u);
+
+  for (size_t i = 0u; i < scene.subMeshCount(); i++) {
+    const uint32_t object = scene.subMeshObjects()[i];
+    const Geometry* geometry = scene.geometries()[i].get();
+    const Material* material = scene.materials()[i].get();
+
+    if (geometry == nullptr || scene.activeFlags()[object] == 0u) {
+      continue;
+    }
+
+    const auto it = batch_indices.emplace(std::make_pair(geometry, material), static_cast<uint32_t>(batches_.size()));
+    if (it.second) {
+      batches_.push_back({geometry, material, {}, {}});
+    }
+
+    InstanceBatch& batch = batches_[it.first->second];
+    sub_mesh_batches_[i] = it.first->second;
+    sub_mesh_slots_[i] = static_cast<uint32_t>(batch.objects.size());
+    batch.world_matrices.emplace_back(scene.worldMatrices()[object]);
+    batch.objects.emplace_back(object);
+    instance_count_++;
+  }
+
+  updated_instances_ = instance_count_;
+}
+
+const std::vector<InstanceBatch>& InstanceBatcher::batches() const {
+  return batches_;
+}
+
+size_t InstanceBatcher::instanceCount() const {
+  return instance_count_;
+}
+
+size_t InstanceBatcher::updatedInstanceCount() const {
+  return updated_instances_;
+}
+
+const std::shared_ptr<const SceneSnapshot>& InstanceBatcher::snapshot() const {
+  return snapshot_;
+}
+
+void InstanceBatcher::clear() {
+  snapshot_.reset();
+  rebuild();
+}
+
+} // namespace lsg
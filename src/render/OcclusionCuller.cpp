@@ -0,0 +1,352 @@
+/**
+ * Project LogiSceneGraph source code
+ * Copyright (C) 2019 Primoz Lavric
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "lsg/render/OcclusionCuller.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "lsg/components/Mesh.h"
+#include "lsg/components/PerspectiveCamera.h"
+#include "lsg/components/Transform.h"
+#include "lsg/core/Exceptions.h"
+
+namespace lsg {
+
+OcclusionCuller::OcclusionCuller(const uint32_t width, const uint32_t height)
+  : width_(width), height_(height), occluder_threshold_(0.02f), occluder_count_(0u), view_projection_(1.0f) {
+  throwIf<InvalidArgument>(width == 0u || height == 0u, "Occlusion depth buffer must not be empty.");
+
+  glm::uvec2 size(width, height);
+  level_sizes_.emplace_back(size);
+  while (size.x > 1u || size.y > 1u) {
+    size = glm::uvec2((size.x + 1u) / 2u, (size.y + 1u) / 2u);
+    level_sizes_.emplace_back(size);
+  }
+
+  levels_.resize(level_sizes_.size());
+  for (size_t level = 0u; level < levels_.size(); level++) {
+    levels_[level].assign(size_t(level_sizes_[level].x) * level_sizes_[level].y, 1.0f);
+  }
+}
+
+uint32_t OcclusionCuller::width() const {
+  return width_;
+}
+
+uint32_t OcclusionCuller::height() const {
+  return height_;
+}
+
+void OcclusionCuller::setOccluderThreshold(const float fraction) {
+  occluder_threshold_ = fraction;
+}
+
+float OcclusionCuller::occluderThreshold() const {
+  return occluder_threshold_;
+}
+
+void OcclusionCuller::clear(const glm::mat4& view_projection) {
+  view_projection_ = view_projection;
+
+  for (std::vector<float>& level : levels_) {
+    std::fill(level.begin(), level.end(), 1.0f);
+  }
+}
+
+void OcclusionCuller::rasterize(const Geometry& geometry, const glm::mat4& world_matrix) {
+  if (!geometry.hasVertices()) {
+    return;
+  }
+
+  const glm::mat4 matrix = view_projection_ * world_matrix;
+  Ref<TriangleAccessor<glm::vec3>> triangles = geometry.getTrianglePositionAccessor();
+
+  for (size_t i = 0u; i < triangles->count(); i++) {
+    const Triangle<glm::vec3> triangle = (*triangles)[i];
+    rasterizeClipped(matrix * glm::vec4(triangle.a(), 1.0f), matrix * glm::vec4(triangle.b(), 1.0f),
+                     matrix * glm::vec4(triangle.c(), 1.0f));
+  }
+}
+
+void OcclusionCuller::buildHierarchy() {
+  for (size_t level = 1u; level < levels_.size(); level++) {
+    const glm::uvec2 source_size = level_sizes_[level - 1u];
+    const glm::uvec2 size = level_sizes_[level];
+    const std::vector<float>& source = levels_[level - 1u];
+    std::vector<float>& target = levels_[level];
+
+    for (uint32_t y = 0u; y < size.y; y++) {
+      const uint32_t y0 = y * 2u;
+      const uint32_t y1 = std::min(y0 + 1u, source_size.y - 1u);
+
+      for (uint32_t x = 0u; x < size.x; x++) {
+        const uint32_t x0 = x * 2u;
+        const uint32_t x1 = std::min(x0 + 1u, source_size.x - 1u);
+
+        target[size_t(y) * size.x + x] =
+          std::max(std::max(source[size_t(y0) * source_size.x + x0], source[size_t(y0) * source_size.x + x1]),
+                   std::max(source[size_t(y1) * source_size.x + x0], source[size_t(y1) * source_size.x + x1]));
+      }
+    }
+  }
+}
+
+bool OcclusionCuller::isOccluded(const AABB<float>& world_bounds) const {
+  const ScreenRect rect = project(world_bounds);
+  if (rect.crosses_near || rect.max.x < 0.0f || rect.max.y < 0.0f || rect.min.x >= static_cast<float>(width_) ||
+      rect.min.y >= static_cast<float>(height_)) {
+    return false;
+  }
+
+  const auto x0 = static_cast<uint32_t>(std::max(rect.min.x, 0.0f));
+  const auto y0 = static_cast<uint32_t>(std::max(rect.min.y, 0.0f));
+  const uint32_t x1 = std::min(static_cast<uint32_t>(rect.max.x), width_ - 1u);
+  const uint32_t y1 = std::min(static_cast<uint32_t>(rect.max.y), height_ - 1u);
+
+  // Pick the level at which the rectangle spans at most two texels per axis.
+  size_t level = 0u;
+  while (level + 1u < levels_.size() &&
+         (((x1 >> level) - (x0 >> level)) > 1u || ((y1 >> level) - (y0 >> level)) > 1u)) {
+    level++;
+  }
+
+  const std::vector<float>& depth = levels_[level];
+  const uint32_t level_width = level_sizes_[level].x;
+  float max_depth = 0.0f;
+
+  for (uint32_t y = y0 >> level; y <= (y1 >> level); y++) {
+    for (uint32_t x = x0 >> level; x <= (x1 >> level); x++) {
+      max_depth = std::max(max_depth, depth[size_t(y) * level_width + x]);
+    }
+  }
+
+  return rect.min_depth > max_depth;
+}
+
+float OcclusionCuller::screenCoverage(const AABB<float>& world_bounds) const {
+  const ScreenRect rect = project(world_bounds);
+  if (rect.crosses_near) {
+    return 1.0f;
+  }
+
+  const float width = std::min(rect.max.x, static_cast<float>(width_)) - std::max(rect.min.x, 0.0f);
+  const float height = std::min(rect.max.y, static_cast<float>(height_)) - std::max(rect.min.y, 0.0f);
+  if (width <= 0.0f || height <= 0.0f) {
+    return 0.0f;
+  }
+
+  return (width * height) / (static_cast<float>(width_) * static_cast<float>(height_));
+}
+
+void OcclusionCuller::cull(Scene& scene, Object& camera_object, std::vector<VisibleSubMesh>& visible,
+                           ThreadPool& executor) {
+  PerspectiveCamera* camera = camera_object.findComponent<PerspectiveCamera>();
+  throwIf<InvalidArgument>(camera == nullptr, "Occlusion culling requires an object with a perspective camera.");
+
+  scene.cull(camera_object, visible, executor);
+
+  Transform* camera_transform = camera_object.nearestTransform();
+  const glm::mat4 view =
+    (camera_transform != nullptr) ? glm::inverse(camera_transform->worldMatrix()) : glm::mat4(1.0f);
+  clear(camera->projectionMatrix() * view);
+  occluder_count_ = 0u;
+
+  // Sub-meshes of an object are consecutive in the output of the frustum culling.
+  for (size_t i = 0u; i < visible.size(); i++) {
+    Object& object = *visible[i].object;
+    if (i > 0u && visible[i - 1u].object == &object) {
+      continue;
+    }
+
+    const float coverage = screenCoverage(object.worldBounds());
+    Transform* transform = object.nearestTransform();
+    const glm::mat4 world_matrix = (transform != nullptr) ? transform->worldMatrix() : glm::mat4(1.0f);
+    bool occluder = false;
+
+    for (Mesh& mesh : object.getComponents<Mesh>()) {
+      const OccluderHint hint = mesh.occluderHint();
+      if (hint == OccluderHint::kNever || (hint == OccluderHint::kAuto && coverage < occluder_threshold_)) {
+        continue;
+      }
+
+      for (const Ref<SubMesh>& sub_mesh : mesh.subMeshes()) {
+        if (sub_mesh->geometry()) {
+          rasterize(*sub_mesh->geometry(), world_matrix);
+          occluder = true;
+        }
+      }
+    }
+
+    occluder_count_ += occluder ? 1u : 0u;
+  }
+
+  buildHierarchy();
+
+  // Bounds are cached by the frustum culling, so they are gathered serially and only tested in parallel.
+  std::vector<AABB<float>> bounds(visible.size());
+  for (size_t i = 0u; i < visible.size(); i++) {
+    bounds[i] = visible[i].object->worldBounds();
+  }
+
+  std::vector<uint8_t> occluded(visible.size());
+  executor.parallelFor(visible.size(), 256u, [&](const size_t begin, const size_t end, size_t) {
+    for (size_t i = begin; i < end; i++) {
+      occluded[i] = static_cast<uint8_t>(isOccluded(bounds[i]));
+    }
+  });
+
+  size_t count = 0u;
+  for (size_t i = 0u; i < visible.size(); i++) {
+    if (occluded[i] == 0u) {
+      visible[count++] = visible[i];
+    }
+  }
+  visible.resize(count);
+}
+
+size_t OcclusionCuller::occluderCount() const {
+  return occluder_count_;
+}
+
+size_t OcclusionCuller::levelCount() const {
+  return levels_.size();
+}
+
+const std::vector<float>& OcclusionCuller::depth(const size_t level) const {
+  throwIf<OutOfRange>(level >= levels_.size(), "Occlusion depth level out of range.");
+  return levels_[level];
+}
+
+OcclusionCuller::ScreenRect OcclusionCuller::project(const AABB<float>& world_bounds) const {
+  ScreenRect rect {glm::vec2(std::numeric_limits<float>::max()), glm::vec2(std::numeric_limits<float>::lowest()),
+                   std::numeric_limits<float>::max(), false};
+
+  for (uint32_t corner = 0u; corner < 8u; corner++) {
+    const glm::vec3 point((corner & 1u) ? world_bounds.max().x : world_bounds.min().x,
+                          (corner & 2u) ? world_bounds.max().y : world_bounds.min().y,
+                          (corner & 4u) ? world_bounds.max().z : world_bounds.min().z);
+    const glm::vec4 clip = view_projection_ * glm::vec4(point, 1.0f);
+
+    if (clip.w <= 0.0f || clip.z + clip.w < 0.0f) {
+      rect.crosses_near = true;
+      return rect;
+    }
+
+    const float inv_w = 1.0f / clip.w;
+    const glm::vec2 screen((clip.x * inv_w * 0.5f + 0.5f) * static_cast<float>(width_),
+                           (clip.y * inv_w * 0.5f + 0.5f) * static_cast<float>(height_));
+    rect.min = glm::min(rect.min, screen);
+    rect.max = glm::max(rect.max, screen);
+    rect.min_depth = std::min(rect.min_depth, clip.z * inv_w * 0.5f + 0.5f);
+  }
+
+  return rect;
+}
+
+void OcclusionCuller::rasterizeClipped(const glm::vec4& a, const glm::vec4& b, const glm::vec4& c) {
+  // Clip against the near plane (z + w >= 0), which produces at most four vertices.
+  const glm::vec4 input[3] = {a, b, c};
+  glm::vec4 polygon[4];
+  size_t count = 0u;
+
+  for (size_t i = 0u; i < 3u; i++) {
+    const glm::vec4& current = input[i];
+    const glm::vec4& next = input[(i + 1u) % 3u];
+    const float current_distance = current.z + current.w;
+    const float next_distance = next.z + next.w;
+
+    if (current_distance >= 0.0f) {
+      polygon[count++] = current;
+    }
+    if ((current_distance >= 0.0f) != (next_distance >= 0.0f)) {
+      const float t = current_distance / (current_distance - next_distance);
+      polygon[count++] = current + (next - current) * t;
+    }
+  }
+
+  if (count < 3u) {
+    return;
+  }
+
+  glm::vec3 screen[4];
+  for (size_t i = 0u; i < count; i++) {
+    const float inv_w = 1.0f / std::max(polygon[i].w, std::numeric_limits<float>::min());
+    screen[i] = glm::vec3((polygon[i].x * inv_w * 0.5f + 0.5f) * static_cast<float>(width_),
+                          (polygon[i].y * inv_w * 0.5f + 0.5f) * static_cast<float>(height_),
+                          polygon[i].z * inv_w * 0.5f + 0.5f);
+  }
+
+  for (size_t i = 2u; i < count; i++) {
+    rasterizeTriangle(screen[0], screen[i - 1u], screen[i]);
+  }
+}
+
+void OcclusionCuller::rasterizeTriangle(const glm::vec3& a, glm::vec3 b, glm::vec3 c) {
+  float area = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+  if (!(std::abs(area) > 0.0f)) {
+    return;
+  }
+
+  // Both windings are rasterized.
+  if (area < 0.0f) {
+    std::swap(b, c);
+    area = -area;
+  }
+
+  // Pixels whose centers lie inside the triangle.
+  const float min_x = std::max(std::ceil(std::min({a.x, b.x, c.x}) - 0.5f), 0.0f);
+  const float min_y = std::max(std::ceil(std::min({a.y, b.y, c.y}) - 0.5f), 0.0f);
+  const float max_x = std::min(std::floor(std::max({a.x, b.x, c.x}) - 0.5f), static_cast<float>(width_) - 1.0f);
+  const float max_y = std::min(std::floor(std::max({a.y, b.y, c.y}) - 0.5f), static_cast<float>(height_) - 1.0f);
+  if (min_x > max_x || min_y > max_y) {
+    return;
+  }
+
+  // Edge functions are positive inside the triangle and proportional to the barycentric coordinates of the opposite
+  // vertex. Depth is affine in screen space.
+  const glm::vec2 edge_bc(b.y - c.y, c.x - b.x);
+  const glm::vec2 edge_ca(c.y - a.y, a.x - c.x);
+  const glm::vec2 edge_ab(a.y - b.y, b.x - a.x);
+  const float inv_area = 1.0f / area;
+  const glm::vec2 depth_gradient = (edge_bc * a.z + edge_ca * b.z + edge_ab * c.z) * inv_area;
+
+  const auto x0 = static_cast<uint32_t>(min_x);
+  const auto count = static_cast<uint32_t>(max_x) - x0 + 1u;
+  const float start_x = min_x + 0.5f;
+  std::vector<float>& depth = levels_[0];
+
+  for (auto y = static_cast<uint32_t>(min_y); y <= static_cast<uint32_t>(max_y); y++) {
+    const float py = static_cast<float>(y) + 0.5f;
+    const float w0 = edge_bc.x * (start_x - b.x) + edge_bc.y * (py - b.y);
+    const float w1 = edge_ca.x * (start_x - c.x) + edge_ca.y * (py - c.y);
+    const float w2 = edge_ab.x * (start_x - a.x) + edge_ab.y * (py - a.y);
+    const float row_depth = a.z + depth_gradient.x * (start_x - a.x) + depth_gradient.y * (py - a.y);
+    float* row = depth.data() + size_t(y) * width_ + x0;
+
+    // Branchless so that the compiler vectorizes the span.
+    for (uint32_t x = 0u; x < count; x++) {
+      const float fx = static_cast<float>(x);
+      const bool inside =
+        (w0 + fx * edge_bc.x >= 0.0f) & (w1 + fx * edge_ca.x >= 0.0f) & (w2 + fx * edge_ab.x >= 0.0f);
+      const float pixel_depth = row_depth + fx * depth_gradient.x;
+      row[x] = inside ? std::min(row[x], pixel_depth) : row[x];
+    }
+  }
+}
+
+} // namespace lsg
@@ -0,0 +1,165 @@
+/**
+ * Project LogiSceneGraph source code
+ * Copyright (C) 2019 Primoz Lavric
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "lsg/render/RenderList.h"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <utility>
+
+namespace lsg {
+
+void RenderList::extract(std::shared_ptr<const SceneSnapshot> snapshot, const glm::vec3& view_position,
+                         ThreadPool& executor) {
+  snapshot_ = std::move(snapshot);
+  items_.clear();
+  batches_.clear();
+
+  if (!snapshot_) {
+    return;
+  }
+
+  const SceneSnapshot& scene = *snapshot_;
+  unsorted_items_.resize(scene.subMeshCount());
+
+  executor.parallelFor(scene.subMeshCount(), 1024u, [&](const size_t begin, const size_t end, size_t) {
+    for (size_t i = begin; i < end; i++) {
+      DrawItem& item = unsorted_items_[i];
+      const uint32_t object = scene.subMeshObjects()[i];
+      item.object = object;
+      item.geometry = scene.geometries()[i].get();
+      item.material = scene.materials()[i].get();
+
+      // Skipped items are marked by a missing geometry.
+      if (item.geometry == nullptr || scene.activeFlags()[object] == 0u) {
+        item.geometry = nullptr;
+        continue;
+      }
+
+      item.world_matrix = scene.worldMatrices()[object];
+      item.bounds = item.geometry->getBoundingBox().transform(item.world_matrix);
+
+      const glm::vec3 offset = item.bounds.center() - view_position;
+      item.key = makeSortKey(item.material, item.geometry, glm::dot(offset, offset));
+    }
+  });
+
+  keys_.clear();
+  indices_.clear();
+  for (size_t i = 0u; i < unsorted_items_.size(); i++) {
+    if (unsorted_items_[i].geometry != nullptr) {
+      keys_.emplace_back(unsorted_items_[i].key);
+      indices_.emplace_back(static_cast<uint32_t>(i));
+    }
+  }
+
+  radixSort(keys_, indices_, keys_scratch_, indices_scratch_);
+
+  items_.resize(indices_.size());
+  executor.parallelFor(indices_.size(), 4096u, [&](const size_t begin, const size_t end, size_t) {
+    for (size_t i = begin; i < end; i++) {
+      items_[i] = unsorted_items_[indices_[i]];
+    }
+  });
+
+  for (size_t i = 0u; i < items_.size(); i++) {
+    if (batches_.empty() || items_[i].geometry != items_[i - 1u].geometry ||
+        items_[i].material != items_[i - 1u].material) {
+      batches_.push_back({static_cast<uint32_t>(i), 0u});
+    }
+    batches_.back().count++;
+  }
+}
+
+uint64_t RenderList::makeSortKey(const Material* material, const Geometry* geometry, const float depth) {
+  constexpr uint64_t k_material_mask = (uint64_t(1u) << k_material_key_bits) - 1u;
+  constexpr uint64_t k_geometry_mask = (uint64_t(1u) << k_geometry_key_bits) - 1u;
+
+  uint32_t depth_bits = 0u;
+  const float clamped_depth = std::max(depth, 0.0f);
+  std::memcpy(&depth_bits, &clamped_depth, sizeof(depth_bits));
+
+  const uint64_t material_id = (material != nullptr) ? (material->id() & k_material_mask) : 0u;
+  const uint64_t geometry_id = (geometry != nullptr) ? (geometry->id() & k_geometry_mask) : 0u;
+
+  return (material_id << (k_geometry_key_bits + k_depth_key_bits)) | (geometry_id << k_depth_key_bits) |
+         (depth_bits >> (32u - k_depth_key_bits));
+}
+
+const std::vector<DrawItem>& RenderList::items() const {
+  return items_;
+}
+
+const std::vector<DrawBatch>& RenderList::batches() const {
+  return batches_;
+}
+
+const std::shared_ptr<const SceneSnapshot>& RenderList::snapshot() const {
+  return snapshot_;
+}
+
+void RenderList::clear() {
+  snapshot_.reset();
+  items_.clear();
+  batches_.clear();
+  unsorted_items_.clear();
+}
+
+void RenderList::radixSort(std::vector<uint64_t>& keys, std::vector<uint32_t>& values,
+                           std::vector<uint64_t>& keys_scratch, std::vector<uint32_t>& values_scratch) {
+  constexpr size_t k_num_passes = sizeof(uint64_t);
+  constexpr size_t k_num_buckets = 256u;
+
+  // Histograms of all digits are built in a single pass over the keys.
+  std::array<std::array<size_t, k_num_buckets>, k_num_passes> histograms {};
+  for (const uint64_t key : keys) {
+    for (size_t pass = 0u; pass < k_num_passes; pass++) {
+      histograms[pass][(key >> (pass * 8u)) & 0xFFu]++;
+    }
+  }
+
+  keys_scratch.resize(keys.size());
+  values_scratch.resize(values.size());
+
+  for (size_t pass = 0u; pass < k_num_passes; pass++) {
+    std::array<size_t, k_num_buckets>& histogram = histograms[pass];
+    const uint64_t digit = keys.empty() ? 0u : (keys.front() >> (pass * 8u)) & 0xFFu;
+
+    if (histogram[digit] == keys.size()) {
+      continue;
+    }
+
+    size_t offset = 0u;
+    for (size_t& count : histogram) {
+      const size_t bucket_size = count;
+      count = offset;
+      offset += bucket_size;
+    }
+
+    for (size_t i = 0u; i < keys.size(); i++) {
+      const size_t position = histogram[(keys[i] >> (pass * 8u)) & 0xFFu]++;
+      keys_scratch[position] = keys[i];
+      values_scratch[position] = values[i];
+    }
+
+    keys.swap(keys_scratch);
+    values.swap(values_scratch);
+  }
+}
+
+} // namespace lsg
@@ -17,6 +17,9 @@
  */
 
 #include "lsg/resources/Geometry.h"
+#include <chrono>
+#include "lsg/accelerators/BVH/BVHBuilder.h"
+#include "lsg/core/ThreadPool.h"
 
 namespace lsg {
 
@@ -25,6 +28,7 @@ Geometry::Geometry() : Identifiable("Geometry") {}
 void Geometry::setIndices(const BufferAccessor& indices) {
   throwIf<InvalidArgument>(indices.count() % 3u != 0u, "Tried to set triangle indices that are not multiple of 3.");
   indices_ = indices;
+  incrementVersion();
 }
 
 void Geometry::setVertices(const TBufferAccessor<glm::vec3>& vertices) {
@@ -35,6 +39,8 @@ void Geometry::setVertices(const TBufferAccessor<glm::vec3>& vertices) {
   for (size_t i = 0; i < vertices_->count(); i++) {
     bounding_box_.expand((*vertices_)[i]);
   }
+
+  incrementVersion();
 }
 
 void Geometry::setNormals(const TBufferAccessor<glm::vec3>& normals) {
@@ -86,6 +92,7 @@ const AABB<float>& Geometry::getBoundingBox() const {
 void Geometry::clearVertices() {
   vertices_.reset();
   bounding_box_.reset();
+  incrementVersion();
 }
 
 void Geometry::clearNormals() {
@@ -94,6 +101,7 @@ void Geometry::clearNormals() {
 
 void Geometry::clearIndices() {
   indices_.reset();
+  incrementVersion();
 }
 
 void Geometry::clearTangents() {
@@ -219,4 +227,63 @@ Ref<TriangleAccessor<glm::vec4>> Geometry::getTriangleTangentAccessor() const {
   return makeRef<TriAccessor<glm::vec4>>(tangents_.value());
 }
 
+Ref<BVH<float>> Geometry::bvh(const bvh::BVHConfig& config, const bvh::SAHFunction& sah_function) const {
+  // The build is published through a shared future so that concurrent first requests wait for a single build without
+  // holding the mutex.
+  std::shared_future<Ref<BVH<float>>> build;
+  std::promise<Ref<BVH<float>>> promise;
+  size_t generation = 0u;
+
+  {
+    std::lock_guard<std::mutex> lock(bvh_cache_.mutex);
+
+    if (bvh_cache_.build.valid() && bvh_cache_.version == version() && bvh_cache_.config == config &&
+        bvh_cache_.sah_function == sah_function) {
+      build = bvh_cache_.build;
+    } else {
+      generation = ++bvh_cache_.generation;
+      bvh_cache_.build = promise.get_future().share();
+      bvh_cache_.version = version();
+      bvh_cache_.config = config;
+      bvh_cache_.sah_function = sah_function;
+    }
+  }
+
+  if (!build.valid()) {
+    // The build runs on the calling thread. Waiting for pool tasks would let this thread pick up tasks that request
+    // the same BVH and wait for the build they are nested in.
+    Ref<BVH<float>> result;
+    try {
+      result = bvh::BVHBuilder<float>(sah_function, config).process(*this, nullptr);
+    } catch (...) {
+      promise.set_exception(std::current_exception());
+
+      // Failed builds are dropped so that the next request retries.
+      std::lock_guard<std::mutex> lock(bvh_cache_.mutex);
+      if (bvh_cache_.generation == generation) {
+        bvh_cache_.build = {};
+      }
+      throw;
+    }
+
+    promise.set_value(result);
+    return result;
+  }
+
+  // Waiting workers keep executing tasks, so the pool cannot run out of threads while the build is pending.
+  ThreadPool::global().helpUntil(
+      [&build]() { return build.wait_for(std::chrono::seconds(0)) == std::future_status::ready; });
+
+  return build.get();
+}
+
+Geometry::BVHCache::BVHCache(const BVHCache&) {}
+
+Geometry::BVHCache& Geometry::BVHCache::operator=(const BVHCache&) {
+  std::lock_guard<std::mutex> lock(mutex);
+  build = {};
+  generation++;
+  return *this;
+}
+
 } // namespace lsg
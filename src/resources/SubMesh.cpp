@@ -21,18 +21,32 @@
 namespace lsg {
 
 SubMesh::SubMesh(const std::string& name, const Ref<Geometry>& geometry, const Ref<Material>& material)
-  : Identifiable(name), geometry_(geometry), material_(material) {}
+  : Identifiable(name), geometry_(geometry), material_(material) {
+  addDependencies();
+}
 
 SubMesh::SubMesh(const Ref<Geometry>& geometry, const Ref<Material>& material)
-  : Identifiable("Submesh"), geometry_(geometry), material_(material) {}
+  : Identifiable("Submesh"), geometry_(geometry), material_(material) {
+  addDependencies();
+}
+
+SubMesh::SubMesh(const SubMesh& other)
+  : Identifiable(other), RefCounter(other), VersionTracker(other), geometry_(other.geometry_),
+    material_(other.material_) {
+  addDependencies();
+}
 
 void SubMesh::setGeometry(const Ref<Geometry>& geometry) {
+  removeDependencies();
   geometry_ = geometry;
+  addDependencies();
   incrementVersion();
 }
 
 void SubMesh::setMaterial(const Ref<Material>& material) {
+  removeDependencies();
   material_ = material;
+  addDependencies();
   incrementVersion();
 }
 
@@ -44,4 +58,26 @@ const Ref<Material>& SubMesh::material() const {
   return material_;
 }
 
+void SubMesh::addDependencies() {
+  if (geometry_) {
+    geometry_->addDependent(*this);
+  }
+  if (material_) {
+    material_->addDependent(*this);
+  }
+}
+
+void SubMesh::removeDependencies() {
+  if (geometry_) {
+    geometry_->removeDependent(*this);
+  }
+  if (material_) {
+    material_->removeDependent(*this);
+  }
+}
+
+SubMesh::~SubMesh() {
+  removeDependencies();
+}
+
 } // namespace lsg
@@ -1,6 +1,8 @@
 #include <gtest/gtest.h>
+#include <algorithm>
 #include "lsg/accelerators/BVH/BVH.h"
 #include "lsg/accelerators/BVH/BVHBuilder.h"
+#include "lsg/accelerators/BVH/SplitBVHBuilder.h"
 #include "lsg/math/AABB.h"
 
 using namespace lsg;
@@ -26,4 +28,178 @@ TEST(BVH, RayIntersection) {
   Ray<float> ray({2.0f, 2.0f, 2.0f}, {3.5f, 3.5f, 3.5f});
 
   testRayIntersection(boxes, ray);
-}
\ No newline at end of file
+}
+
+TEST(BVH, BatchRayIntersection) {
+  std::vector<AABB<float>> boxes;
+  for (size_t x = 0; x < 8; x++) {
+    for (size_t y = 0; y < 8; y++) {
+      for (size_t z = 0; z < 8; z++) {
+        const glm::vec3 min(x * 2.0f, y * 2.0f, z * 2.0f);
+        boxes.emplace_back(min, min + glm::vec3(1.0f));
+      }
+    }
+  }
+
+  bvh::BVHBuilder<float> builder(bvh::SAHFunction("test", 1.0, 1.0, 1u, 1u));
+  Ref<BVH<float>> tree = builder.process(boxes);
+
+  std::vector<Ray<float>> rays;
+  for (size_t i = 0; i < 500; i++) {
+    const glm::vec3 origin(-5.0f, float(i % 17), float(i % 13));
+    rays.emplace_back(origin, glm::vec3(1.0f, (float(i % 7) - 3.0f) * 0.1f, (float(i % 5) - 2.0f) * 0.1f));
+  }
+
+  auto intersect_box = [&boxes](const Ray<float>& ray, uint32_t prim_index) {
+    return ray.intersectAABBDistance(boxes[prim_index]);
+  };
+
+  ThreadPool pool(4);
+  std::vector<BVH<float>::Hit> hits;
+  tree->intersectBatch(rays, hits, intersect_box, pool, 16u);
+  ASSERT_EQ(hits.size(), rays.size());
+
+  // Compare with brute force closest hit.
+  for (size_t i = 0; i < rays.size(); i++) {
+    float closest = std::numeric_limits<float>::max();
+    for (uint32_t j = 0; j < boxes.size(); j++) {
+      std::optional<float> distance = intersect_box(rays[i], j);
+      if (distance.has_value()) {
+        closest = std::min(closest, distance.value());
+      }
+    }
+
+    EXPECT_EQ(hits[i].distance, closest);
+    EXPECT_EQ(hits[i].prim_index == BVH<float>::Hit::k_invalid_index, closest == std::numeric_limits<float>::max());
+  }
+}
+
+Geometry createGridGeometry(size_t grid_size) {
+  std::vector<glm::vec3> vertices;
+  std::vector<uint32_t> indices;
+
+  for (size_t x = 0; x <= grid_size; x++) {
+    for (size_t y = 0; y <= grid_size; y++) {
+      vertices.emplace_back(float(x), float(y), float((x * 7 + y * 3) % 5));
+    }
+  }
+
+  for (uint32_t x = 0; x < grid_size; x++) {
+    for (uint32_t y = 0; y < grid_size; y++) {
+      const uint32_t i = x * (grid_size + 1) + y;
+      indices.insert(indices.end(), {i, i + 1, i + uint32_t(grid_size) + 1});
+      indices.insert(indices.end(), {i + 1, i + uint32_t(grid_size) + 2, i + uint32_t(grid_size) + 1});
+    }
+  }
+
+  Geometry geometry;
+  geometry.setVertices(TBufferAccessor<glm::vec3>(BufferView(makeRef<Buffer>(vertices), sizeof(glm::vec3)),
+                                                  StructureType::kVec3, ComponentType::kFloat));
+  geometry.setIndices(BufferAccessor(BufferView(makeRef<Buffer>(indices), sizeof(uint32_t)), StructureType::kScalar,
+                                     ComponentType::kUnsignedInt));
+  return geometry;
+}
+
+TEST(BVH, BuildFromGeometry) {
+  Geometry geometry = createGridGeometry(32);
+  Ref<TriangleAccessor<glm::vec3>> triangles = geometry.getTrianglePositionAccessor();
+
+  std::vector<AABB<float>> boxes;
+  for (size_t i = 0; i < triangles->count(); i++) {
+    Triangle<glm::vec3> tri = (*triangles)[i];
+    boxes.emplace_back(glm::min(tri[0], glm::min(tri[1], tri[2])), glm::max(tri[0], glm::max(tri[1], tri[2])));
+  }
+
+  ThreadPool pool(4);
+  bvh::BVHBuilder<float> builder;
+  Ref<BVH<float>> from_geometry = builder.process(geometry, &pool);
+  Ref<BVH<float>> from_boxes = builder.process(boxes);
+
+  // Bounds are computed in parallel but must produce the same hierarchy.
+  ASSERT_EQ(from_geometry->getNodes().size(), from_boxes->getNodes().size());
+  EXPECT_EQ(from_geometry->getPrimitiveIndices(), from_boxes->getPrimitiveIndices());
+  EXPECT_EQ(builder.process(geometry, nullptr)->getPrimitiveIndices(), from_boxes->getPrimitiveIndices());
+
+  for (size_t i = 0; i < from_geometry->getNodes().size(); i++) {
+    EXPECT_EQ(from_geometry->getNodes()[i].bounds.min(), from_boxes->getNodes()[i].bounds.min());
+    EXPECT_EQ(from_geometry->getNodes()[i].bounds.max(), from_boxes->getNodes()[i].bounds.max());
+  }
+
+  bvh::SplitBVHBuilder<float> split_builder;
+  EXPECT_FALSE(split_builder.process(createGridGeometry(4))->getNodes().empty());
+}
+
+TEST(BVH, ScratchReuse) {
+  Geometry geometry = createGridGeometry(16);
+  Ref<bvh::BVHBuildScratch<float>> scratch = makeRef<bvh::BVHBuildScratch<float>>();
+
+  bvh::BVHBuilder<float> builder(bvh::SAHFunction(), bvh::BVHConfig(), scratch);
+  Ref<BVH<float>> first = builder.process(geometry);
+  const size_t node_capacity = scratch->nodes.capacity();
+  const size_t index_capacity = scratch->prim_indices.capacity();
+  EXPECT_GT(node_capacity, 0u);
+
+  // Rebuilding with the same scratch must not release or grow the memory.
+  bvh::BVHBuilder<float> other_builder(bvh::SAHFunction(), bvh::BVHConfig(), scratch);
+  Ref<BVH<float>> second = other_builder.process(geometry);
+  EXPECT_EQ(scratch->nodes.capacity(), node_capacity);
+  EXPECT_EQ(scratch->prim_indices.capacity(), index_capacity);
+  EXPECT_EQ(first->getPrimitiveIndices(), second->getPrimitiveIndices());
+
+  // Empty input produces an empty hierarchy.
+  EXPECT_TRUE(builder.process(std::vector<AABB<float>>())->getNodes().empty());
+}
+
+TEST(BVH, NodeLayouts) {
+  Geometry geometry = createGridGeometry(16);
+  Ref<TriangleAccessor<glm::vec3>> triangles = geometry.getTrianglePositionAccessor();
+
+  bvh::BVHConfig config;
+  config.node_layout = bvh::NodeLayout::kBuildOrder;
+  Ref<BVH<float>> build_order = bvh::BVHBuilder<float>(bvh::SAHFunction(), config).process(geometry);
+
+  std::vector<Ray<float>> rays;
+  for (size_t i = 0; i < 64; i++) {
+    rays.emplace_back(glm::vec3(float(i % 16) + 0.3f, float(i / 4) + 0.2f, 10.0f), glm::vec3(0.1f, 0.05f, -1.0f));
+  }
+
+  for (bvh::NodeLayout layout : {bvh::NodeLayout::kDepthFirst, bvh::NodeLayout::kVanEmdeBoas}) {
+    config.node_layout = layout;
+    Ref<BVH<float>> tree = bvh::BVHBuilder<float>(bvh::SAHFunction(), config).process(geometry);
+    const std::vector<BVH<float>::Node>& nodes = tree->getNodes();
+    ASSERT_EQ(nodes.size(), build_order->getNodes().size());
+    EXPECT_EQ(tree->getBounds().min(), build_order->getBounds().min());
+    EXPECT_EQ(tree->getBounds().max(), build_order->getBounds().max());
+
+    uint32_t next_prim = 0u;
+    for (size_t i = 0; i < nodes.size(); i++) {
+      if (nodes[i].is_leaf) {
+        // Primitive indices are stored in leaf order.
+        EXPECT_EQ(nodes[i].indices_range[0], next_prim);
+        next_prim = nodes[i].indices_range[1];
+        continue;
+      }
+
+      const BVH<float>::Node& left = nodes[nodes[i].child_indices[0]];
+      const BVH<float>::Node& right = nodes[nodes[i].child_indices[1]];
+      EXPECT_GT(nodes[i].child_indices[0], i);
+      EXPECT_GT(nodes[i].child_indices[1], i);
+
+      // Hotter child is stored right after its parent.
+      if (layout == bvh::NodeLayout::kDepthFirst) {
+        const uint32_t hot = right.bounds.area() > left.bounds.area() ? nodes[i].child_indices[1]
+                                                                       : nodes[i].child_indices[0];
+        EXPECT_EQ(hot, i + 1u);
+      }
+    }
+    EXPECT_EQ(next_prim, tree->getPrimitiveIndices().size());
+
+    for (const Ray<float>& ray : rays) {
+      std::vector<uint32_t> expected = build_order->rayIntersect(ray);
+      std::vector<uint32_t> actual = tree->rayIntersect(ray);
+      std::sort(expected.begin(), expected.end());
+      std::sort(actual.begin(), actual.end());
+      EXPECT_EQ(actual, expected);
+    }
+  }
+}
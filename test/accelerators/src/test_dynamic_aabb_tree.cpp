@@ -0,0 +1,163 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <set>
+#include <thread>
+#include <vector>
+#include "lsg/accelerators/DynamicAABBTree.h"
+#include "lsg/math/Frustum.h"
+
+using namespace lsg;
+
+namespace {
+
+AABB<float> randomBox(std::mt19937& rng) {
+  std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+  std::uniform_real_distribution<float> size(0.1f, 5.0f);
+  const glm::vec3 min(position(rng), position(rng), position(rng));
+  return {min, min + glm::vec3(size(rng), size(rng), size(rng))};
+}
+
+bool overlaps(const AABB<float>& lhs, const AABB<float>& rhs) {
+  return lhs.min().x <= rhs.max().x && rhs.min().x <= lhs.max().x && lhs.min().y <= rhs.max().y &&
+         rhs.min().y <= lhs.max().y && lhs.min().z <= rhs.max().z && rhs.min().z <= lhs.max().z;
+}
+
+} // namespace
+
+TEST(DynamicAABBTree, MatchesBruteForce) {
+  std::mt19937 rng(11u);
+  DynamicAABBTree<float, uint32_t> tree(0.5f);
+  std::vector<AABB<float>> boxes;
+  std::vector<DynamicAABBTree<float, uint32_t>::NodeId> ids;
+  std::vector<bool> alive;
+
+  for (uint32_t i = 0u; i < 2000u; i++) {
+    boxes.emplace_back(randomBox(rng));
+    ids.emplace_back(tree.insert(boxes.back(), i));
+    alive.emplace_back(true);
+  }
+
+  // Move and remove some of the entries.
+  for (uint32_t i = 0u; i < 2000u; i += 3u) {
+    boxes[i] = randomBox(rng);
+    tree.move(ids[i], boxes[i]);
+  }
+  for (uint32_t i = 1u; i < 2000u; i += 7u) {
+    tree.remove(ids[i]);
+    alive[i] = false;
+  }
+
+  EXPECT_EQ(tree.size(), static_cast<size_t>(std::count(alive.begin(), alive.end(), true)));
+  // Balanced tree height is logarithmic.
+  EXPECT_LE(tree.height(), 4u * static_cast<size_t>(std::log2(tree.size())));
+
+  for (size_t query = 0u; query < 20u; query++) {
+    AABB<float> box = randomBox(rng);
+    box.expand(box.max() + glm::vec3(20.0f));
+
+    std::set<uint32_t> found;
+    tree.queryBox(box, [&](DynamicAABBTree<float, uint32_t>::NodeId id, const uint32_t& data) {
+      EXPECT_EQ(tree.data(id), data);
+      found.insert(data);
+    });
+
+    std::set<uint32_t> expected;
+    for (uint32_t i = 0u; i < boxes.size(); i++) {
+      if (alive[i] && overlaps(boxes[i], box)) {
+        expected.insert(i);
+      }
+    }
+    EXPECT_EQ(found, expected);
+  }
+
+  const Ray<float> ray(glm::vec3(-200.0f, 0.0f, 0.0f), glm::vec3(1.0f, 0.05f, 0.02f));
+  std::set<uint32_t> ray_hits;
+  tree.queryRay(ray, 1000.0f, [&](auto, const uint32_t& data, float distance) {
+    EXPECT_GE(distance, 0.0f);
+    ray_hits.insert(data);
+  });
+  for (uint32_t i = 0u; i < boxes.size(); i++) {
+    EXPECT_EQ(alive[i] && ray.intersectAABBDistance(boxes[i]).has_value(), ray_hits.count(i) == 1u);
+  }
+
+  // Query stops when the callback returns false.
+  size_t visited = 0u;
+  tree.queryBox(AABB<float>(glm::vec3(-200.0f), glm::vec3(200.0f)), [&](auto, const uint32_t&) {
+    return ++visited < 5u;
+  });
+  EXPECT_EQ(visited, 5u);
+
+  tree.clear();
+  EXPECT_TRUE(tree.empty());
+  EXPECT_THROW(tree.bounds(ids[0]), OutOfRange);
+}
+
+TEST(DynamicAABBTree, SmallMovesKeepFatBounds) {
+  DynamicAABBTree<float, int> tree(1.0f);
+  const auto id = tree.insert(AABB<float>(glm::vec3(0.0f), glm::vec3(1.0f)), 7);
+
+  EXPECT_FALSE(tree.move(id, AABB<float>(glm::vec3(0.5f), glm::vec3(1.5f))));
+  EXPECT_EQ(tree.bounds(id).min(), glm::vec3(0.5f));
+  EXPECT_EQ(tree.fatBounds(id).min(), glm::vec3(-1.0f));
+
+  EXPECT_TRUE(tree.move(id, AABB<float>(glm::vec3(5.0f), glm::vec3(6.0f))));
+  EXPECT_EQ(tree.fatBounds(id).min(), glm::vec3(4.0f));
+}
+
+TEST(DynamicAABBTree, FrustumQuery) {
+  DynamicAABBTree<float, int> tree;
+  // Boxes along the negative z axis, the camera looks down the negative z axis.
+  for (int i = 0; i < 100; i++) {
+    const float z = -static_cast<float>(i) * 2.0f;
+    tree.insert(AABB<float>(glm::vec3(-0.5f, -0.5f, z - 0.5f), glm::vec3(0.5f, 0.5f, z + 0.5f)), i);
+    tree.insert(AABB<float>(glm::vec3(100.0f, -0.5f, z - 0.5f), glm::vec3(101.0f, 0.5f, z + 0.5f)), 1000 + i);
+  }
+
+  const Frustum<float> frustum(glm::perspective(glm::radians(60.0f), 1.0f, 0.1f, 50.0f));
+  std::set<int> found;
+  tree.queryFrustum(frustum, [&](auto, const int& data) { found.insert(data); });
+
+  // Boxes from z = -2 up to z = -50 are inside, box at z = 0 intersects the near plane.
+  EXPECT_EQ(found.size(), 26u);
+  EXPECT_EQ(*found.rbegin(), 25);
+}
+
+TEST(DynamicAABBTree, NestedAndConcurrentQueries) {
+  std::mt19937 rng(11u);
+  DynamicAABBTree<float, int> tree;
+  std::vector<AABB<float>> boxes;
+  for (int i = 0; i < 200; i++) {
+    boxes.emplace_back(randomBox(rng));
+    tree.insert(boxes.back(), i);
+  }
+
+  size_t expected_pairs = 0u;
+  for (const AABB<float>& lhs : boxes) {
+    for (const AABB<float>& rhs : boxes) {
+      expected_pairs += overlaps(lhs, rhs) ? 1u : 0u;
+    }
+  }
+
+  // Queries started from callbacks and on other threads do not disturb the running query.
+  const auto count_pairs = [&tree]() {
+    size_t pairs = 0u;
+    tree.queryBox(AABB<float>(glm::vec3(-200.0f), glm::vec3(200.0f)), [&](auto id, const int&) {
+      tree.queryBox(tree.bounds(id), [&](auto, const int&) { pairs++; });
+    });
+    return pairs;
+  };
+
+  std::vector<size_t> results(4u, 0u);
+  std::vector<std::thread> threads;
+  for (size_t t = 0u; t < results.size(); t++) {
+    threads.emplace_back([&results, &count_pairs, t]() { results[t] = count_pairs(); });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(count_pairs(), expected_pairs);
+  EXPECT_EQ(results, std::vector<size_t>(4u, expected_pairs));
+}
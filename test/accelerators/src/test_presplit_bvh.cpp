@@ -0,0 +1,72 @@
+#include <gtest/gtest.h>
+#include <set>
+#include "lsg/accelerators/BVH/BVHBuilder.h"
+#include "lsg/accelerators/BVH/PreSplitBVHBuilder.h"
+
+using namespace lsg;
+
+// Long thin triangles along the diagonal, similar to arches and beams.
+Geometry createDiagonalGeometry(size_t count) {
+  std::vector<glm::vec3> vertices;
+
+  for (size_t i = 0; i < count; i++) {
+    const float offset = float(i) * 0.5f;
+    vertices.emplace_back(offset, 0.0f, 0.0f);
+    vertices.emplace_back(offset + 20.0f, 20.0f, 20.0f);
+    vertices.emplace_back(offset + 20.1f, 20.0f, 20.0f);
+  }
+
+  Geometry geometry;
+  geometry.setVertices(TBufferAccessor<glm::vec3>(BufferView(makeRef<Buffer>(vertices), sizeof(glm::vec3)),
+                                                  StructureType::kVec3, ComponentType::kFloat));
+  return geometry;
+}
+
+// Expected cost of the BVH relative to the root bounds.
+float sahCost(const BVH<float>& bvh) {
+  const float root_area = bvh.getBounds().area();
+  float cost = 0.0f;
+
+  for (const BVH<float>::Node& node : bvh.getNodes()) {
+    const float weight = node.bounds.area() / root_area;
+    cost += node.is_leaf ? weight * float(node.indices_range[1] - node.indices_range[0]) : weight;
+  }
+
+  return cost;
+}
+
+TEST(PreSplitBVH, ReducesCostOfDiagonalTriangles) {
+  Geometry geometry = createDiagonalGeometry(64);
+
+  bvh::BVHBuilder<float> builder;
+  Ref<BVH<float>> reference = builder.process(geometry);
+
+  bvh::PreSplitBVHConfig config;
+  config.reference_budget = 4.0;
+  bvh::PreSplitBVHBuilder<float> pre_split_builder(bvh::SAHFunction(), bvh::BVHConfig(), config);
+  Ref<BVH<float>> pre_split = pre_split_builder.process(geometry);
+
+  EXPECT_LT(sahCost(*pre_split), sahCost(*reference));
+
+  // Every triangle must be referenced and the budget respected.
+  const std::vector<uint32_t>& indices = pre_split->getPrimitiveIndices();
+  EXPECT_EQ(std::set<uint32_t>(indices.begin(), indices.end()).size(), 64u);
+  EXPECT_GT(indices.size(), 64u);
+  EXPECT_LE(indices.size(), 64u * 5u);
+
+  // Clipping must not change the root bounds.
+  EXPECT_EQ(pre_split->getBounds().min(), reference->getBounds().min());
+  EXPECT_EQ(pre_split->getBounds().max(), reference->getBounds().max());
+}
+
+TEST(PreSplitBVH, ZeroBudgetMatchesObjectSplitBuild) {
+  Geometry geometry = createDiagonalGeometry(16);
+
+  bvh::PreSplitBVHConfig config;
+  config.reference_budget = 0.0;
+  bvh::PreSplitBVHBuilder<float> pre_split_builder(bvh::SAHFunction(), bvh::BVHConfig(), config);
+  bvh::BVHBuilder<float> builder;
+
+  EXPECT_EQ(pre_split_builder.process(geometry)->getPrimitiveIndices(),
+            builder.process(geometry)->getPrimitiveIndices());
+}
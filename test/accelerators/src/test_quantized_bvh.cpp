@@ -0,0 +1,116 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include "lsg/accelerators/BVH/BVHBuilder.h"
+#include "lsg/accelerators/BVH/QuantizedBVH.h"
+
+using namespace lsg;
+
+std::vector<AABB<float>> createBoxes() {
+  std::vector<AABB<float>> boxes;
+  for (size_t x = 0; x < 8; x++) {
+    for (size_t y = 0; y < 8; y++) {
+      for (size_t z = 0; z < 8; z++) {
+        const glm::vec3 min(x * 2.1f + 0.013f * y, y * 1.7f, z * 2.3f - 100.0f);
+        boxes.emplace_back(min, min + glm::vec3(1.0f, 0.37f * float(x + 1), 0.01f));
+      }
+    }
+  }
+  return boxes;
+}
+
+TEST(QuantizedBVH, ConservativeBounds) {
+  bvh::BVHConfig config;
+  config.max_leaf_size = 1u;
+  Ref<BVH<float>> tree = bvh::BVHBuilder<float>(bvh::SAHFunction(), config).process(createBoxes());
+  QuantizedBVH<float> quantized(*tree);
+
+  const std::vector<BVH<float>::Node>& nodes = tree->getNodes();
+
+  // Walk both trees from the root. Decoded bounds of a child are its frame.
+  struct Entry {
+    uint32_t source;
+    uint32_t quantized;
+    AABB<float> frame;
+  };
+  std::vector<Entry> stack = {{0u, 0u, quantized.getBounds()}};
+  size_t num_inner = 0u;
+
+  while (!stack.empty()) {
+    const Entry entry = stack.back();
+    stack.pop_back();
+    num_inner++;
+
+    const BVH<float>::Node& node = nodes[entry.source];
+    const QuantizedBVH<float>::Node& quantized_node = quantized.getNodes()[entry.quantized];
+
+    for (size_t c = 0u; c < 2u; c++) {
+      const BVH<float>::Node& child = nodes[node.child_indices[c]];
+      const AABB<float> decoded = QuantizedBVH<float>::decodeChildBounds(entry.frame, quantized_node, c);
+
+      for (size_t axis = 0u; axis < 3u; axis++) {
+        EXPECT_LE(decoded.min()[axis], child.bounds.min()[axis]);
+        EXPECT_GE(decoded.max()[axis], child.bounds.max()[axis]);
+        // Decoded bounds may not grow past the frame.
+        EXPECT_GE(decoded.min()[axis], entry.frame.min()[axis]);
+        EXPECT_LE(decoded.max()[axis], entry.frame.max()[axis]);
+      }
+
+      const uint32_t child_index = quantized_node.child_indices[c];
+      EXPECT_EQ(child.is_leaf, (child_index & QuantizedBVH<float>::k_leaf_flag) != 0u);
+      if (!child.is_leaf) {
+        stack.push_back({node.child_indices[c], child_index, decoded});
+      }
+    }
+  }
+
+  EXPECT_EQ(num_inner, quantized.getNodes().size());
+  EXPECT_EQ(sizeof(QuantizedBVH<float>::Node), 20u);
+  EXPECT_EQ(quantized.getLeaves().size(), nodes.size() - quantized.getNodes().size());
+  EXPECT_LT(quantized.memoryFootprint(),
+            nodes.size() * sizeof(BVH<float>::Node) + tree->getPrimitiveIndices().size() * sizeof(uint32_t));
+}
+
+TEST(QuantizedBVH, MatchesFullPrecisionTraversal) {
+  const std::vector<AABB<float>> boxes = createBoxes();
+  Ref<BVH<float>> tree = bvh::BVHBuilder<float>().process(boxes);
+  QuantizedBVH<float> quantized(*tree);
+
+  std::vector<Ray<float>> rays;
+  for (size_t i = 0; i < 300; i++) {
+    const glm::vec3 origin(-5.0f, float(i % 17), float(i % 13) * 1.3f - 100.0f);
+    rays.emplace_back(origin, glm::vec3(1.0f, (float(i % 7) - 3.0f) * 0.1f, (float(i % 5) - 2.0f) * 0.1f));
+  }
+
+  auto intersect_box = [&boxes](const Ray<float>& ray, uint32_t prim_index) {
+    return ray.intersectAABBDistance(boxes[prim_index]);
+  };
+
+  ThreadPool pool(4);
+  std::vector<BVH<float>::Hit> expected;
+  std::vector<BVH<float>::Hit> actual;
+  tree->intersectBatch(rays, expected, intersect_box, pool, 16u);
+  quantized.intersectBatch(rays, actual, intersect_box, pool, 16u);
+
+  size_t num_hits = 0u;
+  for (size_t i = 0; i < rays.size(); i++) {
+    EXPECT_EQ(actual[i].distance, expected[i].distance);
+    num_hits += expected[i].prim_index != BVH<float>::Hit::k_invalid_index;
+
+    // Quantized bounds are looser, so candidates are a superset.
+    std::vector<uint32_t> candidates = quantized.rayIntersect(rays[i]);
+    std::sort(candidates.begin(), candidates.end());
+    for (uint32_t index : tree->rayIntersect(rays[i])) {
+      EXPECT_TRUE(std::binary_search(candidates.begin(), candidates.end(), index));
+    }
+  }
+  EXPECT_GT(num_hits, 0u);
+}
+
+TEST(QuantizedBVH, SingleLeaf) {
+  std::vector<AABB<float>> boxes = {{{0.0f, 0.0f, 0.0f}, {1.0f, 1.0f, 1.0f}}};
+  QuantizedBVH<float> quantized(*bvh::BVHBuilder<float>().process(boxes));
+
+  EXPECT_TRUE(quantized.getNodes().empty());
+  EXPECT_EQ(quantized.rayIntersect(Ray<float>({0.5f, 0.5f, -1.0f}, {0.0f, 0.0f, 1.0f})), std::vector<uint32_t>{0u});
+  EXPECT_TRUE(quantized.rayIntersect(Ray<float>({5.0f, 0.5f, -1.0f}, {0.0f, 0.0f, 1.0f})).empty());
+}
@@ -0,0 +1,31 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include "lsg/accelerators/BVH/BVH.h"
+#include "lsg/accelerators/BVH/BVHBuilder.h"
+#include "lsg/accelerators/BVH/SAHCalibration.h"
+
+using namespace lsg;
+
+TEST(SAHCalibration, ProducesUsableSAHFunction) {
+  bvh::SAHCalibrationConfig config;
+  config.num_primitives = 256u;
+  config.num_rays = 32u;
+  config.num_repetitions = 2u;
+  config.primitive_batch_size = 4u;
+
+  bvh::SAHCalibrationResult result = bvh::calibrateSAH(config);
+
+  EXPECT_GT(result.node_test_ns, 0.0);
+  EXPECT_GT(result.primitive_test_ns, 0.0);
+  EXPECT_EQ(result.sah_function.getSAHNodeCost(), 1.0f);
+  EXPECT_GT(result.sah_function.getSAHPrimitiveCost(), 0.0f);
+  EXPECT_NE(std::find(config.batch_sizes.begin(), config.batch_sizes.end(), result.sah_function.getNodeBatchSize()),
+            config.batch_sizes.end());
+  EXPECT_EQ(result.sah_function.getPrimitiveBatchSize(), 4u);
+
+  // Calibrated function can directly drive a build.
+  std::vector<AABB<float>> boxes = {{{0.0, 0.0, 0.0}, {1.0, 1.0, 1.0}}, {{3.0, 3.0, 3.0}, {4.0, 4.0, 4.0}}};
+  bvh::BVHBuilder<float> builder(result.sah_function);
+  Ref<BVH<float>> tree = builder.process(boxes);
+  EXPECT_FALSE(tree->getNodes().empty());
+}
@@ -0,0 +1,86 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include "lsg/components/Transform.h"
+#include "lsg/core/ChangeJournal.h"
+#include "lsg/core/Object.h"
+#include "lsg/core/Scene.h"
+#include "lsg/core/VersionTracker.h"
+
+using namespace lsg;
+
+TEST(ChangeJournal, RecordsSceneEdits) {
+  Ref<Scene> scene = makeRef<Scene>("Scene");
+  ChangeJournal& journal = scene->changeJournal();
+
+  // Nothing is recorded while disabled.
+  scene->addChild(makeRef<Object>("Ignored"));
+  journal.setEnabled(true);
+  ChangeJournal::Cursor cursor = journal.head();
+
+  Ref<Object> a = makeRef<Object>("A");
+  Ref<Object> b = makeRef<Object>("B");
+  a->addChild(b);
+  scene->addChild(a);
+  Ref<Transform> transform = b->addComponent<Transform>();
+  VersionTracker resource;
+  resource.incrementVersion();
+  a->removeChild(b->id());
+
+  std::vector<Change> changes;
+  ChangeJournal::ReadResult result = journal.read(cursor, changes);
+  EXPECT_TRUE(result.complete);
+  ASSERT_EQ(result.count, 4u);
+  ASSERT_EQ(changes.size(), 4u);
+
+  // Adding a subtree records only its root.
+  EXPECT_EQ(changes[0].type, ChangeType::kChildAdded);
+  EXPECT_EQ(changes[0].object, a.get());
+  EXPECT_EQ(changes[0].parent, scene.get());
+  EXPECT_EQ(changes[1].type, ChangeType::kComponentAdded);
+  EXPECT_EQ(changes[1].object, b.get());
+  EXPECT_EQ(changes[1].component, transform);
+  EXPECT_EQ(changes[2].type, ChangeType::kResourceChanged);
+  EXPECT_EQ(changes[2].resource, &resource);
+  EXPECT_EQ(changes[2].version, 1u);
+  EXPECT_EQ(changes[3].type, ChangeType::kChildRemoved);
+  EXPECT_EQ(changes[3].object, b.get());
+  EXPECT_EQ(changes[3].parent, a.get());
+
+  // Cursor is at the head.
+  changes.clear();
+  result = journal.read(cursor, changes);
+  EXPECT_TRUE(result.complete);
+  EXPECT_EQ(result.count, 0u);
+  EXPECT_TRUE(changes.empty());
+
+  // Components of the scene do not make the journal reference the scene.
+  Ref<Transform> scene_transform = scene->addComponent<Transform>();
+  journal.read(cursor, changes);
+  ASSERT_EQ(changes.size(), 1u);
+  EXPECT_EQ(changes[0].object, scene.get());
+  EXPECT_FALSE(changes[0].object_ref);
+  EXPECT_EQ(scene->useCount(), 1u);
+}
+
+TEST(ChangeJournal, Overflow) {
+  ChangeJournal journal(4u);
+  journal.setEnabled(true);
+  ChangeJournal::Cursor cursor = journal.head();
+
+  VersionTracker resource;
+  for (size_t i = 0u; i < 6u; i++) {
+    resource.incrementVersion();
+  }
+
+  // Consumer that fell behind must resynchronise.
+  std::vector<Change> changes;
+  EXPECT_FALSE(journal.read(cursor, changes).complete);
+  EXPECT_TRUE(changes.empty());
+  EXPECT_EQ(cursor, journal.head());
+
+  resource.incrementVersion();
+  const ChangeJournal::ReadResult result = journal.read(cursor, changes);
+  EXPECT_TRUE(result.complete);
+  ASSERT_EQ(changes.size(), 1u);
+  EXPECT_EQ(changes[0].version, 7u);
+}
@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include "lsg/components/LODGroup.h"
+#include "lsg/components/PerspectiveCamera.h"
+#include "lsg/components/Transform.h"
+#include "lsg/core/Scene.h"
+#include "lsg/materials/MetallicRoughnessMaterial.h"
+
+using namespace lsg;
+
+namespace {
+
+Ref<SubMesh> makeSubMesh(const size_t triangle_count, const Ref<Material>& material) {
+  std::vector<glm::vec3> vertices;
+  for (size_t i = 0u; i < triangle_count; i++) {
+    const float offset = static_cast<float>(i) / static_cast<float>(triangle_count);
+    vertices.insert(vertices.end(), {{-0.5f, -0.5f, -offset}, {0.5f, -0.5f, -offset}, {0.0f, 0.5f, -offset}});
+  }
+
+  Ref<Geometry> geometry = makeRef<Geometry>();
+  geometry->setVertices(TBufferAccessor<glm::vec3>(BufferView(makeRef<Buffer>(vertices), sizeof(glm::vec3)),
+                                                   StructureType::kVec3, ComponentType::kFloat));
+  return makeRef<SubMesh>(geometry, material);
+}
+
+std::vector<LODLevel> makeLevels(const Ref<Material>& material) {
+  return {{{makeSubMesh(8u, material)}, 0.0f}, {{makeSubMesh(2u, material)}, 0.01f},
+          {{makeSubMesh(1u, material)}, 0.1f}};
+}
+
+AABB<float> boundsAt(const float distance) {
+  return AABB<float>(glm::vec3(-0.5f, -0.5f, -distance - 1.0f), glm::vec3(0.5f, 0.5f, -distance));
+}
+
+} // namespace
+
+TEST(LODGroup, SelectionWithHysteresis) {
+  Ref<Object> object = makeRef<Object>("Object");
+  Ref<LODGroup> lod_group = object->addComponent<LODGroup>(makeLevels(makeRef<MetallicRoughnessMaterial>()));
+  ASSERT_EQ(lod_group->levelCount(), 3u);
+  EXPECT_TRUE(object->localBounds().valid());
+
+  LODView view;
+  EXPECT_FLOAT_EQ(LODGroup::screenError(0.01f, boundsAt(10.0f), view), 0.0005f);
+  EXPECT_EQ(lod_group->select(boundsAt(1.0f), view), 0u);
+  EXPECT_EQ(lod_group->select(boundsAt(10.0f), view), 1u);
+  EXPECT_EQ(lod_group->select(boundsAt(50.0f), view), 2u);
+
+  // Between the refine and the coarsen distance the previous selection is kept.
+  EXPECT_EQ(lod_group->select(boundsAt(28.0f), view, 2u), 2u);
+  EXPECT_EQ(lod_group->select(boundsAt(20.0f), view, 2u), 1u);
+  EXPECT_EQ(lod_group->select(boundsAt(28.0f), view, 1u), 1u);
+  EXPECT_EQ(lod_group->select(boundsAt(32.0f), view, 1u), 2u);
+
+  // Without hysteresis the threshold distance decides.
+  lod_group->setHysteresis(0.0f);
+  EXPECT_EQ(lod_group->select(boundsAt(24.0f), view, 2u), 1u);
+  EXPECT_EQ(lod_group->select(boundsAt(26.0f), view, 1u), 2u);
+
+  // Orthographic error does not depend on the distance.
+  view.perspective = false;
+  EXPECT_EQ(lod_group->select(boundsAt(1000.0f), view, 2u), 0u);
+
+  EXPECT_THROW(lod_group->setHysteresis(1.0f), InvalidArgument);
+  EXPECT_THROW(lod_group->level(3u), OutOfRange);
+  EXPECT_THROW(lod_group->addLevel({}, 0.05f), InvalidArgument);
+}
+
+TEST(LODGroup, SelectedDuringCulling) {
+  Ref<Material> material = makeRef<MetallicRoughnessMaterial>();
+  Ref<Scene> scene = makeRef<Scene>("Scene");
+  std::vector<Ref<Object>> objects;
+
+  for (const float distance : {1.0f, 10.0f, 50.0f, 100.0f}) {
+    Ref<Object> object = makeRef<Object>("Object");
+    object->addComponent<Transform>()->setPosition(glm::vec3(0.0f, 0.0f, -distance));
+    object->addComponent<LODGroup>(makeLevels(material));
+    scene->addChild(object);
+    objects.emplace_back(object);
+  }
+
+  Ref<Object> camera = makeRef<Object>("Camera");
+  camera->addComponent<Transform>();
+  camera->addComponent<PerspectiveCamera>(glm::radians(90.0f), 0.1f, 1.0f, 1000.0f);
+  scene->addChild(camera);
+
+  LODSelection selection;
+  std::vector<VisibleSubMesh> visible;
+  scene->cull(*camera, visible, ThreadPool::global(), &selection);
+  ASSERT_EQ(visible.size(), 4u);
+  EXPECT_EQ(selection.size(), 4u);
+
+  const size_t expected_levels[] = {0u, 1u, 2u, 2u};
+  size_t triangle_count = 0u;
+  for (size_t i = 0u; i < objects.size(); i++) {
+    Ref<LODGroup> lod_group = objects[i]->getComponent<LODGroup>();
+    EXPECT_EQ(selection.level(*lod_group), expected_levels[i]);
+    EXPECT_EQ(visible[i].object, objects[i].get());
+    EXPECT_EQ(visible[i].lod_group, lod_group.get());
+    EXPECT_EQ(visible[i].lod_level, expected_levels[i]);
+    EXPECT_EQ(visible[i].sub_mesh, lod_group->level(expected_levels[i]).sub_meshes.front().get());
+    triangle_count += visible[i].sub_mesh->geometry()->getTrianglePositionAccessor()->count();
+  }
+  EXPECT_EQ(triangle_count, 8u + 2u + 1u + 1u);
+
+  // Another camera far away keeps its own selection.
+  Ref<Object> far_camera = makeRef<Object>("FarCamera");
+  far_camera->addComponent<Transform>()->setPosition(glm::vec3(0.0f, 0.0f, 500.0f));
+  far_camera->addComponent<PerspectiveCamera>(glm::radians(90.0f), 0.1f, 1.0f, 1000.0f);
+  scene->addChild(far_camera);
+  LODSelection far_selection;
+  scene->cull(*far_camera, visible, ThreadPool::global(), &far_selection);
+  EXPECT_EQ(far_selection.level(*objects[0]->getComponent<LODGroup>()), 2u);
+  EXPECT_EQ(selection.level(*objects[0]->getComponent<LODGroup>()), 0u);
+
+  // Moving the camera away coarsens the near object.
+  camera->getComponent<Transform>()->setPosition(glm::vec3(0.0f, 0.0f, 20.0f));
+  scene->cull(*camera, visible, ThreadPool::global(), &selection);
+  EXPECT_EQ(selection.level(*objects[0]->getComponent<LODGroup>()), 1u);
+  EXPECT_EQ(visible[0].lod_level, 1u);
+}
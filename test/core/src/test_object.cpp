@@ -1,5 +1,8 @@
 #include <gtest/gtest.h>
 #include <string>
+#include <type_traits>
+#include "lsg/components/OrthographicCamera.h"
+#include "lsg/components/PerspectiveCamera.h"
 #include "lsg/core/Object.h"
 
 using namespace lsg;
@@ -14,6 +17,25 @@ class ObjTypeB : public Object {
   explicit ObjTypeB(const std::string& name) : Object(name) {}
 };
 
+class CompBase : public Component {
+ public:
+  using ComponentBases = ComponentBaseList<CompBase>;
+
+  explicit CompBase(Object& owner, const std::string& name = "CompBase") : Component(name, owner) {}
+};
+
+class CompDerived : public CompBase {
+ public:
+  using ComponentBases = ComponentBaseList<CompDerived, CompBase>;
+
+  explicit CompDerived(Object& owner) : CompBase(owner, "CompDerived") {}
+};
+
+class CompFinal final : public Component {
+ public:
+  explicit CompFinal(Object& owner) : Component("CompFinal", owner) {}
+};
+
 TEST(Object, BasicHierarchy) {
   auto a = makeRef<Object>("A");
   auto b = makeRef<Object>("B");
@@ -219,4 +241,131 @@ TEST(Object, HierarchyTraversal) {
       return obj != c;
     });
   }
-}
\ No newline at end of file
+}
+
+TEST(Object, ComponentLookup) {
+  auto obj = makeRef<Object>("A");
+
+  EXPECT_NE(Component::typeIdOf<CompBase>(), Component::typeIdOf<CompDerived>());
+  EXPECT_EQ(Component::typeIdOf<CompBase>(), Component::typeIdOf<CompBase>());
+
+  // Lookups must find components that are added later.
+  EXPECT_EQ(obj->findComponent<CompFinal>(), nullptr);
+  EXPECT_EQ(obj->findComponent<CompBase>(), nullptr);
+  EXPECT_TRUE(obj->getComponents<Component>().empty());
+
+  Ref<CompDerived> derived = obj->addComponent<CompDerived>();
+  EXPECT_EQ(derived->typeId(), Component::typeIdOf<CompDerived>());
+  EXPECT_EQ(obj->findComponent<CompFinal>(), nullptr);
+  EXPECT_EQ(obj->findComponent<CompBase>(), derived.get());
+  EXPECT_EQ(obj->findComponent<CompDerived>(), derived.get());
+
+  Ref<CompFinal> final_comp = obj->addComponent<CompFinal>();
+  Ref<CompBase> base = obj->addComponent<CompBase>();
+  EXPECT_EQ(obj->findComponent<CompFinal>(), final_comp.get());
+  EXPECT_TRUE(obj->getComponent<CompFinal>() == final_comp);
+
+  // First matching component wins.
+  EXPECT_EQ(obj->findComponent<CompBase>(), derived.get());
+  EXPECT_EQ(obj->findComponent<Component>(), derived.get());
+
+  std::vector<Component*> matches;
+  for (CompBase& component : obj->getComponents<CompBase>()) {
+    matches.emplace_back(&component);
+  }
+  ASSERT_EQ(matches.size(), 2u);
+  EXPECT_EQ(matches[0], derived.get());
+  EXPECT_EQ(matches[1], base.get());
+
+  size_t count = 0u;
+  for (const Component& component : obj->getComponents<Component>()) {
+    EXPECT_EQ(component.typeId() == Component::typeIdOf<CompFinal>(), &component == final_comp.get());
+    count++;
+  }
+  EXPECT_EQ(count, 3u);
+
+  // Const objects only hand out const components.
+  const Object& const_obj = *obj;
+  static_assert(std::is_same_v<decltype(*const_obj.getComponents<CompBase>().begin()), const CompBase&>);
+  static_assert(std::is_same_v<decltype(*obj->getComponents<CompBase>().begin()), CompBase&>);
+  EXPECT_EQ(&*const_obj.getComponents<CompBase>().begin(), derived.get());
+
+  // Declared bases of library components are served from the table.
+  Ref<PerspectiveCamera> camera = obj->addComponent<PerspectiveCamera>(glm::radians(60.0f), 0.1f, 1.0f, 30.0f);
+  EXPECT_EQ(obj->findComponent<Camera>(), camera.get());
+  EXPECT_EQ(&*obj->getComponents<Camera>().begin(), camera.get());
+  EXPECT_EQ(obj->findComponent<OrthographicCamera>(), nullptr);
+}
+
+TEST(Object, DeepHierarchyTraversal) {
+  constexpr size_t depth = 100000u;
+  std::vector<Ref<Object>> chain = {makeRef<Object>("Root")};
+  for (size_t i = 1u; i < depth; i++) {
+    chain.emplace_back(makeRef<Object>("Node"));
+    chain[i - 1u]->addChild(chain[i]);
+  }
+
+  // Borrowed visitor that never stops.
+  size_t visited = 0u;
+  chain.front()->traverseDown([&](Object&) { visited++; });
+  EXPECT_EQ(visited, depth);
+
+  visited = 0u;
+  const Object& leaf = *chain.back();
+  leaf.traverseUpExcl([&](const Object& obj) {
+    visited++;
+    return &obj != chain[depth / 2u].get();
+  });
+  EXPECT_EQ(visited, depth / 2u - 1u);
+
+  // Nested traversals share the thread local stack.
+  Ref<Object> a = makeRef<Object>("A");
+  a->addChildren({makeRef<Object>("B"), makeRef<Object>("C")});
+  std::vector<std::string_view> names;
+  a->traverseDown([&](Object& outer) {
+    names.emplace_back(outer.name());
+    a->traverseDownExcl([&](const Object& inner) { names.emplace_back(inner.name()); });
+  });
+  EXPECT_EQ(names, (std::vector<std::string_view> {"A", "B", "C", "B", "B", "C", "C", "B", "C"}));
+
+  EXPECT_EQ(chain.front()->find("Root/Node/Node"), chain[2]);
+  EXPECT_TRUE(chain.back()->isActiveInHierarchy());
+  chain[10]->setActive(false);
+  EXPECT_FALSE(chain.back()->isActiveInHierarchy());
+
+  // Release the chain bottom up, destruction of nested children is recursive.
+  for (size_t i = depth - 1u; i > 0u; i--) {
+    chain[i]->detach();
+  }
+}
+
+TEST(Object, SubtreeVersion) {
+  auto a = makeRef<Object>("A");
+  auto b = makeRef<Object>("B");
+  auto c = makeRef<Object>("C");
+  auto d = makeRef<Object>("D");
+  a->addChildren({b, d});
+  b->addChild(c);
+
+  uint64_t seen = Object::advanceVersionClock();
+  EXPECT_LE(a->subtreeVersion(), seen);
+
+  // Changing C marks C, B and A but not the sibling branch.
+  c->addComponent<CompFinal>();
+  EXPECT_GT(c->subtreeVersion(), seen);
+  EXPECT_GT(b->subtreeVersion(), seen);
+  EXPECT_GT(a->subtreeVersion(), seen);
+  EXPECT_LE(d->subtreeVersion(), seen);
+
+  seen = Object::advanceVersionClock();
+  d->setActive(false);
+  EXPECT_GT(a->subtreeVersion(), seen);
+  EXPECT_LE(b->subtreeVersion(), seen);
+
+  // Reparenting marks both the old and the new ancestors.
+  seen = Object::advanceVersionClock();
+  d->addChild(c);
+  EXPECT_GT(b->subtreeVersion(), seen);
+  EXPECT_GT(d->subtreeVersion(), seen);
+  EXPECT_GT(c->subtreeVersion(), seen);
+}
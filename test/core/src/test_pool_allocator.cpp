@@ -0,0 +1,54 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <set>
+#include <vector>
+#include "lsg/core/Object.h"
+#include "lsg/core/PoolAllocator.h"
+
+using namespace lsg;
+
+TEST(PoolAllocator, ReuseAndTrim) {
+  PoolAllocator::trim();
+  const PoolAllocator::Stats initial = PoolAllocator::stats();
+
+  std::vector<void*> ptrs;
+  for (size_t i = 0u; i < 10000u; i++) {
+    ptrs.emplace_back(PoolAllocator::allocate(48u));
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(ptrs.back()) % PoolAllocator::k_granularity, 0u);
+  }
+  EXPECT_EQ(std::set<void*>(ptrs.begin(), ptrs.end()).size(), ptrs.size());
+  EXPECT_EQ(PoolAllocator::stats().live_allocations, initial.live_allocations + ptrs.size());
+  EXPECT_GT(PoolAllocator::stats().slabs, initial.slabs);
+
+  // Freed slot is reused.
+  void* released = ptrs.back();
+  PoolAllocator::deallocate(released, 48u);
+  ptrs.back() = PoolAllocator::allocate(40u);
+  EXPECT_EQ(ptrs.back(), released);
+
+  for (void* ptr : ptrs) {
+    PoolAllocator::deallocate(ptr, 48u);
+  }
+  EXPECT_EQ(PoolAllocator::stats().live_allocations, initial.live_allocations);
+  EXPECT_GT(PoolAllocator::trim(), 0u);
+  EXPECT_EQ(PoolAllocator::stats().slabs, initial.slabs);
+
+  // Large allocations bypass the pools.
+  void* large = PoolAllocator::allocate(PoolAllocator::k_max_size + 1u);
+  EXPECT_EQ(PoolAllocator::stats().live_allocations, initial.live_allocations);
+  PoolAllocator::deallocate(large, PoolAllocator::k_max_size + 1u);
+}
+
+#if LSG_POOL_ALLOCATION
+TEST(PoolAllocator, RefCountedObjects) {
+  const size_t live = PoolAllocator::stats().live_allocations;
+  {
+    Ref<Object> root = makeRef<Object>("Root");
+    for (size_t i = 0u; i < 100u; i++) {
+      root->addChild(makeRef<Object>("Child"));
+    }
+    EXPECT_EQ(PoolAllocator::stats().live_allocations, live + 101u);
+  }
+  EXPECT_EQ(PoolAllocator::stats().live_allocations, live);
+}
+#endif
@@ -0,0 +1,46 @@
+#include <gtest/gtest.h>
+#include "lsg/core/Ref.h"
+
+using namespace lsg;
+
+template <typename CountPolicy>
+class Counted : public RefCounter<Counted<CountPolicy>, CountPolicy> {
+ public:
+  explicit Counted(bool& destroyed) : destroyed_(destroyed) {}
+
+  ~Counted() {
+    destroyed_ = true;
+  }
+
+ private:
+  bool& destroyed_;
+};
+
+template <typename CountPolicy>
+void testCountPolicy() {
+  bool destroyed = false;
+  Ref<Counted<CountPolicy>> a = makeRef<Counted<CountPolicy>>(destroyed);
+  EXPECT_EQ(a->useCount(), 1u);
+
+  {
+    Ref<Counted<CountPolicy>> b = a;
+    Ref<Counted<CountPolicy>> c(a.get());
+    EXPECT_EQ(a->useCount(), 3u);
+  }
+  EXPECT_EQ(a->useCount(), 1u);
+
+  Ref<Counted<CountPolicy>> moved = std::move(a);
+  EXPECT_EQ(moved->useCount(), 1u);
+  EXPECT_FALSE(destroyed);
+
+  moved.reset();
+  EXPECT_TRUE(destroyed);
+}
+
+TEST(Ref, AtomicRefCount) {
+  testCountPolicy<AtomicRefCount>();
+}
+
+TEST(Ref, PlainRefCount) {
+  testCountPolicy<PlainRefCount>();
+}
@@ -0,0 +1,445 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <thread>
+#include "lsg/components/Mesh.h"
+#include "lsg/components/PerspectiveCamera.h"
+#include "lsg/components/Transform.h"
+#include "lsg/core/Object.h"
+#include "lsg/core/Scene.h"
+#include "lsg/core/SceneSnapshot.h"
+#include "lsg/materials/MetallicRoughnessMaterial.h"
+
+using namespace lsg;
+
+class Velocity final : public Component {
+ public:
+  explicit Velocity(Object& owner, float speed = 1.0f) : Component("Velocity", owner), speed(speed) {}
+
+  float speed;
+};
+
+TEST(Scene, RegistryTracksHierarchy) {
+  Ref<Scene> scene = makeRef<Scene>("Scene");
+  EXPECT_EQ(scene->scene(), scene.get());
+  EXPECT_EQ(scene->registry().numEntities(), 1u);
+
+  Ref<Object> a = makeRef<Object>("A");
+  a->addComponent<Transform>();
+  Ref<Object> b = makeRef<Object>("B");
+  b->addComponent<Transform>();
+  b->addComponent<Velocity>(2.0f);
+  a->addChild(b);
+  EXPECT_EQ(a->scene(), nullptr);
+
+  scene->addChild(a);
+  EXPECT_EQ(b->scene(), scene.get());
+  EXPECT_EQ(scene->registry().numEntities(), 3u);
+  EXPECT_EQ(scene->registry().pool<Transform>()->components.size(), 2u);
+
+  // Components added to an object in the scene are registered immediately.
+  a->addComponent<Velocity>(1.0f);
+  size_t count = 0u;
+  float speed = 0.0f;
+  scene->view<Transform, Velocity>().forEach([&](Object& object, Transform&, Velocity& velocity) {
+    EXPECT_EQ(object.findComponent<Velocity>(), &velocity);
+    speed += velocity.speed;
+    count++;
+  });
+  EXPECT_EQ(count, 2u);
+  EXPECT_EQ(speed, 3.0f);
+
+  b->detach();
+  EXPECT_EQ(b->scene(), nullptr);
+  EXPECT_EQ(scene->registry().numEntities(), 2u);
+  EXPECT_EQ(scene->view<Velocity>().sizeHint(), 1u);
+  EXPECT_EQ((scene->view<Transform, Velocity>().sizeHint()), 1u);
+
+  scene.reset();
+  EXPECT_EQ(a->scene(), nullptr);
+}
+
+TEST(Scene, ParallelView) {
+  Ref<Scene> scene = makeRef<Scene>("Scene");
+  for (size_t i = 0; i < 10000; i++) {
+    Ref<Object> object = makeRef<Object>("Object");
+    scene->addChild(object);
+    object->addComponent<Transform>();
+    if (i % 2 == 0) {
+      object->addComponent<Velocity>(1.0f);
+    }
+  }
+
+  ThreadPool pool(4);
+  std::atomic<size_t> count = 0u;
+  scene->view<Velocity, Transform>().parallelForEach(
+    [&](Object& object, Velocity& velocity, Transform& transform) {
+      EXPECT_EQ(object.findComponent<Transform>(), &transform);
+      velocity.speed *= 2.0f;
+      count++;
+    },
+    pool, 128u);
+  EXPECT_EQ(count, 5000u);
+  EXPECT_EQ(scene->children()[0]->findComponent<Velocity>()->speed, 2.0f);
+  EXPECT_EQ(scene->view<Component>().sizeHint(), 0u);
+}
+
+TEST(Scene, HierarchyIndex) {
+  Ref<Scene> scene = makeRef<Scene>("Scene");
+  Ref<Object> a = makeRef<Object>("A");
+  Ref<Object> b1 = makeRef<Object>("B");
+  Ref<Object> b2 = makeRef<Object>("B");
+  Ref<Object> c = makeRef<Object>("C");
+  Ref<Object> d = makeRef<Object>("D");
+
+  /* Hierarchy
+       Scene
+         |
+         A
+        / \
+       B   B
+       |   |
+       C   D
+  */
+  b1->addChild(c);
+  b2->addChild(d);
+  a->addChildren({b1, b2});
+  scene->addChild(a);
+
+  EXPECT_EQ(scene->find("/Scene/A/B/C"), c);
+  EXPECT_EQ(scene->find("B/D"), d);
+  EXPECT_EQ(scene->find("B"), b1);
+  EXPECT_EQ(b2->find("B"), b2);
+  EXPECT_FALSE(b2->find("C"));
+  EXPECT_FALSE(scene->find("/A/B"));
+  EXPECT_FALSE(scene->find("X/Scene/A"));
+
+  std::vector<Ref<Object>> matches = scene->findAll("A/B");
+  ASSERT_EQ(matches.size(), 2u);
+  EXPECT_EQ(matches[0], b1);
+  EXPECT_EQ(matches[1], b2);
+
+  EXPECT_EQ(a->getChild("B"), b1);
+  EXPECT_EQ(b1->getChild("C"), c);
+  EXPECT_FALSE(b1->getChild("D"));
+
+  // Rename updates paths of the whole subtree.
+  b2->setName("E");
+  EXPECT_EQ(scene->find("/Scene/A/E/D"), d);
+  EXPECT_FALSE(scene->find("/Scene/A/B/D"));
+  EXPECT_EQ(a->getChild("B"), b1);
+  EXPECT_EQ(a->getChild("E"), b2);
+
+  // Moving within the scene.
+  c->addChild(b2);
+  EXPECT_TRUE(a->children().size() == 1u);
+  EXPECT_EQ(scene->find("/Scene/A/B/C/E/D"), d);
+  EXPECT_FALSE(scene->find("/Scene/A/E"));
+
+  // Ancestors precede their descendants.
+  Ref<Object> nested = makeRef<Object>("C");
+  d->addChild(nested);
+  matches = scene->findAll("C");
+  ASSERT_EQ(matches.size(), 2u);
+  EXPECT_EQ(matches[0], c);
+  EXPECT_EQ(matches[1], nested);
+  EXPECT_EQ(scene->find("C"), c);
+
+  // Removing from the scene.
+  a->removeChild("B");
+  EXPECT_FALSE(scene->find("D"));
+  EXPECT_FALSE(scene->find("/Scene/A/B"));
+  EXPECT_EQ(b1->find("/B/C/E/D"), d);
+  EXPECT_EQ(scene->find("A"), a);
+}
+
+TEST(Scene, HierarchyIndexNestedScenes) {
+  Ref<Scene> scene = makeRef<Scene>("Scene");
+  Ref<Object> a = makeRef<Object>("A");
+  Ref<Scene> inner = makeRef<Scene>("Inner");
+  Ref<Object> b = makeRef<Object>("B");
+  Ref<Scene> deep = makeRef<Scene>("Deep");
+  Ref<Object> c1 = makeRef<Object>("C");
+  Ref<Object> c2 = makeRef<Object>("C");
+
+  /* Hierarchy
+       Scene
+         |
+         A
+        / \
+    Inner  C
+       |
+       B
+       |
+      Deep
+       |
+       C
+  */
+  inner->addChild(b);
+  a->addChild(inner);
+  a->addChild(c2);
+  scene->addChild(a);
+  b->addChild(deep);
+  deep->addChild(c1);
+
+  // Objects of nested scenes are found through the nested indexes.
+  EXPECT_EQ(scene->find("/Scene/A/Inner/B"), b);
+  EXPECT_EQ(scene->find("B"), b);
+  EXPECT_EQ(a->find("Inner/B/Deep/C"), c1);
+  EXPECT_EQ(scene->find("/Scene/A/Inner/B/Deep/C"), c1);
+  EXPECT_EQ(a->getChild("Inner"), inner);
+  EXPECT_EQ(b->getChild("Deep"), deep);
+  EXPECT_FALSE(c2->find("B"));
+
+  std::vector<Ref<Object>> matches = scene->findAll("C");
+  ASSERT_EQ(matches.size(), 2u);
+  EXPECT_EQ(matches[0], c1);
+  EXPECT_EQ(matches[1], c2);
+
+  // Paths within nested scenes follow the enclosing hierarchy.
+  a->setName("X");
+  EXPECT_EQ(scene->find("/Scene/X/Inner/B/Deep/C"), c1);
+  EXPECT_FALSE(scene->find("/Scene/A/Inner/B"));
+  c2->addChild(inner);
+  EXPECT_EQ(scene->find("/Scene/X/C/Inner/B"), b);
+  EXPECT_EQ(inner->find("/Scene/X/C/Inner/B/Deep"), deep);
+
+  // Detached nested scene is no longer found.
+  c2->removeChild("Inner");
+  EXPECT_FALSE(scene->find("B"));
+  EXPECT_FALSE(scene->find("Deep/C"));
+  EXPECT_EQ(scene->findAll("C").size(), 1u);
+  EXPECT_EQ(inner->find("/Inner/B/Deep/C"), c1);
+}
+
+TEST(Scene, CompileSnapshot) {
+  Ref<Scene> scene = makeRef<Scene>("Scene");
+  EXPECT_EQ(scene->snapshot(), nullptr);
+
+  Ref<Object> a = makeRef<Object>("A");
+  Ref<Object> b = makeRef<Object>("B");
+  Ref<Object> c = makeRef<Object>("C");
+  Ref<Object> d = makeRef<Object>("D");
+  a->addComponent<Transform>()->translateX(1.0f);
+  b->addComponent<Transform>()->translateY(2.0f);
+  c->addComponent<Transform>()->translateZ(3.0f);
+  a->addChildren({b, d});
+  scene->addChildren({a, c});
+
+  std::shared_ptr<const SceneSnapshot> first = scene->compile();
+  EXPECT_EQ(scene->snapshot(), first);
+  ASSERT_EQ(first->objectCount(), 5u);
+  EXPECT_EQ(first->reusedObjectCount(), 0u);
+  EXPECT_EQ(first->objectIds(), (std::vector<size_t> {scene->id(), a->id(), b->id(), d->id(), c->id()}));
+  EXPECT_EQ(first->parents(), (std::vector<uint32_t> {SceneSnapshot::k_no_parent, 0u, 1u, 1u, 0u}));
+  EXPECT_EQ(first->subtreeEnds(), (std::vector<uint32_t> {5u, 4u, 3u, 4u, 5u}));
+  EXPECT_EQ(first->worldMatrices()[2][3], glm::vec4(1.0f, 2.0f, 0.0f, 1.0f));
+  // D has no transform and inherits the world matrix of A.
+  EXPECT_EQ(first->worldMatrices()[3][3], glm::vec4(1.0f, 0.0f, 0.0f, 1.0f));
+
+  // Only the modified branch is read from the scene.
+  b->getComponent<Transform>()->translateY(1.0f);
+  std::shared_ptr<const SceneSnapshot> second = scene->compile();
+  EXPECT_EQ(second->reusedObjectCount(), 2u);
+  EXPECT_EQ(second->parents(), first->parents());
+  EXPECT_EQ(second->structureVersion(), first->structureVersion());
+  EXPECT_EQ(second->modifiedObjects(), (std::vector<uint32_t> {0u, 1u, 2u}));
+  EXPECT_EQ(second->worldMatrices()[2][3], glm::vec4(1.0f, 3.0f, 0.0f, 1.0f));
+  EXPECT_EQ(first->worldMatrices()[2][3], glm::vec4(1.0f, 2.0f, 0.0f, 1.0f));
+
+  // Moving an ancestor refreshes the whole subtree.
+  a->getComponent<Transform>()->translateX(1.0f);
+  std::shared_ptr<const SceneSnapshot> third = scene->compile();
+  EXPECT_EQ(third->reusedObjectCount(), 1u);
+  EXPECT_EQ(third->worldMatrices()[3][3], glm::vec4(2.0f, 0.0f, 0.0f, 1.0f));
+
+  // Reused subtrees are shifted when earlier siblings change size.
+  d->setActive(false);
+  d->addChild(makeRef<Object>("E"));
+  std::shared_ptr<const SceneSnapshot> fourth = scene->compile();
+  ASSERT_EQ(fourth->objectCount(), 6u);
+  EXPECT_NE(fourth->structureVersion(), third->structureVersion());
+  EXPECT_EQ(fourth->objectIds()[5], c->id());
+  EXPECT_EQ(fourth->parents(), (std::vector<uint32_t> {SceneSnapshot::k_no_parent, 0u, 1u, 1u, 3u, 0u}));
+  EXPECT_EQ(fourth->subtreeEnds(), (std::vector<uint32_t> {6u, 5u, 3u, 5u, 5u, 6u}));
+  EXPECT_EQ(fourth->activeFlags(), (std::vector<uint8_t> {1u, 1u, 1u, 0u, 0u, 1u}));
+  EXPECT_EQ(fourth->worldMatrices()[5][3], glm::vec4(0.0f, 0.0f, 3.0f, 1.0f));
+
+  // Unchanged scene is copied as a whole.
+  std::shared_ptr<const SceneSnapshot> fifth = scene->compile();
+  EXPECT_EQ(fifth->reusedObjectCount(), 6u);
+  EXPECT_EQ(fifth->subtreeEnds(), fourth->subtreeEnds());
+
+  // Object created after the last compile is found under an otherwise unchanged parent.
+  Ref<Object> f = makeRef<Object>("F");
+  b->addChild(f);
+  std::shared_ptr<const SceneSnapshot> sixth = scene->compile();
+  ASSERT_EQ(sixth->objectCount(), 7u);
+  EXPECT_EQ(sixth->objectIds()[3], f->id());
+  EXPECT_EQ(sixth->parents()[3], 2u);
+}
+
+TEST(Scene, SnapshotConcurrentReads) {
+  Ref<Scene> scene = makeRef<Scene>("Scene");
+  std::vector<Ref<Transform>> transforms;
+
+  for (size_t i = 0u; i < 64u; i++) {
+    Ref<Object> object = makeRef<Object>("Object" + std::to_string(i));
+    transforms.emplace_back(object->addComponent<Transform>());
+    scene->addChild(object);
+  }
+  scene->compile();
+
+  std::atomic<bool> done = false;
+  std::atomic<size_t> inconsistent = 0u;
+  std::thread reader([&]() {
+    while (!done) {
+      std::shared_ptr<const SceneSnapshot> snapshot = scene->snapshot();
+      const std::vector<glm::mat4>& matrices = snapshot->worldMatrices();
+
+      for (size_t i = 2u; i < matrices.size(); i++) {
+        if (matrices[i] != matrices[1u]) {
+          inconsistent++;
+        }
+      }
+    }
+  });
+
+  for (size_t frame = 0u; frame < 200u; frame++) {
+    for (Ref<Transform>& transform : transforms) {
+      transform->translateX(1.0f);
+    }
+    scene->compile();
+  }
+  done = true;
+  reader.join();
+
+  EXPECT_EQ(inconsistent, 0u);
+  EXPECT_EQ(scene->snapshot()->worldMatrices()[1u][3], glm::vec4(200.0f, 0.0f, 0.0f, 1.0f));
+}
+
+TEST(Scene, SpatialIndex) {
+  std::vector<glm::vec3> vertices = {{0.0f, 0.0f, 0.0f}, {1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 1.0f}};
+  Ref<Geometry> geometry = makeRef<Geometry>();
+  geometry->setVertices(TBufferAccessor<glm::vec3>(BufferView(makeRef<Buffer>(vertices), sizeof(glm::vec3)),
+                                                   StructureType::kVec3, ComponentType::kFloat));
+  Ref<SubMesh> sub_mesh = makeRef<SubMesh>(geometry, makeRef<MetallicRoughnessMaterial>());
+
+  Ref<Scene> scene = makeRef<Scene>("Scene");
+  Ref<Object> group = makeRef<Object>("Group");
+  group->addComponent<Transform>();
+  Ref<Object> a = makeRef<Object>("A");
+  a->addComponent<Mesh>(std::vector<Ref<SubMesh>> {sub_mesh});
+  Ref<Object> b = makeRef<Object>("B");
+  b->addComponent<Transform>()->setPosition(glm::vec3(10.0f, 0.0f, 0.0f));
+  b->addComponent<Mesh>(std::vector<Ref<SubMesh>> {sub_mesh});
+  group->addChildren({a, b});
+  scene->addChild(group);
+
+  const auto query = [&](const AABB<float>& box) {
+    std::vector<Object*> found;
+    scene->spatialIndex().queryBox(box, [&](auto, Object* object) { found.emplace_back(object); });
+    return found;
+  };
+
+  scene->updateSpatialIndex();
+  EXPECT_EQ(scene->spatialIndex().size(), 2u);
+  EXPECT_EQ(query(AABB<float>(glm::vec3(9.5f, 0.0f, 0.0f), glm::vec3(10.5f, 0.5f, 0.5f))),
+            std::vector<Object*> {b.get()});
+
+  // Moving the parent moves the objects without a transform as well.
+  group->getComponent<Transform>()->setPosition(glm::vec3(0.0f, 20.0f, 0.0f));
+  scene->updateSpatialIndex();
+  EXPECT_EQ(query(AABB<float>(glm::vec3(0.0f, 20.0f, 0.0f), glm::vec3(0.5f, 20.5f, 0.5f))),
+            std::vector<Object*> {a.get()});
+  EXPECT_TRUE(query(AABB<float>(glm::vec3(0.0f), glm::vec3(0.5f))).empty());
+
+  const Ray<float> ray(glm::vec3(10.25f, 20.25f, -5.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+  std::vector<Object*> hits;
+  scene->spatialIndex().queryRay(ray, 100.0f, [&](auto, Object* object, float) { hits.emplace_back(object); });
+  EXPECT_EQ(hits, std::vector<Object*> {b.get()});
+
+  // Objects that leave the scene are removed immediately.
+  group->removeChild(b->id());
+  EXPECT_EQ(scene->spatialIndex().size(), 1u);
+  scene->updateSpatialIndex();
+  EXPECT_EQ(scene->spatialIndex().size(), 1u);
+
+  // New object under an already indexed parent is inserted.
+  Ref<Object> c = makeRef<Object>("C");
+  c->addComponent<Mesh>(std::vector<Ref<SubMesh>> {sub_mesh});
+  group->addChild(c);
+  scene->updateSpatialIndex();
+  EXPECT_EQ(scene->spatialIndex().size(), 2u);
+}
+
+TEST(Scene, FrustumCulling) {
+  std::vector<glm::vec3> vertices = {{0.0f, 0.0f, 0.0f}, {1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 1.0f}};
+  Ref<Geometry> geometry = makeRef<Geometry>();
+  geometry->setVertices(TBufferAccessor<glm::vec3>(BufferView(makeRef<Buffer>(vertices), sizeof(glm::vec3)),
+                                                   StructureType::kVec3, ComponentType::kFloat));
+  Ref<Material> material = makeRef<MetallicRoughnessMaterial>();
+
+  // Rows of objects in front of and behind the camera.
+  Ref<Scene> scene = makeRef<Scene>("Scene");
+  std::vector<Ref<Object>> objects;
+  for (int row = -10; row < 10; row++) {
+    Ref<Object> group = makeRef<Object>("Row" + std::to_string(row));
+    group->addComponent<Transform>()->setPosition(glm::vec3(0.0f, 0.0f, static_cast<float>(row) * 4.0f));
+    scene->addChild(group);
+
+    for (int column = -10; column < 10; column++) {
+      Ref<Object> object = makeRef<Object>("Object" + std::to_string(column));
+      object->addComponent<Transform>()->setPosition(glm::vec3(static_cast<float>(column) * 3.0f, 0.0f, 0.0f));
+      object->addComponent<Mesh>(std::vector<Ref<SubMesh>> {makeRef<SubMesh>(geometry, material)});
+      group->addChild(object);
+      objects.emplace_back(object);
+    }
+  }
+  objects[210]->setActive(false);
+
+  Ref<Object> camera = makeRef<Object>("Camera");
+  camera->addComponent<Transform>()->setPosition(glm::vec3(0.0f, 0.5f, 1.0f));
+  camera->addComponent<PerspectiveCamera>(glm::radians(60.0f), 0.1f, 1.0f, 30.0f);
+  scene->addChild(camera);
+
+  std::vector<VisibleSubMesh> visible;
+  scene->cull(*camera, visible);
+
+  const Frustum<float> frustum(camera->getComponent<PerspectiveCamera>()->projectionMatrix() *
+                               glm::inverse(camera->getComponent<Transform>()->worldMatrix()));
+  std::vector<Object*> expected;
+  for (const Ref<Object>& object : objects) {
+    if (object->isActiveInHierarchy() && frustum.intersectsAABB(object->worldBounds())) {
+      expected.emplace_back(object.get());
+    }
+  }
+
+  std::vector<Object*> culled;
+  for (const VisibleSubMesh& item : visible) {
+    EXPECT_EQ(item.sub_mesh, item.object->getComponent<Mesh>()->subMeshes().front().get());
+    culled.emplace_back(item.object);
+  }
+  std::sort(culled.begin(), culled.end());
+  std::sort(expected.begin(), expected.end());
+  EXPECT_FALSE(expected.empty());
+  EXPECT_LT(expected.size(), objects.size() / 4u);
+  EXPECT_EQ(culled, expected);
+
+  // Moving the camera past the last row leaves everything behind it.
+  camera->getComponent<Transform>()->setPosition(glm::vec3(0.0f, 0.5f, -45.0f));
+  scene->cull(*camera, visible);
+  EXPECT_TRUE(visible.empty());
+
+  // New object in front of the camera under an already culled group is visible.
+  Ref<Object> added = makeRef<Object>("Added");
+  added->addComponent<Transform>()->setPosition(glm::vec3(0.0f, 0.0f, -10.0f));
+  added->addComponent<Mesh>(std::vector<Ref<SubMesh>> {makeRef<SubMesh>(geometry, material)});
+  scene->children().front()->addChild(added);
+  scene->cull(*camera, visible);
+  ASSERT_EQ(visible.size(), 1u);
+  EXPECT_EQ(visible.front().object, added.get());
+
+  EXPECT_THROW(scene->cull(*objects.front(), visible), InvalidArgument);
+}
@@ -0,0 +1,45 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <stdexcept>
+#include "lsg/core/ThreadPool.h"
+
+using namespace lsg;
+
+TEST(ThreadPool, ParallelForCoversRange) {
+  ThreadPool pool(4);
+  std::vector<std::atomic<uint32_t>> visits(1000);
+
+  pool.parallelFor(visits.size(), 7u, [&](size_t begin, size_t end, size_t slot) {
+    EXPECT_LT(slot, pool.numThreads());
+    for (size_t i = begin; i < end; i++) {
+      visits[i]++;
+    }
+  });
+
+  for (const auto& count : visits) {
+    EXPECT_EQ(count.load(), 1u);
+  }
+}
+
+TEST(ThreadPool, NestedParallelFor) {
+  ThreadPool pool(2);
+  std::atomic<size_t> sum(0u);
+
+  pool.parallelFor(8u, 1u, [&](size_t, size_t, size_t) {
+    pool.parallelFor(100u, 10u, [&](size_t begin, size_t end, size_t) { sum += end - begin; });
+  });
+
+  EXPECT_EQ(sum.load(), 800u);
+}
+
+TEST(ThreadPool, RethrowsException) {
+  ThreadPool pool(2);
+
+  EXPECT_THROW(pool.parallelFor(10u, 1u,
+                                [](size_t begin, size_t, size_t) {
+                                  if (begin == 5u) {
+                                    throw std::runtime_error("Failure");
+                                  }
+                                }),
+               std::runtime_error);
+}
@@ -1,7 +1,10 @@
 #include <gtest/gtest.h>
+#include <atomic>
 #include <string>
+#include <thread>
 #include "lsg/components/Transform.h"
 #include "lsg/core/Object.h"
+#include "lsg/core/Scene.h"
 
 using namespace lsg;
 
@@ -44,4 +47,167 @@ TEST(Transform, Basic) {
   testVecNear(transform->position(), pos + glm::vec3(5.0f, 3.0f, 0.0f), 1e-5);
   transform->translateZ(45.0f);
   testVecNear(transform->position(), pos + glm::vec3(5.0f, 3.0f, 45.0f), 1e-5);
-}
\ No newline at end of file
+}
+
+TEST(Transform, Hierarchy) {
+  Ref<Object> root = makeRef<Object>("Root");
+  Ref<Object> group = makeRef<Object>("Group");
+  Ref<Object> child = makeRef<Object>("Child");
+  root->addChild(group);
+  group->addChild(child);
+
+  Ref<Transform> root_transform = root->addComponent<Transform>();
+  Ref<Transform> child_transform = child->addComponent<Transform>();
+
+  root_transform->setPosition(glm::vec3(1.0f, 2.0f, 3.0f));
+  child_transform->setPosition(glm::vec3(10.0f, 0.0f, 0.0f));
+  EXPECT_TRUE(child_transform->isWorldMatrixDirty());
+
+  // Object without transform is skipped.
+  EXPECT_EQ(glm::vec3(child_transform->worldMatrix()[3]), glm::vec3(11.0f, 2.0f, 3.0f));
+  EXPECT_FALSE(child_transform->isWorldMatrixDirty());
+  const uint64_t version = child_transform->worldVersion();
+
+  // Changing the parent propagates to the child.
+  root_transform->setScale(glm::vec3(2.0f));
+  EXPECT_TRUE(child_transform->isWorldMatrixDirty());
+  EXPECT_EQ(glm::vec3(child_transform->worldMatrix()[3]), glm::vec3(21.0f, 2.0f, 3.0f));
+  EXPECT_NE(child_transform->worldVersion(), version);
+
+  // Reparenting an ancestor without transform is detected.
+  Ref<Object> other = makeRef<Object>("Other");
+  Ref<Transform> other_transform = other->addComponent<Transform>();
+  other_transform->setPosition(glm::vec3(0.0f, 5.0f, 0.0f));
+  other->addChild(group);
+  EXPECT_EQ(glm::vec3(child_transform->worldMatrix()[3]), glm::vec3(10.0f, 5.0f, 0.0f));
+
+  // Destroying the parent transform detaches the child.
+  other->detach();
+  group->detach();
+  other_transform.reset();
+  other.reset();
+  EXPECT_EQ(glm::vec3(child_transform->worldMatrix()[3]), glm::vec3(10.0f, 0.0f, 0.0f));
+
+  // Directly set matrix is not recomposed from decomposed values.
+  glm::mat4 matrix(1.0f);
+  matrix[3] = glm::vec4(4.0f, 5.0f, 6.0f, 1.0f);
+  child_transform->setLocalMatrix(matrix);
+  EXPECT_EQ(child_transform->worldMatrix(), matrix);
+  EXPECT_EQ(child_transform->position(), glm::vec3(4.0f, 5.0f, 6.0f));
+}
+
+TEST(Transform, ManyTransforms) {
+  Ref<Object> root = makeRef<Object>("Root");
+  root->addComponent<Transform>()->setPosition(glm::vec3(1.0f, 0.0f, 0.0f));
+
+  // Deep chain with siblings at every level.
+  std::vector<Ref<Transform>> chain;
+  Ref<Object> parent = root;
+  for (size_t i = 0; i < 100; i++) {
+    Ref<Object> sibling = makeRef<Object>("Sibling");
+    parent->addChild(sibling);
+    sibling->addComponent<Transform>()->setPosition(glm::vec3(0.0f, 1.0f, 0.0f));
+
+    Ref<Object> object = makeRef<Object>("Node");
+    parent->addChild(object);
+    chain.emplace_back(object->addComponent<Transform>());
+    chain.back()->setPosition(glm::vec3(1.0f, 0.0f, 0.0f));
+    parent = object;
+  }
+
+  EXPECT_EQ(glm::vec3(chain.back()->worldMatrix()[3]), glm::vec3(101.0f, 0.0f, 0.0f));
+
+  chain[49]->translateY(2.0f);
+  EXPECT_EQ(glm::vec3(chain[48]->worldMatrix()[3]), glm::vec3(50.0f, 0.0f, 0.0f));
+  EXPECT_EQ(glm::vec3(chain.back()->worldMatrix()[3]), glm::vec3(101.0f, 2.0f, 0.0f));
+}
+
+TEST(Transform, IndependentHierarchies) {
+  Ref<Scene> scene = makeRef<Scene>("Scene");
+  Ref<Object> root = makeRef<Object>("Root");
+  scene->addChild(root);
+  Ref<Transform> root_transform = root->addComponent<Transform>();
+  root_transform->setPosition(glm::vec3(1.0f, 0.0f, 0.0f));
+  scene->updateTransforms();
+
+  // Building a detached hierarchy does not dirty the scene.
+  Ref<Object> detached = makeRef<Object>("Detached");
+  Ref<Object> leaf = makeRef<Object>("Leaf");
+  detached->addChild(leaf);
+  Ref<Transform> leaf_transform = leaf->addComponent<Transform>();
+  leaf_transform->setPosition(glm::vec3(0.0f, 2.0f, 0.0f));
+  EXPECT_NE(TransformSystem::of(*detached), TransformSystem::of(*scene));
+  EXPECT_FALSE(TransformSystem::of(*scene)->needsUpdate());
+  EXPECT_EQ(glm::vec3(leaf_transform->worldMatrix()[3]), glm::vec3(0.0f, 2.0f, 0.0f));
+
+  // Attaching moves the transforms into the system of the scene.
+  root->addChild(detached);
+  EXPECT_EQ(TransformSystem::of(*leaf), TransformSystem::of(*scene));
+  EXPECT_EQ(glm::vec3(leaf_transform->worldMatrix()[3]), glm::vec3(1.0f, 2.0f, 0.0f));
+
+  // Detaching moves them into a system of their own, local values are kept.
+  leaf_transform->translateZ(3.0f);
+  detached->detach();
+  EXPECT_NE(TransformSystem::of(*leaf), TransformSystem::of(*scene));
+  EXPECT_EQ(glm::vec3(leaf_transform->worldMatrix()[3]), glm::vec3(0.0f, 2.0f, 3.0f));
+  EXPECT_EQ(glm::vec3(root_transform->worldMatrix()[3]), glm::vec3(1.0f, 0.0f, 0.0f));
+}
+
+TEST(Transform, ParallelUpdate) {
+  Ref<Scene> scene = makeRef<Scene>("Scene");
+  std::vector<Ref<Transform>> leaves;
+
+  for (size_t i = 0; i < 4; i++) {
+    Ref<Object> root = makeRef<Object>("Root");
+    scene->addChild(root);
+    root->addComponent<Transform>()->setPosition(glm::vec3(float(i), 0.0f, 0.0f));
+
+    for (size_t j = 0; j < 600; j++) {
+      Ref<Object> child = makeRef<Object>("Child");
+      root->addChild(child);
+      child->addComponent<Transform>()->setPosition(glm::vec3(0.0f, float(j), 0.0f));
+
+      Ref<Object> leaf = makeRef<Object>("Leaf");
+      child->addChild(leaf);
+      leaves.emplace_back(leaf->addComponent<Transform>());
+      leaves.back()->setPosition(glm::vec3(0.0f, 0.0f, 1.0f));
+    }
+  }
+
+  ThreadPool pool(4);
+  scene->updateTransforms(pool);
+  EXPECT_FALSE(TransformSystem::of(*scene)->needsUpdate());
+
+  // World matrices are plain reads after the update.
+  std::vector<std::thread> threads;
+  std::atomic<size_t> mismatches = 0u;
+  for (size_t t = 0; t < 4; t++) {
+    threads.emplace_back([&leaves, &mismatches]() {
+      for (size_t i = 0; i < leaves.size(); i++) {
+        const glm::vec3 expected(float(i / 600), float(i % 600), 1.0f);
+        const Transform& leaf = *leaves[i];
+        if (glm::vec3(leaf.worldMatrix()[3]) != expected) {
+          mismatches++;
+        }
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(mismatches, 0u);
+
+  // Const reads return the last computed value until the next update.
+  const Transform& root_transform = *scene->children()[3]->getComponent<Transform>();
+  scene->children()[3]->getComponent<Transform>()->translateX(1.0f);
+  EXPECT_TRUE(root_transform.isWorldMatrixDirty());
+  EXPECT_EQ(glm::vec3(root_transform.worldMatrix()[3]), glm::vec3(3.0f, 0.0f, 0.0f));
+  scene->children()[3]->getComponent<Transform>()->translateX(-1.0f);
+
+  // Only the modified subtree is recomputed.
+  const uint64_t untouched_version = leaves[0]->worldVersion();
+  scene->children()[3]->getComponent<Transform>()->translateX(1.0f);
+  scene->updateTransforms(pool);
+  EXPECT_EQ(leaves[0]->worldVersion(), untouched_version);
+  EXPECT_EQ(glm::vec3(leaves.back()->worldMatrix()[3]), glm::vec3(4.0f, 599.0f, 1.0f));
+}
@@ -0,0 +1,56 @@
+#include <gtest/gtest.h>
+#include <random>
+#include "glm/glm.hpp"
+#include "glm/gtc/matrix_transform.hpp"
+#include "lsg/math/AABBBatch.h"
+#include "lsg/math/Frustum.h"
+
+using namespace lsg;
+
+TEST(Frustum, ClassifyAABB) {
+  const Frustum<float> frustum(glm::perspective(glm::radians(90.0f), 1.0f, 1.0f, 10.0f));
+
+  EXPECT_EQ(frustum.classifyAABB(AABB<float>(glm::vec3(-0.5f, -0.5f, -5.5f), glm::vec3(0.5f, 0.5f, -4.5f))),
+            Containment::kInside);
+  EXPECT_EQ(frustum.classifyAABB(AABB<float>(glm::vec3(-0.5f, -0.5f, -1.5f), glm::vec3(0.5f, 0.5f, -0.5f))),
+            Containment::kIntersecting);
+  EXPECT_EQ(frustum.classifyAABB(AABB<float>(glm::vec3(-0.5f, -0.5f, 0.5f), glm::vec3(0.5f, 0.5f, 1.5f))),
+            Containment::kOutside);
+  EXPECT_EQ(frustum.classifyAABB(AABB<float>(glm::vec3(20.0f, -0.5f, -5.5f), glm::vec3(21.0f, 0.5f, -4.5f))),
+            Containment::kOutside);
+
+  // Default frustum contains everything.
+  EXPECT_EQ(Frustum<float>().classifyAABB(AABB<float>(glm::vec3(-1e6f), glm::vec3(1e6f))), Containment::kInside);
+}
+
+TEST(Frustum, BatchMatchesScalar) {
+  const Frustum<float> frustum(glm::perspective(glm::radians(60.0f), 1.5f, 0.1f, 50.0f) *
+                               glm::lookAt(glm::vec3(3.0f, 2.0f, 1.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f)));
+  std::mt19937 rng(5u);
+  std::uniform_real_distribution<float> position(-60.0f, 60.0f);
+  std::uniform_real_distribution<float> size(0.1f, 10.0f);
+
+  std::vector<AABB<float>> boxes;
+  AABBBatch<float> batch;
+  for (size_t i = 0u; i < 1000u; i++) {
+    const glm::vec3 min(position(rng), position(rng), position(rng));
+    boxes.emplace_back(min, min + glm::vec3(size(rng), size(rng), size(rng)));
+    batch.push(boxes.back());
+  }
+
+  std::vector<Containment> results;
+  frustum.classifyAABBs(batch, results);
+  ASSERT_EQ(results.size(), boxes.size());
+
+  size_t counts[3] = {0u, 0u, 0u};
+  for (size_t i = 0u; i < boxes.size(); i++) {
+    EXPECT_EQ(results[i], frustum.classifyAABB(boxes[i]));
+    EXPECT_EQ(results[i] != Containment::kOutside, frustum.intersectsAABB(boxes[i]));
+    counts[static_cast<size_t>(results[i])]++;
+  }
+
+  // All three classes are covered.
+  EXPECT_GT(counts[0], 0u);
+  EXPECT_GT(counts[1], 0u);
+  EXPECT_GT(counts[2], 0u);
+}
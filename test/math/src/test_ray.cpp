@@ -1,6 +1,8 @@
 #include <gtest/gtest.h>
+#include <random>
 #include "glm/glm.hpp"
 #include "lsg/math/AABB.h"
+#include "lsg/math/AABBBatch.h"
 #include "lsg/math/Ray.h"
 
 using namespace lsg;
@@ -111,4 +113,35 @@ TEST(Ray, IntersectionTriangle) {
     std::optional<glm::tvec3<float>> isect = ray.intersectTriangle(a, b, c);
     EXPECT_FALSE(isect.has_value());
   }
-}
\ No newline at end of file
+}
+
+TEST(Ray, BatchMatchesScalar) {
+  std::mt19937 rng(3u);
+  std::uniform_real_distribution<float> position(-10.0f, 10.0f);
+  std::uniform_real_distribution<float> size(0.1f, 4.0f);
+
+  std::vector<AABB<float>> boxes;
+  AABBBatch<float> batch;
+  for (size_t i = 0u; i < 500u; i++) {
+    const glm::vec3 min(position(rng), position(rng), position(rng));
+    boxes.emplace_back(min, min + glm::vec3(size(rng), size(rng), size(rng)));
+    batch.push(boxes.back());
+  }
+
+  size_t num_hits = 0u;
+  std::vector<uint8_t> hits;
+  for (size_t i = 0u; i < 20u; i++) {
+    // Axis aligned directions are included to cover infinite slab distances.
+    const glm::vec3 dir = (i % 5u == 0u) ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(position(rng), position(rng), 1.0f);
+    Ray<float> ray(glm::vec3(position(rng), position(rng), position(rng)), dir);
+
+    ray.intersectAABBs(batch, hits);
+    ASSERT_EQ(hits.size(), boxes.size());
+    for (size_t j = 0u; j < boxes.size(); j++) {
+      EXPECT_EQ(hits[j] != 0u, ray.intersectAABBDistance(boxes[j]).has_value());
+      num_hits += hits[j];
+    }
+  }
+
+  EXPECT_GT(num_hits, 0u);
+}
@@ -0,0 +1,62 @@
+#include <gtest/gtest.h>
+#include "lsg/components/Mesh.h"
+#include "lsg/components/Transform.h"
+#include "lsg/core/Scene.h"
+#include "lsg/materials/MetallicRoughnessMaterial.h"
+#include "lsg/render/InstanceBatcher.h"
+
+using namespace lsg;
+
+TEST(InstanceBatcher, GroupsAndUpdatesIncrementally) {
+  Ref<Scene> scene = makeRef<Scene>("Scene");
+  Ref<Geometry> geometries[2] = {makeRef<Geometry>(), makeRef<Geometry>()};
+  Ref<Material> material = makeRef<MetallicRoughnessMaterial>();
+  std::vector<Ref<Object>> objects;
+
+  for (size_t i = 0u; i < 10u; i++) {
+    Ref<Object> object = makeRef<Object>("Object" + std::to_string(i));
+    object->addComponent<Transform>()->setPosition(glm::vec3(static_cast<float>(i), 0.0f, 0.0f));
+    object->addComponent<Mesh>(std::vector<Ref<SubMesh>> {makeRef<SubMesh>(geometries[i % 2u], material)});
+    scene->addChild(object);
+    objects.emplace_back(object);
+  }
+
+  InstanceBatcher batcher;
+  batcher.update(scene->compile());
+  ASSERT_EQ(batcher.batches().size(), 2u);
+  EXPECT_EQ(batcher.instanceCount(), 10u);
+  EXPECT_EQ(batcher.updatedInstanceCount(), 10u);
+
+  const InstanceBatch& odd = batcher.batches()[1];
+  EXPECT_EQ(odd.geometry, geometries[1].get());
+  EXPECT_EQ(odd.material, material.get());
+  ASSERT_EQ(odd.world_matrices.size(), 5u);
+  EXPECT_EQ(odd.world_matrices[2][3], glm::vec4(5.0f, 0.0f, 0.0f, 1.0f));
+
+  // Moving an object rewrites only its matrix.
+  objects[5]->getComponent<Transform>()->translateY(1.0f);
+  batcher.update(scene->compile());
+  EXPECT_EQ(batcher.updatedInstanceCount(), 1u);
+  EXPECT_EQ(batcher.batches()[1].world_matrices[2][3], glm::vec4(5.0f, 1.0f, 0.0f, 1.0f));
+
+  batcher.update(scene->compile());
+  EXPECT_EQ(batcher.updatedInstanceCount(), 0u);
+
+  // Changes of a snapshot the batcher did not see are not lost.
+  objects[7]->getComponent<Transform>()->translateY(2.0f);
+  scene->compile();
+  batcher.update(scene->compile());
+  EXPECT_EQ(batcher.updatedInstanceCount(), 10u);
+  EXPECT_EQ(batcher.batches()[1].world_matrices[3][3], glm::vec4(7.0f, 2.0f, 0.0f, 1.0f));
+
+  // Structural changes regroup the instances.
+  objects[0]->setActive(false);
+  objects[1]->getComponent<Mesh>()->subMeshes().front()->setGeometry(geometries[0]);
+  batcher.update(scene->compile());
+  EXPECT_EQ(batcher.instanceCount(), 9u);
+  EXPECT_EQ(batcher.batches()[0].objects.size(), 5u);
+  EXPECT_EQ(batcher.batches()[1].objects.size(), 4u);
+
+  batcher.clear();
+  EXPECT_TRUE(batcher.batches().empty());
+}
@@ -0,0 +1,119 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include "lsg/components/Mesh.h"
+#include "lsg/components/PerspectiveCamera.h"
+#include "lsg/components/Transform.h"
+#include "lsg/core/Scene.h"
+#include "lsg/materials/MetallicRoughnessMaterial.h"
+#include "lsg/render/OcclusionCuller.h"
+
+using namespace lsg;
+
+namespace {
+
+Ref<Geometry> makeGeometry(const std::vector<glm::vec3>& vertices) {
+  Ref<Geometry> geometry = makeRef<Geometry>();
+  geometry->setVertices(TBufferAccessor<glm::vec3>(BufferView(makeRef<Buffer>(vertices), sizeof(glm::vec3)),
+                                                   StructureType::kVec3, ComponentType::kFloat));
+  return geometry;
+}
+
+bool contains(const std::vector<VisibleSubMesh>& visible, const Object* object) {
+  return std::any_of(visible.begin(), visible.end(),
+                     [object](const VisibleSubMesh& item) { return item.object == object; });
+}
+
+} // namespace
+
+TEST(OcclusionCuller, Rasterization) {
+  OcclusionCuller culler(64u, 32u);
+  EXPECT_EQ(culler.levelCount(), 7u);
+
+  // Quad covering the left half of the screen at the middle of the depth range.
+  culler.clear(glm::mat4(1.0f));
+  culler.rasterize(*makeGeometry({{-1.0f, -1.0f, 0.0f},
+                                  {0.0f, -1.0f, 0.0f},
+                                  {0.0f, 1.0f, 0.0f},
+                                  {-1.0f, -1.0f, 0.0f},
+                                  {-1.0f, 1.0f, 0.0f},
+                                  {0.0f, 1.0f, 0.0f}}),
+                   glm::mat4(1.0f));
+  culler.buildHierarchy();
+
+  const std::vector<float>& depth = culler.depth();
+  EXPECT_FLOAT_EQ(depth[5u * 64u + 10u], 0.5f);
+  EXPECT_FLOAT_EQ(depth[5u * 64u + 40u], 1.0f);
+  EXPECT_FLOAT_EQ(culler.depth(1u)[5u * 32u + 5u], 0.5f);
+  EXPECT_FLOAT_EQ(culler.depth(6u).front(), 1.0f);
+
+  EXPECT_TRUE(culler.isOccluded(AABB<float>(glm::vec3(-0.8f, -0.5f, 0.2f), glm::vec3(-0.2f, 0.5f, 0.9f))));
+  EXPECT_FALSE(culler.isOccluded(AABB<float>(glm::vec3(-0.8f, -0.5f, -0.2f), glm::vec3(-0.2f, 0.5f, 0.9f))));
+  EXPECT_FALSE(culler.isOccluded(AABB<float>(glm::vec3(0.2f, -0.5f, 0.2f), glm::vec3(0.8f, 0.5f, 0.9f))));
+  EXPECT_NEAR(culler.screenCoverage(AABB<float>(glm::vec3(-1.0f, -1.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.5f))), 0.5f,
+              1e-5f);
+  EXPECT_THROW(culler.depth(7u), OutOfRange);
+}
+
+TEST(OcclusionCuller, CullScene) {
+  Ref<Material> material = makeRef<MetallicRoughnessMaterial>();
+  Ref<Geometry> small = makeGeometry({{0.0f, 0.0f, 0.0f}, {1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 1.0f}});
+  Ref<Scene> scene = makeRef<Scene>("Scene");
+
+  // Wall covering the left half of the view.
+  Ref<Object> wall = makeRef<Object>("Wall");
+  wall->addComponent<Transform>();
+  Ref<Mesh> wall_mesh = wall->addComponent<Mesh>(std::vector<Ref<SubMesh>> {
+    makeRef<SubMesh>(makeGeometry({{-10.0f, -10.0f, -10.0f},
+                                   {0.0f, -10.0f, -10.0f},
+                                   {0.0f, 10.0f, -10.0f},
+                                   {-10.0f, -10.0f, -10.0f},
+                                   {-10.0f, 10.0f, -10.0f},
+                                   {0.0f, 10.0f, -10.0f}}),
+                     material)});
+  scene->addChild(wall);
+
+  std::vector<Ref<Object>> objects;
+  for (const glm::vec3& position : {glm::vec3(-5.0f, 0.0f, -20.0f), glm::vec3(5.0f, 0.0f, -20.0f),
+                                    glm::vec3(-5.0f, 0.0f, -5.0f)}) {
+    Ref<Object> object = makeRef<Object>("Object");
+    object->addComponent<Transform>()->setPosition(position);
+    object->addComponent<Mesh>(std::vector<Ref<SubMesh>> {makeRef<SubMesh>(small, material)});
+    scene->addChild(object);
+    objects.emplace_back(object);
+  }
+
+  Ref<Object> camera = makeRef<Object>("Camera");
+  camera->addComponent<Transform>();
+  camera->addComponent<PerspectiveCamera>(glm::radians(90.0f), 0.1f, 2.0f, 100.0f);
+  scene->addChild(camera);
+
+  OcclusionCuller culler;
+  std::vector<VisibleSubMesh> visible;
+  culler.cull(*scene, *camera, visible);
+  EXPECT_EQ(culler.occluderCount(), 1u);
+  EXPECT_EQ(visible.size(), 3u);
+  EXPECT_TRUE(contains(visible, wall.get()));
+  EXPECT_FALSE(contains(visible, objects[0].get()));
+  EXPECT_TRUE(contains(visible, objects[1].get()));
+  EXPECT_TRUE(contains(visible, objects[2].get()));
+
+  // Meshes that are never occluders hide nothing.
+  wall_mesh->setOccluderHint(OccluderHint::kNever);
+  culler.cull(*scene, *camera, visible);
+  EXPECT_EQ(culler.occluderCount(), 0u);
+  EXPECT_EQ(visible.size(), 4u);
+
+  // Automatic occluders must cover the threshold, which forced occluders ignore.
+  wall_mesh->setOccluderHint(OccluderHint::kAuto);
+  culler.setOccluderThreshold(0.5f);
+  culler.cull(*scene, *camera, visible);
+  EXPECT_EQ(visible.size(), 4u);
+
+  wall_mesh->setOccluderHint(OccluderHint::kAlways);
+  culler.cull(*scene, *camera, visible);
+  EXPECT_EQ(visible.size(), 3u);
+  EXPECT_FALSE(contains(visible, objects[0].get()));
+
+  Ref<Object> no_camera = makeRef<Object>("NoCamera");
+  EXPECT_THROW(culler.cull(*scene, *no_camera, visible), InvalidArgument);
+}
@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <random>
+#include "lsg/components/Mesh.h"
+#include "lsg/components/Transform.h"
+#include "lsg/core/Scene.h"
+#include "lsg/materials/MetallicRoughnessMaterial.h"
+#include "lsg/render/RenderList.h"
+
+using namespace lsg;
+
+Ref<Geometry> createTriangleGeometry() {
+  std::vector<glm::vec3> vertices = {{0.0f, 0.0f, 0.0f}, {1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}};
+
+  Ref<Geometry> geometry = makeRef<Geometry>();
+  geometry->setVertices(TBufferAccessor<glm::vec3>(BufferView(makeRef<Buffer>(vertices), sizeof(glm::vec3)),
+                                                   StructureType::kVec3, ComponentType::kFloat));
+  return geometry;
+}
+
+TEST(RenderList, RadixSort) {
+  std::mt19937_64 rng(7u);
+  std::vector<uint64_t> keys(10000u);
+  std::vector<uint32_t> values(keys.size());
+
+  for (size_t i = 0u; i < keys.size(); i++) {
+    // Upper bytes are shared, so some passes are skipped.
+    keys[i] = (uint64_t(0xABu) << 56u) | (rng() & 0xFFFFFFFFFFu);
+    values[i] = static_cast<uint32_t>(i);
+  }
+
+  std::vector<uint64_t> expected = keys;
+  std::sort(expected.begin(), expected.end());
+  const std::vector<uint64_t> original = keys;
+
+  std::vector<uint64_t> keys_scratch;
+  std::vector<uint32_t> values_scratch;
+  RenderList::radixSort(keys, values, keys_scratch, values_scratch);
+
+  EXPECT_EQ(keys, expected);
+  for (size_t i = 0u; i < keys.size(); i++) {
+    EXPECT_EQ(original[values[i]], keys[i]);
+  }
+}
+
+TEST(RenderList, ExtractSortedItems) {
+  Ref<Scene> scene = makeRef<Scene>("Scene");
+  Ref<Geometry> geometries[2] = {createTriangleGeometry(), createTriangleGeometry()};
+  Ref<Material> materials[2] = {makeRef<MetallicRoughnessMaterial>(), makeRef<MetallicRoughnessMaterial>()};
+
+  // Objects along the z axis with alternating geometries and materials.
+  for (size_t i = 0u; i < 16u; i++) {
+    Ref<Object> object = makeRef<Object>("Object" + std::to_string(i));
+    object->addComponent<Transform>()->setPosition(glm::vec3(0.0f, 0.0f, static_cast<float>(16u - i)));
+    object->addComponent<Mesh>(
+      std::vector<Ref<SubMesh>> {makeRef<SubMesh>(geometries[i % 2u], materials[(i / 2u) % 2u])});
+    scene->addChild(object);
+  }
+
+  Ref<Object> inactive = makeRef<Object>("Inactive", false);
+  inactive->addComponent<Mesh>(std::vector<Ref<SubMesh>> {makeRef<SubMesh>(geometries[0], materials[0])});
+  scene->addChild(inactive);
+
+  RenderList list;
+  list.extract(scene->compile(), glm::vec3(0.0f));
+
+  const std::vector<DrawItem>& items = list.items();
+  ASSERT_EQ(items.size(), 16u);
+  ASSERT_EQ(list.batches().size(), 4u);
+
+  for (size_t i = 1u; i < items.size(); i++) {
+    EXPECT_LE(items[i - 1u].key, items[i].key);
+  }
+
+  for (const DrawBatch& batch : list.batches()) {
+    EXPECT_EQ(batch.count, 4u);
+
+    // Items within a batch are sorted front to back.
+    for (uint32_t i = batch.first; i < batch.first + batch.count; i++) {
+      EXPECT_EQ(items[i].geometry, items[batch.first].geometry);
+      EXPECT_EQ(items[i].material, items[batch.first].material);
+      if (i > batch.first) {
+        EXPECT_LT(items[i - 1u].world_matrix[3].z, items[i].world_matrix[3].z);
+      }
+    }
+  }
+
+  const DrawItem& item = items.front();
+  EXPECT_EQ(item.bounds.min(), glm::vec3(item.world_matrix[3]));
+  EXPECT_EQ(list.snapshot()->objectIds()[item.object], scene->children()[item.object - 1u]->id());
+
+  list.clear();
+  EXPECT_TRUE(list.items().empty());
+  EXPECT_EQ(list.snapshot(), nullptr);
+}
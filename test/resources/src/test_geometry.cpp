@@ -0,0 +1,240 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <thread>
+#include "lsg/components/Mesh.h"
+#include "lsg/components/Transform.h"
+#include "lsg/core/Object.h"
+#include "lsg/core/ThreadPool.h"
+#include "lsg/materials/MetallicRoughnessMaterial.h"
+#include "lsg/resources/Geometry.h"
+
+using namespace lsg;
+
+Ref<Geometry> createQuadGeometry(float offset) {
+  std::vector<glm::vec3> vertices = {{offset, 0.0f, 0.0f},
+                                     {offset + 1.0f, 0.0f, 0.0f},
+                                     {offset + 1.0f, 1.0f, 0.0f},
+                                     {offset, 1.0f, 0.0f}};
+  std::vector<uint16_t> indices = {0u, 1u, 2u, 0u, 2u, 3u};
+
+  Ref<Geometry> geometry = makeRef<Geometry>();
+  geometry->setVertices(TBufferAccessor<glm::vec3>(BufferView(makeRef<Buffer>(vertices), sizeof(glm::vec3)),
+                                                   StructureType::kVec3, ComponentType::kFloat));
+  geometry->setIndices(BufferAccessor(BufferView(makeRef<Buffer>(indices), sizeof(uint16_t)), StructureType::kScalar,
+                                      ComponentType::kUnsignedShort));
+  return geometry;
+}
+
+TEST(Geometry, CachedBVH) {
+  Ref<Geometry> geometry = createQuadGeometry(0.0f);
+
+  Ref<BVH<float>> bvh = geometry->bvh();
+  ASSERT_TRUE(bvh);
+  EXPECT_EQ(bvh->getPrimitiveIndices().size(), 2u);
+  EXPECT_EQ(geometry->bvh().get(), bvh.get());
+
+  // Different configuration produces a different BVH.
+  bvh::BVHConfig config;
+  config.max_leaf_size = 1u;
+  EXPECT_NE(geometry->bvh(config).get(), bvh.get());
+
+  // Changing vertex data invalidates the cache.
+  Ref<BVH<float>> config_bvh = geometry->bvh(config);
+  geometry->setVertices(createQuadGeometry(5.0f)->getVertices());
+  Ref<BVH<float>> rebuilt = geometry->bvh(config);
+  EXPECT_NE(rebuilt.get(), config_bvh.get());
+  EXPECT_EQ(rebuilt->getBounds().min().x, 5.0f);
+}
+
+TEST(Geometry, ConcurrentBVHRequests) {
+  Ref<Geometry> geometry = createQuadGeometry(0.0f);
+
+  std::vector<Ref<BVH<float>>> results(8u);
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < results.size(); i++) {
+    threads.emplace_back([&geometry, &results, i]() { results[i] = geometry->bvh(); });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  for (const Ref<BVH<float>>& result : results) {
+    EXPECT_EQ(result.get(), results.front().get());
+  }
+}
+
+TEST(Geometry, BVHRequestsFromPoolTasks) {
+  Ref<Geometry> geometry = createQuadGeometry(0.0f);
+
+  // Workers waiting for the pending build pick up further tasks that request the same BVH.
+  std::vector<Ref<BVH<float>>> results(64u);
+  ThreadPool::global().parallelFor(results.size(), 1u, [&](const size_t begin, const size_t end, size_t) {
+    for (size_t i = begin; i < end; i++) {
+      results[i] = geometry->bvh();
+    }
+  });
+
+  for (const Ref<BVH<float>>& result : results) {
+    ASSERT_TRUE(result);
+    EXPECT_EQ(result.get(), results.front().get());
+  }
+  EXPECT_EQ(geometry->bvh().get(), results.front().get());
+}
+
+struct NotificationCounter : public VersionTracker {
+  void onDependencyChanged(const VersionTracker&) override {
+    notifications++;
+  }
+
+  size_t notifications = 0u;
+};
+
+TEST(Geometry, ConcurrentDependentRegistration) {
+  Ref<Geometry> geometry = createQuadGeometry(0.0f);
+  Ref<Material> material = makeRef<MetallicRoughnessMaterial>();
+  NotificationCounter counter;
+  geometry->addDependent(counter);
+
+  // Sub-meshes register and unregister themselves as dependents of the shared geometry.
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < 8u; i++) {
+    threads.emplace_back([&geometry, &material]() {
+      for (size_t j = 0; j < 256u; j++) {
+        makeRef<SubMesh>(geometry, material);
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  geometry->setVertices(createQuadGeometry(1.0f)->getVertices());
+  EXPECT_EQ(counter.notifications, 1u);
+  geometry->removeDependent(counter);
+}
+
+TEST(Mesh, CombinedBVH) {
+  Ref<Material> material = makeRef<MetallicRoughnessMaterial>();
+  Ref<Object> object = makeRef<Object>("Object");
+  Ref<Mesh> mesh = object->addComponent<Mesh>();
+  mesh->addSubMesh(makeRef<SubMesh>(createQuadGeometry(0.0f), material));
+  mesh->addSubMesh(makeRef<SubMesh>(createQuadGeometry(3.0f), material));
+
+  Ref<BVH<float>> bvh = mesh->bvh();
+  EXPECT_EQ(mesh->bvh().get(), bvh.get());
+
+  std::vector<uint32_t> indices = bvh->getPrimitiveIndices();
+  std::sort(indices.begin(), indices.end());
+  ASSERT_EQ(indices.size(), 4u);
+  EXPECT_EQ(indices[0], Mesh::encodePrimitiveIndex(0u, 0u));
+  EXPECT_EQ(indices[1], Mesh::encodePrimitiveIndex(0u, 1u));
+  EXPECT_EQ(indices[2], Mesh::encodePrimitiveIndex(1u, 0u));
+  EXPECT_EQ(indices[3], Mesh::encodePrimitiveIndex(1u, 1u));
+  EXPECT_EQ(Mesh::subMeshIndex(indices[3]), 1u);
+  EXPECT_EQ(Mesh::triangleIndex(indices[3]), 1u);
+
+  // Leaf bounds must match the triangles of the decoded sub-mesh.
+  for (const BVH<float>::Node& node : bvh->getNodes()) {
+    if (!node.is_leaf) {
+      continue;
+    }
+
+    for (uint32_t i = node.indices_range[0]; i < node.indices_range[1]; i++) {
+      const float offset = Mesh::subMeshIndex(bvh->getPrimitiveIndices()[i]) == 0u ? 0.0f : 3.0f;
+      EXPECT_GE(node.bounds.max().x, offset + 1.0f);
+    }
+  }
+
+  // Adding a sub-mesh or changing sub-mesh geometry invalidates the cache.
+  mesh->addSubMesh(makeRef<SubMesh>(createQuadGeometry(6.0f), material));
+  Ref<BVH<float>> extended = mesh->bvh();
+  EXPECT_NE(extended.get(), bvh.get());
+  EXPECT_EQ(extended->getPrimitiveIndices().size(), 6u);
+
+  mesh->subMeshes()[0]->geometry()->setVertices(createQuadGeometry(-3.0f)->getVertices());
+  EXPECT_NE(mesh->bvh().get(), extended.get());
+  EXPECT_EQ(mesh->bvh()->getBounds().min().x, -3.0f);
+
+  // Replaced geometry may be freed and its address reused by the new one.
+  mesh->subMeshes()[2]->setGeometry(createQuadGeometry(20.0f));
+  EXPECT_EQ(mesh->bvh()->getBounds().max().x, 21.0f);
+  mesh->subMeshes()[2]->setGeometry(createQuadGeometry(30.0f));
+  EXPECT_EQ(mesh->bvh()->getBounds().max().x, 31.0f);
+}
+
+TEST(Mesh, ResourceChangesMarkSubtree) {
+  Ref<Material> material = makeRef<MetallicRoughnessMaterial>();
+  Ref<Geometry> geometry = createQuadGeometry(0.0f);
+  Ref<SubMesh> sub_mesh = makeRef<SubMesh>(geometry, material);
+
+  Ref<Object> root = makeRef<Object>("Root");
+  Ref<Object> object = makeRef<Object>("Object");
+  root->addChild(object);
+  object->addComponent<Mesh>(std::vector<Ref<SubMesh>> {sub_mesh});
+
+  uint64_t seen = Object::advanceVersionClock();
+  geometry->setVertices(createQuadGeometry(1.0f)->getVertices());
+  EXPECT_GT(object->subtreeVersion(), seen);
+  EXPECT_GT(root->subtreeVersion(), seen);
+
+  seen = Object::advanceVersionClock();
+  material->incrementVersion();
+  EXPECT_GT(root->subtreeVersion(), seen);
+
+  // Replaced geometry no longer affects the mesh.
+  sub_mesh->setGeometry(createQuadGeometry(2.0f));
+  seen = Object::advanceVersionClock();
+  geometry->incrementVersion();
+  EXPECT_LE(root->subtreeVersion(), seen);
+
+  // Destroyed mesh unregisters itself.
+  object.reset();
+  root.reset();
+  sub_mesh->incrementVersion();
+}
+
+TEST(Object, CachedBounds) {
+  Ref<Material> material = makeRef<MetallicRoughnessMaterial>();
+  Ref<Geometry> geometry = createQuadGeometry(0.0f);
+
+  Ref<Object> root = makeRef<Object>("Root");
+  Ref<Object> group = makeRef<Object>("Group");
+  group->addComponent<Transform>()->setPosition(glm::vec3(0.0f, 0.0f, 5.0f));
+  Ref<Object> a = makeRef<Object>("A");
+  a->addComponent<Mesh>(std::vector<Ref<SubMesh>> {makeRef<SubMesh>(geometry, material)});
+  Ref<Object> b = makeRef<Object>("B");
+  b->addComponent<Transform>()->setPosition(glm::vec3(10.0f, 0.0f, 0.0f));
+  b->addComponent<Mesh>(std::vector<Ref<SubMesh>> {makeRef<SubMesh>(createQuadGeometry(0.0f), material)});
+  Ref<Object> empty = makeRef<Object>("Empty");
+  root->addChildren({group, empty});
+  group->addChildren({a, b});
+
+  EXPECT_EQ(a->localBounds().max(), glm::vec3(1.0f, 1.0f, 0.0f));
+  EXPECT_EQ(a->worldBounds().min(), glm::vec3(0.0f, 0.0f, 5.0f));
+  EXPECT_FALSE(empty->worldBounds().valid());
+  EXPECT_FALSE(empty->subtreeBounds().valid());
+  EXPECT_EQ(root->subtreeBounds().min(), glm::vec3(0.0f, 0.0f, 5.0f));
+  EXPECT_EQ(root->subtreeBounds().max(), glm::vec3(11.0f, 1.0f, 5.0f));
+
+  // Cached bounds are returned until something changes.
+  const AABB<float>* cached = &root->subtreeBounds();
+  EXPECT_EQ(&root->subtreeBounds(), cached);
+
+  // Moving an ancestor invalidates bounds of the descendants without transforms.
+  group->getComponent<Transform>()->translateY(2.0f);
+  EXPECT_EQ(a->worldBounds().min(), glm::vec3(0.0f, 2.0f, 5.0f));
+  EXPECT_EQ(root->subtreeBounds().max(), glm::vec3(11.0f, 3.0f, 5.0f));
+
+  // Geometry changes propagate through the sub-mesh and mesh.
+  geometry->setVertices(createQuadGeometry(-4.0f)->getVertices());
+  EXPECT_EQ(root->subtreeBounds().min(), glm::vec3(-4.0f, 2.0f, 5.0f));
+
+  // Repeated changes without another consumer still reach the cached ancestors.
+  b->getComponent<Transform>()->translateX(1.0f);
+  EXPECT_EQ(root->subtreeBounds().max(), glm::vec3(12.0f, 3.0f, 5.0f));
+  b->getComponent<Transform>()->translateX(1.0f);
+  EXPECT_EQ(root->subtreeBounds().max(), glm::vec3(13.0f, 3.0f, 5.0f));
+
+  group->removeChild(b->id());
+  EXPECT_EQ(root->subtreeBounds().max(), glm::vec3(-3.0f, 3.0f, 5.0f));
+}